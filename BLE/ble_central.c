@@ -0,0 +1,280 @@
+#include <string.h>
+#include "esp_log.h"
+#include "host/ble_hs.h"
+#include "ble_central.h"
+#include "telemetry.h"
+
+/* ---------- UUID-y (Bluetooth SIG) ---------- */
+#define SVC_HR              0x180D
+#define SVC_CP              0x1818
+#define CHR_HR_MEASUREMENT  0x2A37
+#define CHR_CP_MEASUREMENT  0x2A63
+#define DSC_CCCD            0x2902
+
+/* ---------- harmonogram skanowania ----------
+ * Pasywne okno 10 ms co 100 ms (10 % radia) – reszta czasu zostaje
+ * na zdarzenia połączenia z telefonem.
+ */
+#define SCAN_ITVL           160     /* 100 ms [0.625 ms] */
+#define SCAN_WINDOW         16      /*  10 ms            */
+
+/* Czujniki wysyłają ~1 Hz – rzadki interwał nie zabiera czasu telefonowi. */
+#define SENSOR_ITVL_MIN     48      /* 60 ms [1.25 ms] */
+#define SENSOR_ITVL_MAX     64      /* 80 ms           */
+#define SENSOR_TMO          400     /* 4 s [10 ms]     */
+
+#define CONNECT_TMO_MS      10000
+
+typedef enum { SENSOR_HR = 0, SENSOR_CP, SENSOR_COUNT } sensor_kind_t;
+
+/* skanowanie i łączenie z czujnikami obok połączenia z telefonem */
+#if !CONFIG_BT_NIMBLE_ROLE_CENTRAL || !CONFIG_BT_NIMBLE_ROLE_OBSERVER
+#error "set BT_NIMBLE_ROLE_CENTRAL and BT_NIMBLE_ROLE_OBSERVER for ble_central"
+#endif
+_Static_assert(CONFIG_BT_NIMBLE_MAX_CONNECTIONS >= 1 + SENSOR_COUNT,
+               "BT_NIMBLE_MAX_CONNECTIONS must cover the phone and every sensor");
+
+typedef struct {
+    uint16_t svc;
+    uint16_t chr;
+    uint16_t conn;          /* BLE_HS_CONN_HANDLE_NONE = wolny slot */
+    /* wykrywanie: usługa -> charakterystyki -> deskryptory pomiaru */
+    uint16_t svc_start, svc_end;
+    uint16_t val_handle;
+    uint16_t chr_end;       /* ostatni uchwyt deskryptorów pomiaru */
+    uint16_t cccd;
+    bool     connecting;
+} sensor_slot_t;
+
+static const char *TAG = "BLE_CEN";
+static uint8_t     own_addr;
+
+static sensor_slot_t slots[SENSOR_COUNT] = {
+    [SENSOR_HR] = { .svc = SVC_HR, .chr = CHR_HR_MEASUREMENT,
+                    .conn = BLE_HS_CONN_HANDLE_NONE },
+    [SENSOR_CP] = { .svc = SVC_CP, .chr = CHR_CP_MEASUREMENT,
+                    .conn = BLE_HS_CONN_HANDLE_NONE },
+};
+
+static void scan(void);
+static int  gap_event(struct ble_gap_event *e, void *arg);
+
+/* ---------- parsowanie pomiarów ---------- */
+static void parse_hr(const uint8_t *d, uint16_t len)
+{
+    if (len < 2) return;
+    /* flags bit0: wartość 16-bitowa */
+    if ((d[0] & 0x01) && len >= 3) telemetry_set_hr(d[1] | (d[2] << 8));
+    else                            telemetry_set_hr(d[1]);
+}
+
+static void parse_cp(const uint8_t *d, uint16_t len)
+{
+    if (len < 4) return;
+    /* flags (16 b), potem instantaneous power (sint16) */
+    telemetry_set_power((int16_t)(d[2] | (d[3] << 8)));
+}
+
+/* ---------- GATT ---------- */
+static int subscribed_cb(uint16_t conn, const struct ble_gatt_error *err,
+                         struct ble_gatt_attr *attr, void *arg)
+{
+    sensor_slot_t *s = arg;
+    if (err->status != 0) {
+        ESP_LOGW(TAG, "subscribe 0x%04x failed: %d", s->svc, err->status);
+        ble_gap_terminate(conn, BLE_ERR_REM_USER_CONN_TERM);
+    } else {
+        ESP_LOGI(TAG, "sensor 0x%04x streaming", s->svc);
+    }
+    return 0;
+}
+
+static void give_up(uint16_t conn, sensor_slot_t *s, const char *what)
+{
+    ESP_LOGW(TAG, "no %s on 0x%04x", what, s->svc);
+    ble_gap_terminate(conn, BLE_ERR_REM_USER_CONN_TERM);
+}
+
+/* CCCD nie musi leżeć tuż za wartością (np. Extended Properties, opis
+ * użytkownika) – bierzemy uchwyt 0x2902 z wykrytych deskryptorów. */
+static int dsc_disc_cb(uint16_t conn, const struct ble_gatt_error *err,
+                       uint16_t chr_val_handle, const struct ble_gatt_dsc *dsc, void *arg)
+{
+    sensor_slot_t *s = arg;
+
+    if (err->status == 0) {
+        if (ble_uuid_cmp(&dsc->uuid.u, BLE_UUID16_DECLARE(DSC_CCCD)) == 0)
+            s->cccd = dsc->handle;
+        return 0;
+    }
+    if (err->status != BLE_HS_EDONE || s->cccd == 0) {
+        give_up(conn, s, "CCCD");
+        return 0;
+    }
+    static const uint8_t notify_on[2] = { 0x01, 0x00 };
+    ble_gattc_write_flat(conn, s->cccd, notify_on, sizeof(notify_on), subscribed_cb, s);
+    return 0;
+}
+
+/* Deskryptory pomiaru kończą się przed deklaracją następnej charakterystyki. */
+static int chr_disc_cb(uint16_t conn, const struct ble_gatt_error *err,
+                       const struct ble_gatt_chr *chr, void *arg)
+{
+    sensor_slot_t *s = arg;
+
+    if (err->status == 0) {
+        if (s->val_handle && !s->chr_end)
+            s->chr_end = chr->def_handle - 1;
+        if (ble_uuid_cmp(&chr->uuid.u, BLE_UUID16_DECLARE(s->chr)) == 0)
+            s->val_handle = chr->val_handle;
+        return 0;
+    }
+    if (err->status != BLE_HS_EDONE || s->val_handle == 0) {
+        give_up(conn, s, "measurement chr");
+        return 0;
+    }
+    if (!s->chr_end) s->chr_end = s->svc_end;
+    if (s->chr_end <= s->val_handle) {
+        give_up(conn, s, "CCCD");
+        return 0;
+    }
+    ble_gattc_disc_all_dscs(conn, s->val_handle, s->chr_end, dsc_disc_cb, s);
+    return 0;
+}
+
+static int svc_disc_cb(uint16_t conn, const struct ble_gatt_error *err,
+                       const struct ble_gatt_svc *svc, void *arg)
+{
+    sensor_slot_t *s = arg;
+
+    if (err->status == 0) {
+        s->svc_start = svc->start_handle;
+        s->svc_end = svc->end_handle;
+        return 0;
+    }
+    if (err->status != BLE_HS_EDONE || s->svc_end == 0) {
+        give_up(conn, s, "service");
+        return 0;
+    }
+    ble_gattc_disc_all_chrs(conn, s->svc_start, s->svc_end, chr_disc_cb, s);
+    return 0;
+}
+
+/* ---------- GAP ---------- */
+static sensor_slot_t *slot_for_adv(const struct ble_gap_disc_desc *d)
+{
+    struct ble_hs_adv_fields f;
+    if (ble_hs_adv_parse_fields(&f, d->data, d->length_data) != 0) return NULL;
+
+    for (int i = 0; i < f.num_uuids16; i++) {
+        uint16_t u = ble_uuid_u16(&f.uuids16[i].u);
+        for (int k = 0; k < SENSOR_COUNT; k++) {
+            if (slots[k].svc == u && slots[k].conn == BLE_HS_CONN_HANDLE_NONE &&
+                !slots[k].connecting) {
+                return &slots[k];
+            }
+        }
+    }
+    return NULL;
+}
+
+static sensor_slot_t *slot_for_conn(uint16_t conn)
+{
+    for (int k = 0; k < SENSOR_COUNT; k++) {
+        if (slots[k].conn == conn) return &slots[k];
+    }
+    return NULL;
+}
+
+static void connect(const struct ble_gap_disc_desc *d, sensor_slot_t *s)
+{
+    struct ble_gap_conn_params cp = {
+        .scan_itvl = SCAN_ITVL,
+        .scan_window = SCAN_WINDOW,
+        .itvl_min = SENSOR_ITVL_MIN,
+        .itvl_max = SENSOR_ITVL_MAX,
+        .latency = 0,
+        .supervision_timeout = SENSOR_TMO,
+    };
+
+    ble_gap_disc_cancel();
+    s->connecting = true;
+    int rc = ble_gap_connect(own_addr, &d->addr, CONNECT_TMO_MS, &cp, gap_event, s);
+    if (rc != 0) {
+        ESP_LOGW(TAG, "connect rc=%d", rc);
+        s->connecting = false;
+        scan();
+    }
+}
+
+static int gap_event(struct ble_gap_event *e, void *arg)
+{
+    sensor_slot_t *s = arg;
+
+    switch (e->type) {
+    case BLE_GAP_EVENT_DISC:
+        s = slot_for_adv(&e->disc);
+        if (s) connect(&e->disc, s);
+        break;
+    case BLE_GAP_EVENT_DISC_COMPLETE:
+        scan();
+        break;
+    case BLE_GAP_EVENT_CONNECT:
+        s->connecting = false;
+        if (e->connect.status == 0) {
+            s->conn = e->connect.conn_handle;
+            s->svc_start = s->svc_end = 0;
+            s->val_handle = s->chr_end = s->cccd = 0;
+            ESP_LOGI(TAG, "sensor 0x%04x connected", s->svc);
+            ble_gattc_disc_svc_by_uuid(s->conn, BLE_UUID16_DECLARE(s->svc), svc_disc_cb, s);
+        }
+        scan();                         /* szukaj brakującego czujnika */
+        break;
+    case BLE_GAP_EVENT_DISCONNECT:
+        s = slot_for_conn(e->disconnect.conn.conn_handle);
+        if (s) {
+            ESP_LOGI(TAG, "sensor 0x%04x lost", s->svc);
+            s->conn = BLE_HS_CONN_HANDLE_NONE;
+        }
+        scan();
+        break;
+    case BLE_GAP_EVENT_NOTIFY_RX:
+        s = slot_for_conn(e->notify_rx.conn_handle);
+        if (s && e->notify_rx.attr_handle == s->val_handle) {
+            uint8_t buf[32];
+            uint16_t len = 0;
+            ble_hs_mbuf_to_flat(e->notify_rx.om, buf, sizeof(buf), &len);
+            if (s->svc == SVC_HR) parse_hr(buf, len);
+            else                  parse_cp(buf, len);
+        }
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+static void scan(void)
+{
+    bool missing = false;
+    for (int k = 0; k < SENSOR_COUNT; k++) {
+        if (slots[k].connecting) return;        /* jedno połączenie naraz */
+        if (slots[k].conn == BLE_HS_CONN_HANDLE_NONE) missing = true;
+    }
+    if (!missing || ble_gap_disc_active()) return;
+
+    struct ble_gap_disc_params dp = {
+        .itvl = SCAN_ITVL,
+        .window = SCAN_WINDOW,
+        .passive = 1,
+        .filter_duplicates = 1,
+    };
+    int rc = ble_gap_disc(own_addr, BLE_HS_FOREVER, &dp, gap_event, NULL);
+    if (rc != 0) ESP_LOGW(TAG, "disc rc=%d", rc);
+}
+
+void ble_central_start(uint8_t own_addr_type)
+{
+    own_addr = own_addr_type;
+    scan();
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <stdint.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Rola central: wyszukuje i łączy się ze standardowymi czujnikami
+ * Heart Rate (0x180D) i Cycling Power (0x1818), równolegle do serwera.
+ * Wymaga CONFIG_BT_NIMBLE_ROLE_CENTRAL=y i CONFIG_BT_NIMBLE_MAX_CONNECTIONS>=3.
+ */
+void ble_central_start(uint8_t own_addr_type);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,335 @@
+#include <string.h>
+#include "esp_log.h"
+#include "ble_core.h"
+
+/* ---------- dane producenta (tryb rozgłoszeniowy) ----------
+ * Little endian, 12 B:
+ *  [0..1]  company ID (0xFFFF – testowy / nieprzydzielony)
+ *  [2]     wersja formatu
+ *  [3]     licznik próbek (przekręca się) – słuchacz wykrywa duplikaty
+ *  [4..5]  prędkość      [0.01 km/h]
+ *  [6..7]  średnia       [0.01 km/h]
+ *  [8..11] dystans       [m]
+ */
+#define BCAST_COMPANY_ID   0xFFFF
+#define BCAST_VERSION      1
+#define BCAST_ITVL_MS      100      /* odświeżanie < 1 s u słuchaczy */
+
+static const char *TAG = "BLE_CORE";
+static const ble_core_host_t *host;
+
+static uint16_t     conn = BLE_CONN_NONE;
+static bool         synced;
+static ble_mode_t   mode = BLE_MODE_CONNECTABLE;
+static uint8_t      bcast_counter;
+static ride_state_t ride_state = RIDE_PARKED;
+static bool         bulk;
+
+/* ostatnie wartości – dla odczytu GATT i trybu rozgłoszeniowego */
+static float last[BLE_CHR_DIAG];
+
+/* kolejka próbek czekających na wolny bufor (najstarsze wypadają) */
+static struct { ble_chr_t chr; float v; int64_t t; } pending[BLE_CORE_PENDING];
+static uint8_t  pend_head, pend_cnt;
+static uint32_t n_sent, n_deferred, n_dropped;
+
+/* Opóźnienie notyfikacji: publikacja próbki -> NOTIFY_TX, czyli razem
+ * z czekaniem w kolejce na bufor. NOTIFY_TX NimBLE zgłasza po przekazaniu
+ * pakietu do kontrolera, nie po wysłaniu w eterze – to górna granica
+ * tego, co zależy od nas, bez czasu oczekiwania na zdarzenie połączenia.
+ * Czas trafia do pierścienia przed notify, bo NOTIFY_TX przychodzi
+ * synchronicznie z jego wnętrza. */
+static int64_t  tx_t0[BLE_CORE_INFLIGHT];
+static uint8_t  tx_head, tx_cnt;
+static uint32_t lat_max_us, lat_over;
+
+/* ---------- pomocnicze ---------- */
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    put_le16(p, v & 0xFFFF);
+    put_le16(p + 2, v >> 16);
+}
+
+static uint16_t to_centi(float v)
+{
+    if (v <= 0.0f) return 0;
+    if (v >= 655.35f) return UINT16_MAX;
+    return (uint16_t)(v * 100.0f + 0.5f);
+}
+
+static void bcast_encode(uint8_t *mfg)
+{
+    float m = last[BLE_CHR_DIST] * 1000.0f;
+
+    put_le16(&mfg[0], BCAST_COMPANY_ID);
+    mfg[2] = BCAST_VERSION;
+    mfg[3] = bcast_counter;
+    put_le16(&mfg[4], to_centi(last[BLE_CHR_SPEED]));
+    put_le16(&mfg[6], to_centi(last[BLE_CHR_AVG]));
+    put_le32(&mfg[8], m > 0.0f ? (uint32_t)m : 0);
+}
+
+/* ---------- inicjalizacja / zdarzenia ---------- */
+void ble_core_init(const ble_core_host_t *h)
+{
+    host = h;
+}
+
+void ble_core_on_sync(void)
+{
+    synced = true;
+}
+
+void ble_core_on_connect(uint16_t c)
+{
+    conn = c;
+    host->conn_params(conn, ble_policy_params(ble_policy_state()));
+}
+
+void ble_core_on_disconnect(void)
+{
+    host->lock();
+    conn = BLE_CONN_NONE;
+    pend_cnt = 0;                       /* nie ma już komu wysłać */
+    tx_cnt = 0;
+    host->unlock();
+}
+
+uint16_t ble_core_conn(void)
+{
+    return conn;
+}
+
+bool ble_core_synced(void)
+{
+    return synced;
+}
+
+void ble_core_adv_config(ble_adv_cfg_t *cfg)
+{
+    uint16_t itvl = ble_policy_params(ble_policy_state())->adv_itvl_ms;
+
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->connectable = true;
+    if (mode == BLE_MODE_BROADCAST) {
+        cfg->connectable = false;
+        /* w ruchu słuchacze potrzebują świeżych danych; na postoju – oszczędzamy */
+        if (ble_policy_state() != RIDE_PARKED && itvl > BCAST_ITVL_MS)
+            itvl = BCAST_ITVL_MS;
+        /* 128-bit UUID się nie zmieści obok danych producenta */
+        bcast_encode(cfg->mfg);
+        cfg->mfg_len = BLE_BCAST_MFG_LEN;
+    }
+    cfg->itvl_ms = itvl;
+}
+
+/* ---------- odczyt ---------- */
+size_t ble_core_read(ble_chr_t chr, uint8_t *buf, size_t cap)
+{
+    if (chr < BLE_CHR_DIAG) {
+        if (cap < sizeof(float)) return 0;
+        memcpy(buf, &last[chr], sizeof(float));     /* zwróć ostatnią wartość */
+        return sizeof(float);
+    }
+    if (chr != BLE_CHR_DIAG || cap < BLE_DIAG_LEN) return 0;
+
+    ble_notify_stats_t st;
+    ble_core_stats(&st);
+    put_le16(&buf[0],  st.capacity);
+    put_le16(&buf[2],  st.in_use);
+    put_le16(&buf[4],  st.high_water);
+    put_le16(&buf[6],  st.pending);
+    put_le32(&buf[8],  st.sent);
+    put_le32(&buf[12], st.deferred);
+    put_le32(&buf[16], st.dropped);
+    put_le32(&buf[20], st.lat_max_us);
+    put_le32(&buf[24], st.lat_over);
+    return BLE_DIAG_LEN;
+}
+
+/* ---------- polityka notyfikacji ----------
+ * Gdy host nie ma bufora, próbka czeka w kolejce; przy pełnej kolejce
+ * wypada najstarsza (liczone).
+ */
+static bool send_float(ble_chr_t chr, float v, int64_t t)
+{
+    bool tracked = false;
+
+    host->lock();
+    if (tx_cnt < BLE_CORE_INFLIGHT) {
+        tx_t0[(tx_head + tx_cnt) % BLE_CORE_INFLIGHT] = t;
+        tx_cnt++;
+        tracked = true;
+    }
+    host->unlock();
+
+    if (host->notify(conn, chr, &v, sizeof(v))) {
+        host->lock();
+        n_sent++;
+        host->unlock();
+        return true;
+    }
+    /* brak bufora – NOTIFY_TX nie przyjdzie, zdejmij swój wpis */
+    if (tracked) {
+        host->lock();
+        if (tx_cnt != 0) tx_cnt--;
+        host->unlock();
+    }
+    return false;
+}
+
+static void enqueue(ble_chr_t chr, float v, int64_t t)
+{
+    host->lock();
+    if (pend_cnt == BLE_CORE_PENDING) {
+        pend_head = (pend_head + 1) % BLE_CORE_PENDING;
+        pend_cnt--;
+        n_dropped++;
+    }
+    uint8_t i = (pend_head + pend_cnt) % BLE_CORE_PENDING;
+    pending[i].chr = chr;
+    pending[i].v = v;
+    pending[i].t = t;
+    pend_cnt++;
+    n_deferred++;
+    host->unlock();
+}
+
+/* Wołane z zadania czujnika i z hosta (zwrot bufora) – próbkę zdejmujemy
+ * pod blokadą przed wysłaniem, więc nic nie pójdzie dwa razy. */
+static void flush_pending(void)
+{
+    while (conn != BLE_CONN_NONE) {
+        ble_chr_t chr;
+        float v;
+        int64_t t;
+
+        host->lock();
+        if (pend_cnt == 0) {
+            host->unlock();
+            return;
+        }
+        chr = pending[pend_head].chr;
+        v = pending[pend_head].v;
+        t = pending[pend_head].t;
+        pend_head = (pend_head + 1) % BLE_CORE_PENDING;
+        pend_cnt--;
+        host->unlock();
+
+        if (send_float(chr, v, t)) continue;
+
+        /* dalej pusto – oddaj na początek kolejki */
+        host->lock();
+        if (pend_cnt == BLE_CORE_PENDING) {
+            n_dropped++;                /* to i tak była najstarsza */
+        } else {
+            pend_head = (pend_head + BLE_CORE_PENDING - 1) % BLE_CORE_PENDING;
+            pending[pend_head].chr = chr;
+            pending[pend_head].v = v;
+            pending[pend_head].t = t;
+            pend_cnt++;
+        }
+        host->unlock();
+        return;
+    }
+}
+
+/* Granica: dwa interwały połączenia bieżącego stanu jazdy. Przekroczenia
+ * liczymy – tak widać, czy połączenia z czujnikami (rola central)
+ * odbierają czas radiowy telefonowi. */
+void ble_core_on_notify_tx(void)
+{
+    int64_t now = host->now_us();
+    uint32_t bound = ble_policy_params(ble_policy_state())->conn_itvl_max * 1250u * 2;
+
+    host->lock();
+    if (tx_cnt != 0) {
+        uint32_t lat = (uint32_t)(now - tx_t0[tx_head]);
+        tx_head = (tx_head + 1) % BLE_CORE_INFLIGHT;
+        tx_cnt--;
+        if (lat > lat_max_us) lat_max_us = lat;
+        if (lat > bound) lat_over++;
+    }
+    host->unlock();
+}
+
+/* Nie z NOTIFY_TX: ten przychodzi z wnętrza notify, a wysyłanie stąd
+ * zagnieżdżałoby się o jeden poziom na próbkę. */
+void ble_core_on_tx_done(void)
+{
+    flush_pending();
+}
+
+void ble_core_publish(ble_chr_t chr, float v)
+{
+    if (chr >= BLE_CHR_DIAG) return;
+    last[chr] = v;
+
+    if (conn == BLE_CONN_NONE) return;
+    int64_t now = host->now_us();
+    flush_pending();                    /* zachowaj kolejność próbek */
+    if (pend_cnt != 0 || !send_float(chr, v, now)) enqueue(chr, v, now);
+}
+
+/* ---------- tryb / stan jazdy ---------- */
+void ble_core_set_mode(ble_mode_t m)
+{
+    if (m == mode) return;
+    mode = m;
+    ESP_LOGI(TAG, "Mode: %s", m == BLE_MODE_BROADCAST ? "broadcast" : "connectable");
+
+    /* połączenie (jeśli jest) zostaje – nowy tryb wejdzie po rozłączeniu */
+    if (!synced || conn != BLE_CONN_NONE) return;
+    host->adv_refresh(true);
+}
+
+void ble_core_broadcast_commit(void)
+{
+    if (mode != BLE_MODE_BROADCAST || !synced) return;
+    bcast_counter++;
+    /* podmiana danych w trakcie rozgłaszania – bez restartu */
+    host->adv_refresh(false);
+}
+
+static void apply_state(void)
+{
+    if (!ble_policy_enter(bulk ? RIDE_BULK : ride_state, host->now_us()))
+        return;
+    if (!synced) return;
+
+    if (conn != BLE_CONN_NONE)
+        host->conn_params(conn, ble_policy_params(ble_policy_state()));
+    else
+        host->adv_refresh(true);
+}
+
+void ble_core_set_ride_state(ride_state_t s)
+{
+    ride_state = s;
+    apply_state();
+}
+
+void ble_core_set_bulk(bool on)
+{
+    bulk = on;
+    apply_state();
+}
+
+void ble_core_stats(ble_notify_stats_t *out)
+{
+    host->pool_usage(&out->capacity, &out->in_use, &out->high_water);
+    host->lock();
+    out->pending    = pend_cnt;
+    out->sent       = n_sent;
+    out->deferred   = n_deferred;
+    out->dropped    = n_dropped;
+    out->lat_max_us = lat_max_us;
+    out->lat_over   = lat_over;
+    host->unlock();
+}
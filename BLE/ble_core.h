@@ -0,0 +1,95 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ble_policy.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Przenośny rdzeń serwera GATT: kodowanie charakterystyk, polityka
+ * notyfikacji i stan połączenia. Bez NimBLE i FreeRTOS – stos radiowy
+ * podpina się przez ble_core_host_t (adapter NimBLE w ble_server.c,
+ * atrapa hosta dla Linuksa w host/ble_fake_host.c).
+ */
+
+#define BLE_CONN_NONE       0xFFFF      /* == BLE_HS_CONN_HANDLE_NONE */
+#define BLE_BCAST_MFG_LEN   12
+#define BLE_DIAG_LEN        28
+#define BLE_CORE_INFLIGHT   8           /* notyfikacje przekazane, bez NOTIFY_TX */
+#define BLE_CORE_PENDING    8           /* kolejka przy braku buforów */
+
+typedef enum {
+    BLE_MODE_CONNECTABLE = 0,   /* serwer GATT, notyfikacje do jednego telefonu */
+    BLE_MODE_BROADCAST,         /* bez połączeń: dane w ogłoszeniu, dowolnie wielu słuchaczy */
+} ble_mode_t;
+
+typedef enum {
+    BLE_CHR_SPEED = 0,
+    BLE_CHR_AVG,
+    BLE_CHR_DIST,
+    BLE_CHR_DIAG,
+    BLE_CHR_COUNT
+} ble_chr_t;
+
+typedef struct {
+    uint16_t capacity;
+    uint16_t in_use;
+    uint16_t high_water;    /* maks. jednocześnie zajętych buforów  */
+    uint16_t pending;       /* próbki czekające na wolny bufor      */
+    uint32_t sent;
+    uint32_t deferred;      /* próbki odłożone z braku bufora       */
+    uint32_t dropped;       /* najstarsze próbki wyrzucone z kolejki */
+    uint32_t lat_max_us;    /* maks. opóźnienie publikacja -> NOTIFY_TX */
+    uint32_t lat_over;      /* notyfikacje ponad granicę opóźnienia  */
+} ble_notify_stats_t;
+
+typedef struct {
+    bool     connectable;
+    uint16_t itvl_ms;
+    uint8_t  mfg[BLE_BCAST_MFG_LEN];
+    uint8_t  mfg_len;       /* 0 = ogłaszaj UUID usługi */
+} ble_adv_cfg_t;
+
+typedef struct {
+    /* false = brak bufora, próbka zostanie w kolejce; true = przekazana
+     * stosowi, który zgłosi ją przez ble_core_on_notify_tx */
+    bool    (*notify)(uint16_t conn, ble_chr_t chr, const void *data, uint16_t len);
+    /* restart = false: podmień tylko dane ogłoszenia */
+    void    (*adv_refresh)(bool restart);
+    void    (*conn_params)(uint16_t conn, const ble_policy_params_t *p);
+    void    (*pool_usage)(uint16_t *capacity, uint16_t *in_use, uint16_t *high_water);
+    int64_t (*now_us)(void);
+    void    (*lock)(void);
+    void    (*unlock)(void);
+} ble_core_host_t;
+
+void ble_core_init(const ble_core_host_t *host);
+
+/* ---------- zdarzenia od adaptera ---------- */
+void ble_core_on_sync(void);
+void ble_core_on_connect(uint16_t conn);
+void ble_core_on_disconnect(void);
+/* NOTIFY_TX charakterystyki telemetrii (adapter filtruje po uchwycie). */
+void ble_core_on_notify_tx(void);
+/* Bufor notyfikacji wrócił do puli – można wysłać odłożone próbki. */
+void ble_core_on_tx_done(void);
+
+uint16_t ble_core_conn(void);
+bool     ble_core_synced(void);
+void     ble_core_adv_config(ble_adv_cfg_t *cfg);
+
+/* Zawartość charakterystyki do odczytu; zwraca długość. */
+size_t ble_core_read(ble_chr_t chr, uint8_t *buf, size_t cap);
+
+/* ---------- API aplikacji ---------- */
+void ble_core_publish(ble_chr_t chr, float v);
+void ble_core_set_mode(ble_mode_t m);
+void ble_core_broadcast_commit(void);
+void ble_core_set_ride_state(ride_state_t s);
+void ble_core_set_bulk(bool on);
+void ble_core_stats(ble_notify_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
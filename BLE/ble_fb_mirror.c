@@ -0,0 +1,131 @@
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "nimble/nimble_port.h"
+#include "host/ble_hs.h"
+#include "ble_core.h"
+#include "ble_fb_mirror.h"
+#include "fb_mirror.h"
+
+#define CHUNK_MAX   244         /* maks. dane notyfikacji przy MTU 247 */
+#define RETRY_MS    20          /* brak buforów msys – ponowienie z zadania hosta */
+
+static const char *TAG = "BLE_MIRROR";
+
+uint16_t ble_fb_mirror_handle;
+
+/* koder woła zadanie rysujące i callout ponowień w zadaniu hosta;
+ * rekurencyjny, bo zdarzenia GAP mogą przyjść z wnętrza notify */
+static StaticSemaphore_t lock_buf;
+static SemaphoreHandle_t lock;
+
+static fb_mirror_t mirror;
+static uint16_t    mirror_conn = BLE_CONN_NONE;
+static uint32_t    dropped;
+
+static struct ble_npl_callout retry_co;
+
+static bool send_pkt(void *ctx, const uint8_t *pkt, size_t len)
+{
+    struct os_mbuf *om = ble_hs_mbuf_from_flat(pkt, len);
+    if (!om) return false;      /* pakiet zostaje w koderze */
+    if (ble_gatts_notify_custom(mirror_conn, ble_fb_mirror_handle, om) != 0) {
+        /* pakiet przepadł i psuje obraz odbiorcy – następna ramka kluczowa */
+        dropped++;
+        fb_mirror_key(&mirror);
+    }
+    return true;
+}
+
+/* Wysyła pakiety ramki, dopóki host ma bufory msys. Bez buforów ponawia
+ * z calloutu w zadaniu hosta – NOTIFY_TX przychodzi synchronicznie
+ * z wnętrza ble_gatts_notify_custom, więc dalszej wysyłki na nim nie
+ * oprzemy, a ramka w toku blokuje fb_mirror_begin. */
+static void pump(void)
+{
+    uint8_t buf[CHUNK_MAX];
+
+    if (mirror_conn == BLE_CONN_NONE) return;
+    size_t cap = ble_att_mtu(mirror_conn) - 3;
+    if (cap > sizeof(buf)) cap = sizeof(buf);
+    if (fb_mirror_pump(&mirror, buf, cap, send_pkt, NULL))
+        ble_npl_callout_reset(&retry_co, ble_npl_time_ms_to_ticks32(RETRY_MS));
+}
+
+static void lock_take(void) { xSemaphoreTakeRecursive(lock, portMAX_DELAY); }
+static void lock_give(void) { xSemaphoreGiveRecursive(lock); }
+
+static void retry_event(struct ble_npl_event *ev)
+{
+    lock_take();
+    pump();
+    lock_give();
+}
+
+void ble_fb_mirror_init(void)
+{
+    lock = xSemaphoreCreateRecursiveMutexStatic(&lock_buf);
+    ble_npl_callout_init(&retry_co, nimble_port_get_dflt_eventq(), retry_event, NULL);
+}
+
+void ble_fb_mirror_frame(const sh1106_fb_t *fb)
+{
+    lock_take();
+    if (mirror_conn != BLE_CONN_NONE) {
+        fb_mirror_note(&mirror, fb->dirty);
+        /* ramka w toku (czeka na bufory) najpierw dochodzi do końca */
+        if (fb_mirror_busy(&mirror) || fb_mirror_begin(&mirror, fb, esp_timer_get_time()))
+            pump();
+    }
+    lock_give();
+}
+
+int ble_fb_mirror_access(uint16_t conn, uint16_t attr,
+                         struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+    uint8_t cmd = 0;
+    uint16_t len = 0;
+
+    if (ctxt->op != BLE_GATT_ACCESS_OP_WRITE_CHR) return BLE_ATT_ERR_UNLIKELY;
+    if (ble_hs_mbuf_to_flat(ctxt->om, &cmd, sizeof(cmd), &len) != 0 || len != 1 ||
+        cmd != 0x01)
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+
+    lock_take();
+    fb_mirror_key(&mirror);     /* wyśle ją najbliższa klatka */
+    lock_give();
+    return 0;
+}
+
+void ble_fb_mirror_on_subscribe(uint16_t conn, uint16_t attr, bool notify)
+{
+    if (attr != ble_fb_mirror_handle) return;
+    lock_take();
+    if (notify) {
+        fb_mirror_init(&mirror, 1000000 / BLE_FB_MIRROR_FPS);
+        mirror_conn = conn;
+        ESP_LOGI(TAG, "mirror on, conn=%u mtu=%u", conn, ble_att_mtu(conn));
+    } else if (conn == mirror_conn) {
+        ble_fb_mirror_log_stats();
+        mirror_conn = BLE_CONN_NONE;
+    }
+    lock_give();
+}
+
+void ble_fb_mirror_on_disconnect(void)
+{
+    lock_take();
+    ble_npl_callout_stop(&retry_co);
+    mirror_conn = BLE_CONN_NONE;
+    lock_give();
+}
+
+void ble_fb_mirror_log_stats(void)
+{
+    if (!mirror.frames) return;
+    ESP_LOGI(TAG, "mirror: %lu frames (%lu key), %lu B, %lu B/frame, %lu dropped",
+             (unsigned long)mirror.frames, (unsigned long)mirror.keys,
+             (unsigned long)mirror.bytes,
+             (unsigned long)(mirror.bytes / mirror.frames), (unsigned long)dropped);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "host/ble_hs.h"
+#include "sh1106_fb.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Kopia ekranu przez BLE: podgląd na telefonie i zrzuty ekranu.
+ *
+ * Strumień pakietów fb_mirror (format w components/ui/include/fb_mirror.h)
+ * idzie notyfikacjami tej charakterystyki tylko wtedy, gdy odbiorca je
+ * zasubskrybował; subskrypcja zaczyna od ramki kluczowej. Zapis 0x01 prosi
+ * o ramkę kluczową (zrzut ekranu), np. po zgubionym pakiecie. Dekoder:
+ * tools/fb_mirror_decode.py.
+ */
+
+#define BLE_FB_MIRROR_FPS   4       /* limit klatek kopii, niezależny od panelu */
+
+extern uint16_t ble_fb_mirror_handle;
+
+void ble_fb_mirror_init(void);
+
+int  ble_fb_mirror_access(uint16_t conn, uint16_t attr,
+                          struct ble_gatt_access_ctxt *ctxt, void *arg);
+
+/* Z zadania rysującego, po ui_render i przed wyczyszczeniem fb->dirty. */
+void ble_fb_mirror_frame(const sh1106_fb_t *fb);
+
+/* Z gap_event serwera. Bez NOTIFY_TX: przychodzi z wnętrza notify, brak
+ * buforów msys ponawia własny callout. */
+void ble_fb_mirror_on_subscribe(uint16_t conn, uint16_t attr, bool notify);
+void ble_fb_mirror_on_disconnect(void);
+
+void ble_fb_mirror_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,197 @@
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "nimble/nimble_port.h"
+#include "host/ble_hs.h"
+#include "ble_core.h"
+#include "ble_log_xfer.h"
+#include "ride_export.h"
+
+#define CHUNK_MAX   244         /* maks. dane notyfikacji przy MTU 247 */
+#define RETRY_MS    20          /* brak buforów msys – ponowienie z zadania hosta */
+#define SUMMARY_LEN 22          /* odczyt: ride_summary_t jako LE */
+
+static const char *TAG = "BLE_XFER";
+
+uint16_t ble_log_xfer_handle;
+
+/* Stan transferu zmienia tylko zadanie hosta NimBLE (zapis, zdarzenie
+ * pompy, callout, rozłączenie); mutex chroni go przed resztą wywołań. */
+static StaticSemaphore_t lock_buf;
+static SemaphoreHandle_t lock;
+
+static flash_port_t  fp;
+static ride_reader_t reader;
+static ride_export_t exporter;
+static uint16_t      xfer_conn = BLE_CONN_NONE;
+static bool          eof_sent;
+static bool          pumping;
+
+/* kawałek już wyjęty z eksportu, czeka na udaną notyfikację */
+static uint8_t       chunk[CHUNK_MAX];
+static size_t        chunk_len;
+
+static struct ble_npl_event   pump_ev;
+static struct ble_npl_callout retry_co;
+
+static void finish(void)
+{
+    if (xfer_conn == BLE_CONN_NONE) return;
+    ESP_LOGI(TAG, "export done, %lu B", (unsigned long)exporter.bytes);
+    ble_npl_callout_stop(&retry_co);
+    ride_reader_close(&reader);
+    xfer_conn = BLE_CONN_NONE;
+    chunk_len = 0;
+    ble_core_set_bulk(false);
+}
+
+/* true = notyfikacja przyjęta przez stos; inaczej nic nie wyszło */
+static bool send(const void *data, size_t len)
+{
+    struct os_mbuf *om = ble_hs_mbuf_from_flat(data, len);
+    if (!om) return false;
+    return ble_gatts_notify_custom(xfer_conn, ble_log_xfer_handle, om) == 0;
+}
+
+/* Wysyła kawałki, dopóki stos ma bufory. Bez buforów ponawia z calloutu
+ * w zadaniu hosta – NOTIFY_TX przychodzi synchronicznie z wnętrza
+ * ble_gatts_notify_custom, więc na nim dalszej wysyłki nie oprzemy. */
+static void pump(void)
+{
+    if (pumping) return;
+    pumping = true;
+
+    while (xfer_conn != BLE_CONN_NONE) {
+        if (!chunk_len && !exporter.done) {
+            size_t cap = ble_att_mtu(xfer_conn) - 3;
+            if (cap > sizeof(chunk)) cap = sizeof(chunk);
+            chunk_len = ride_export_read(&exporter, chunk, cap);
+        }
+        if (chunk_len) {
+            /* kawałek zostaje w chunk, aż stos go przyjmie – nic nie zginie */
+            if (!send(chunk, chunk_len)) break;
+            chunk_len = 0;
+            continue;
+        }
+        if (eof_sent) {
+            finish();
+            break;
+        }
+        if (!send(NULL, 0)) break;
+        eof_sent = true;
+    }
+    if (xfer_conn != BLE_CONN_NONE)
+        ble_npl_callout_reset(&retry_co, ble_npl_time_ms_to_ticks32(RETRY_MS));
+    pumping = false;
+}
+
+static void pump_event(struct ble_npl_event *ev)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    pump();
+    xSemaphoreGive(lock);
+}
+
+static void start(uint16_t conn, uint32_t t_from, uint32_t t_to)
+{
+    finish();
+    if (flash_port_esp_open(&fp, "ridelog") != ESP_OK ||
+        ride_reader_open(&reader, &fp) != ESP_OK) {
+        ESP_LOGW(TAG, "ride log not available");
+        return;
+    }
+    ride_export_begin(&exporter, &reader, t_from, t_to);
+    xfer_conn = conn;
+    eof_sent = false;
+    chunk_len = 0;
+    ble_core_set_bulk(true);
+    pump();
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+/* Podsumowanie całego dziennika – aplikacja wybiera z niego zakres do
+ * pobrania. W trakcie eksportu liczone z jego czytnika (iteratory są
+ * niezależne), inaczej czytnik jest otwierany tylko na czas odczytu. */
+static int read_summary(struct os_mbuf *om)
+{
+    ride_summary_t sum;
+    uint8_t v[SUMMARY_LEN];
+    bool own = xfer_conn == BLE_CONN_NONE;
+
+    if (own && (flash_port_esp_open(&fp, "ridelog") != ESP_OK ||
+                ride_reader_open(&reader, &fp) != ESP_OK)) {
+        ESP_LOGW(TAG, "ride log not available");
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+    ride_reader_summary(&reader, 0, UINT32_MAX, &sum);
+    if (own) ride_reader_close(&reader);
+
+    put_le32(&v[0],  sum.samples);
+    put_le32(&v[4],  sum.t_first_ms);
+    put_le32(&v[8],  sum.t_last_ms);
+    put_le32(&v[12], sum.moving_ms);
+    put_le32(&v[16], sum.dist_m);
+    v[20] = sum.max_ckmh & 0xFF;
+    v[21] = sum.max_ckmh >> 8;
+    return os_mbuf_append(om, v, sizeof(v)) ? BLE_ATT_ERR_INSUFFICIENT_RES : 0;
+}
+
+int ble_log_xfer_access(uint16_t conn, uint16_t attr,
+                        struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+    uint8_t cmd[9] = { 0 };
+    uint16_t len = 0;
+
+    if (ctxt->op == BLE_GATT_ACCESS_OP_READ_CHR) {
+        xSemaphoreTake(lock, portMAX_DELAY);
+        int rc = read_summary(ctxt->om);
+        xSemaphoreGive(lock);
+        return rc;
+    }
+    if (ctxt->op != BLE_GATT_ACCESS_OP_WRITE_CHR) return BLE_ATT_ERR_UNLIKELY;
+    if (ble_hs_mbuf_to_flat(ctxt->om, cmd, sizeof(cmd), &len) != 0 || len < 1)
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+
+    if (cmd[0] == 0x00) {
+        xSemaphoreTake(lock, portMAX_DELAY);
+        finish();
+        xSemaphoreGive(lock);
+    } else if (cmd[0] == 0x01 && len == sizeof(cmd)) {
+        uint32_t t_from = cmd[1] | cmd[2] << 8 | cmd[3] << 16 | (uint32_t)cmd[4] << 24;
+        uint32_t t_to   = cmd[5] | cmd[6] << 8 | cmd[7] << 16 | (uint32_t)cmd[8] << 24;
+        xSemaphoreTake(lock, portMAX_DELAY);
+        start(conn, t_from, t_to);
+        xSemaphoreGive(lock);
+    } else {
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+    }
+    return 0;
+}
+
+void ble_log_xfer_init(void)
+{
+    lock = xSemaphoreCreateMutexStatic(&lock_buf);
+    ble_npl_event_init(&pump_ev, pump_event, NULL);
+    ble_npl_callout_init(&retry_co, nimble_port_get_dflt_eventq(), pump_event, NULL);
+}
+
+/* Z dowolnego zadania (też z wnętrza notify) – tylko budzi pompę w hoście. */
+void ble_log_xfer_on_tx(void)
+{
+    if (xfer_conn != BLE_CONN_NONE)
+        ble_npl_eventq_put(nimble_port_get_dflt_eventq(), &pump_ev);
+}
+
+void ble_log_xfer_on_disconnect(void)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    finish();
+    xSemaphoreGive(lock);
+}
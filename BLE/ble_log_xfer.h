@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+#include "host/ble_hs.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Pobieranie dziennika przejazdu przez BLE (transfer masowy).
+ *
+ * Odczyt charakterystyki: podsumowanie całego dziennika (ride_summary_t), LE:
+ *   [0..3] próbki  [4..7] t pierwszej [ms]  [8..11] t ostatniej [ms]
+ *   [12..15] czas w ruchu [ms]  [16..19] dystans [m]  [20..21] maks. [0,01 km/h]
+ *
+ * Zapis do charakterystyki sterującej:
+ *   [0]     0x01 = start, 0x00 = przerwij
+ *   [1..4]  t_from [ms] LE
+ *   [5..8]  t_to   [ms] LE (0 = do końca)
+ * CSV z ride_export przychodzi notyfikacjami tej samej charakterystyki;
+ * notyfikacja o długości 0 oznacza koniec. Na czas transferu polityka
+ * radia przechodzi w RIDE_BULK.
+ */
+
+extern uint16_t ble_log_xfer_handle;
+
+/* Po nimble_port_init(): mutex, zdarzenie pompy i callout ponowień. */
+void ble_log_xfer_init(void);
+
+int  ble_log_xfer_access(uint16_t conn, uint16_t attr,
+                         struct ble_gatt_access_ctxt *ctxt, void *arg);
+
+/* Z gap_event serwera; on_tx tylko budzi pompę w zadaniu hosta. */
+void ble_log_xfer_on_tx(void);
+void ble_log_xfer_on_disconnect(void);
+
+#ifdef __cplusplus
+}
+#endif
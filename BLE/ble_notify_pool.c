@@ -0,0 +1,55 @@
+#include "os/os_mempool.h"
+#include "nimble/nimble_port.h"
+#include "ble_notify_pool.h"
+
+/* Bez miejsca na nagłówki: ble_att_clt_tx_notify bierze na nagłówek ATT
+ * (i dalej L2CAP/HCI) własny mbuf z msys i dokleja nasz blok za nim,
+ * więc zapas przed danymi nigdy nie byłby użyty. */
+#define BLOCK_SIZE  (sizeof(struct os_mbuf) + sizeof(struct os_mbuf_pkthdr) + \
+                     NOTIFY_POOL_PAYLOAD)
+
+static os_membuf_t        pool_mem[OS_MEMPOOL_SIZE(NOTIFY_POOL_BLOCKS, BLOCK_SIZE)];
+static struct os_mempool_ext mempool_ext;
+static struct os_mbuf_pool  mbuf_pool;
+static struct ble_npl_event free_ev;
+
+#define mempool (mempool_ext.mpe_mp)
+
+/* Zwolnienie może przyjść z dowolnego kontekstu stosu – tylko budzimy
+ * hosta, wysyłanie odłożonych próbek idzie w jego zadaniu. */
+static os_error_t block_put(struct os_mempool_ext *mpe, void *data, void *arg)
+{
+    os_error_t rc = os_memblock_put_from_cb(&mpe->mpe_mp, data);
+    ble_npl_eventq_put(nimble_port_get_dflt_eventq(), &free_ev);
+    return rc;
+}
+
+void ble_notify_pool_init(ble_npl_event_fn *on_free)
+{
+    os_mempool_ext_init(&mempool_ext, NOTIFY_POOL_BLOCKS, BLOCK_SIZE, pool_mem, "telem");
+    mempool_ext.mpe_put_cb = block_put;
+    ble_npl_event_init(&free_ev, on_free, NULL);
+    os_mbuf_pool_init(&mbuf_pool, &mempool, BLOCK_SIZE, NOTIFY_POOL_BLOCKS);
+}
+
+struct os_mbuf *ble_notify_pool_get(const void *data, uint16_t len)
+{
+    if (len > NOTIFY_POOL_PAYLOAD) return NULL;
+
+    struct os_mbuf *om = os_mbuf_get_pkthdr(&mbuf_pool, 0);
+    if (!om) return NULL;
+
+    if (os_mbuf_append(om, data, len) != 0) {
+        os_mbuf_free_chain(om);
+        return NULL;
+    }
+    return om;
+}
+
+void ble_notify_pool_usage(uint16_t *capacity, uint16_t *in_use,
+                           uint16_t *high_water)
+{
+    *capacity   = mempool.mp_num_blocks;
+    *in_use     = mempool.mp_num_blocks - mempool.mp_num_free;
+    *high_water = mempool.mp_num_blocks - mempool.mp_min_free;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <stdint.h>
+#include "os/os_mbuf.h"
+#include "nimble/nimble_npl.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Własna pula mbufów na dane notyfikacji telemetrii – nie konkuruje
+ * z pulą msys, z której korzysta sam host NimBLE. Nagłówek ATT każdej
+ * notyfikacji i tak idzie z msys (jeden mbuf na notyfikację, alokuje go
+ * ble_att_clt_tx_notify), pula zdejmuje z msys tylko dane. */
+#define NOTIFY_POOL_BLOCKS    8
+#define NOTIFY_POOL_PAYLOAD   16        /* największa notyfikacja [B] */
+
+/* on_free: zdarzenie w kolejce hosta po każdym zwrocie bloku do puli
+ * (stos zwalnia mbuf, gdy pakiet przejmie kontroler). */
+void ble_notify_pool_init(ble_npl_event_fn *on_free);
+
+/* NULL gdy pula pusta. Sam ładunek, bez zapasu na nagłówki. */
+struct os_mbuf *ble_notify_pool_get(const void *data, uint16_t len);
+
+void ble_notify_pool_usage(uint16_t *capacity, uint16_t *in_use,
+                           uint16_t *high_water);
+
+#ifdef __cplusplus
+}
+#endif
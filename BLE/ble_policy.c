@@ -0,0 +1,103 @@
+#include "esp_log.h"
+#include "ble_policy.h"
+
+/* ---------- progi klasyfikacji ---------- */
+#define PARKED_KMH        1.0f      /* poniżej – postój                  */
+#define ACCEL_KMH_PER_S   1.5f      /* |dv/dt| powyżej – przyspieszanie  */
+
+static const char *TAG = "BLE_POL";
+
+/* ---------- tabela parametrów radia ----------
+ * Supervision timeout musi być > (1 + latency) * itvl_max * 2.
+ */
+static const ble_policy_params_t params[RIDE_STATE_COUNT] = {
+    [RIDE_PARKED] = {
+        .adv_itvl_ms = 1000,
+        .conn_itvl_min = 320, .conn_itvl_max = 400,    /* 400–500 ms */
+        .latency = 4,
+        .supervision_tmo = 600,                        /* 6 s        */
+    },
+    [RIDE_CRUISING] = {
+        .adv_itvl_ms = 500,
+        .conn_itvl_min = 80, .conn_itvl_max = 120,     /* 100–150 ms */
+        .latency = 2,
+        .supervision_tmo = 400,
+    },
+    [RIDE_ACCELERATING] = {
+        .adv_itvl_ms = 100,
+        .conn_itvl_min = 24, .conn_itvl_max = 40,      /* 30–50 ms   */
+        .latency = 0,
+        .supervision_tmo = 400,
+    },
+    [RIDE_BULK] = {
+        .adv_itvl_ms = 100,
+        .conn_itvl_min = 6, .conn_itvl_max = 12,       /* 7.5–15 ms  */
+        .latency = 0,
+        .supervision_tmo = 400,
+    },
+};
+
+static const char *names[RIDE_STATE_COUNT] = {
+    [RIDE_PARKED]       = "parked",
+    [RIDE_CRUISING]     = "cruising",
+    [RIDE_ACCELERATING] = "accelerating",
+    [RIDE_BULK]         = "bulk",
+};
+
+static ride_state_t state = RIDE_PARKED;
+static int64_t      entered_us;
+static int64_t      total_us[RIDE_STATE_COUNT];
+static uint32_t     entries[RIDE_STATE_COUNT];
+
+const ble_policy_params_t *ble_policy_params(ride_state_t s)
+{
+    return &params[s < RIDE_STATE_COUNT ? s : RIDE_PARKED];
+}
+
+const char *ble_policy_state_name(ride_state_t s)
+{
+    return s < RIDE_STATE_COUNT ? names[s] : "?";
+}
+
+ride_state_t ble_policy_classify(float kmh, float prev_kmh, float dt_s)
+{
+    if (kmh < PARKED_KMH) return RIDE_PARKED;
+    if (dt_s > 0.0f) {
+        float a = (kmh - prev_kmh) / dt_s;
+        if (a > ACCEL_KMH_PER_S || a < -ACCEL_KMH_PER_S) return RIDE_ACCELERATING;
+    }
+    return RIDE_CRUISING;
+}
+
+bool ble_policy_enter(ride_state_t s, int64_t now_us)
+{
+    if (s >= RIDE_STATE_COUNT || s == state) return false;
+
+    int64_t dur = now_us - entered_us;
+    total_us[state] += dur;
+    ESP_LOGI(TAG, "%s -> %s (after %lld ms)",
+             names[state], names[s], (long long)(dur / 1000));
+
+    state = s;
+    entered_us = now_us;
+    entries[s]++;
+    return true;
+}
+
+ride_state_t ble_policy_state(void)
+{
+    return state;
+}
+
+void ble_policy_report(int64_t now_us)
+{
+    int64_t all = now_us > 0 ? now_us : 1;
+
+    for (int i = 0; i < RIDE_STATE_COUNT; i++) {
+        int64_t t = total_us[i];
+        if (i == (int)state) t += now_us - entered_us;   /* bieżący stan */
+        ESP_LOGI(TAG, "%-12s %6lu x  %8lld ms  %3d%%",
+                 names[i], (unsigned long)entries[i],
+                 (long long)(t / 1000), (int)(t * 100 / all));
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Stan jazdy – steruje cyklem pracy radia. */
+typedef enum {
+    RIDE_PARKED = 0,
+    RIDE_CRUISING,
+    RIDE_ACCELERATING,
+    RIDE_BULK,              /* transfer masowy (np. pobieranie logu) */
+    RIDE_STATE_COUNT
+} ride_state_t;
+
+typedef struct {
+    uint16_t adv_itvl_ms;       /* interwał ogłoszeń                    */
+    uint16_t conn_itvl_min;     /* interwał połączenia [1.25 ms]        */
+    uint16_t conn_itvl_max;
+    uint16_t latency;           /* slave latency [zdarzenia]            */
+    uint16_t supervision_tmo;   /* timeout nadzoru [10 ms]              */
+} ble_policy_params_t;
+
+const ble_policy_params_t *ble_policy_params(ride_state_t s);
+const char *ble_policy_state_name(ride_state_t s);
+
+/* Klasyfikacja na podstawie dwóch kolejnych próbek prędkości. */
+ride_state_t ble_policy_classify(float kmh, float prev_kmh, float dt_s);
+
+/* Zmiana stanu; zwraca true gdy stan faktycznie się zmienił. */
+bool ble_policy_enter(ride_state_t s, int64_t now_us);
+ride_state_t ble_policy_state(void);
+
+/* Log: czas spędzony w każdym stanie od startu. */
+void ble_policy_report(int64_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,8 @@
+#include <stdbool.h>
 #include <string.h>
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
 #include "nvs_flash.h"
 #include "esp_bt.h"
 #include "nimble/nimble_port.h"
@@ -8,6 +11,17 @@
 #include "services/gap/ble_svc_gap.h"
 #include "services/gatt/ble_svc_gatt.h"
 #include "ble_server.h"
+#include "ble_core.h"
+#include "ble_log_xfer.h"
+#include "ble_fb_mirror.h"
+#include "ble_notify_pool.h"
+#include "ble_central.h"
+#include "telemetry.h"
+#include "perf.h"
+#include "trace.h"
+#if CONFIG_PERF_CONSOLE
+#include "esp_console.h"
+#endif
 
 /* ---------- UUID-y ---------- */
 static const ble_uuid128_t SVC_UUID =
@@ -26,21 +40,50 @@ static const ble_uuid128_t CHAR_DIST_UUID =
     BLE_UUID128_INIT(0xC0,0xDE,0xC0,0xDE,0x00,0x00,0x00,0x00,
                      0x00,0x00,0x00,0x00,0xC0,0xDE,0x56,0x7A);
 
+static const ble_uuid128_t CHAR_DIAG_UUID =
+    BLE_UUID128_INIT(0xC0,0xDE,0xC0,0xDE,0x00,0x00,0x00,0x00,
+                     0x00,0x00,0x00,0x00,0xC0,0xDE,0x56,0x7B);
+
+static const ble_uuid128_t CHAR_LOG_UUID =
+    BLE_UUID128_INIT(0xC0,0xDE,0xC0,0xDE,0x00,0x00,0x00,0x00,
+                     0x00,0x00,0x00,0x00,0xC0,0xDE,0x56,0x7C);
+
+static const ble_uuid128_t CHAR_MIRROR_UUID =
+    BLE_UUID128_INIT(0xC0,0xDE,0xC0,0xDE,0x00,0x00,0x00,0x00,
+                     0x00,0x00,0x00,0x00,0xC0,0xDE,0x56,0x7E);
+
+#if CONFIG_PERF_PROBES
+static const ble_uuid128_t CHAR_PERF_UUID =
+    BLE_UUID128_INIT(0xC0,0xDE,0xC0,0xDE,0x00,0x00,0x00,0x00,
+                     0x00,0x00,0x00,0x00,0xC0,0xDE,0x56,0x7D);
+#endif
+
 /* ---------- zmienne globalne ---------- */
 static const char *TAG = "BLE_SRV";
 static uint8_t  own_addr_type;
-static uint16_t conn_handle = BLE_HS_CONN_HANDLE_NONE;
 
-static uint16_t h_speed, h_avg, h_dist;
+static uint16_t h_chr[BLE_CHR_COUNT];
+
+static portMUX_TYPE core_mux = portMUX_INITIALIZER_UNLOCKED;
 
 /* ---------- GATT ---------- */
 static int chr_access_cb(uint16_t conn, uint16_t attr,
                          struct ble_gatt_access_ctxt *ctxt, void *arg)
 {
-    float val = 0.0f;
-    memcpy(&val, arg, sizeof(float));           /* zwróć ostatnią wartość */
-    return os_mbuf_append(ctxt->om, &val, sizeof(val));
+    uint8_t buf[BLE_DIAG_LEN];
+    size_t len = ble_core_read((ble_chr_t)(uintptr_t)arg, buf, sizeof(buf));
+    return os_mbuf_append(ctxt->om, buf, len);
+}
+
+#if CONFIG_PERF_PROBES
+static int perf_access_cb(uint16_t conn, uint16_t attr,
+                          struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+    static uint8_t buf[PERF_PACK_MAX];   /* za duży na stos hosta */
+    size_t len = perf_pack(buf, sizeof(buf));
+    return os_mbuf_append(ctxt->om, buf, len);
 }
+#endif
 
 static struct ble_gatt_svc_def gatt_svcs[] = {
     { /* Primary Service */
@@ -51,23 +94,49 @@ static struct ble_gatt_svc_def gatt_svcs[] = {
               .uuid = (ble_uuid_t *)&CHAR_SPEED_UUID,
               .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
               .access_cb = chr_access_cb,
-              .val_handle = &h_speed,
-              .arg = &h_speed,
+              .val_handle = &h_chr[BLE_CHR_SPEED],
+              .arg = (void *)BLE_CHR_SPEED,
           },
           {   /* average */
               .uuid = (ble_uuid_t *)&CHAR_AVG_UUID,
               .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
               .access_cb = chr_access_cb,
-              .val_handle = &h_avg,
-              .arg = &h_avg,
+              .val_handle = &h_chr[BLE_CHR_AVG],
+              .arg = (void *)BLE_CHR_AVG,
           },
           {   /* distance */
               .uuid = (ble_uuid_t *)&CHAR_DIST_UUID,
               .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
               .access_cb = chr_access_cb,
-              .val_handle = &h_dist,
-              .arg = &h_dist,
+              .val_handle = &h_chr[BLE_CHR_DIST],
+              .arg = (void *)BLE_CHR_DIST,
+          },
+          {   /* diagnostyka puli notyfikacji */
+              .uuid = (ble_uuid_t *)&CHAR_DIAG_UUID,
+              .flags = BLE_GATT_CHR_F_READ,
+              .access_cb = chr_access_cb,
+              .val_handle = &h_chr[BLE_CHR_DIAG],
+              .arg = (void *)BLE_CHR_DIAG,
+          },
+          {   /* pobieranie dziennika (CSV), odczyt = podsumowanie */
+              .uuid = (ble_uuid_t *)&CHAR_LOG_UUID,
+              .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_NOTIFY,
+              .access_cb = ble_log_xfer_access,
+              .val_handle = &ble_log_xfer_handle,
           },
+          {   /* kopia ekranu (strumień fb_mirror), zapis 0x01 = ramka kluczowa */
+              .uuid = (ble_uuid_t *)&CHAR_MIRROR_UUID,
+              .flags = BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_NOTIFY,
+              .access_cb = ble_fb_mirror_access,
+              .val_handle = &ble_fb_mirror_handle,
+          },
+#if CONFIG_PERF_PROBES
+          {   /* histogramy opóźnień, obciążenie (blob perf_pack) */
+              .uuid = (ble_uuid_t *)&CHAR_PERF_UUID,
+              .flags = BLE_GATT_CHR_F_READ,
+              .access_cb = perf_access_cb,
+          },
+#endif
           { 0 } /* terminator */
       }
     },
@@ -75,60 +144,188 @@ static struct ble_gatt_svc_def gatt_svcs[] = {
 };
 
 /* ---------- GAP ---------- */
+static bool is_telemetry(uint16_t attr)
+{
+    for (int i = 0; i < BLE_CHR_DIAG; i++)
+        if (h_chr[i] == attr) return true;
+    return false;
+}
+
 static void advertise(void);
 static int gap_event(struct ble_gap_event *e, void *arg)
 {
     switch (e->type) {
     case BLE_GAP_EVENT_CONNECT:
         if (e->connect.status == 0) {
-            conn_handle = e->connect.conn_handle;
-            ESP_LOGI(TAG, "Connected");
+            TRACE("BLE connected conn=%u", e->connect.conn_handle);
+            ble_core_on_connect(e->connect.conn_handle);
         } else {
             advertise();
         }
         break;
     case BLE_GAP_EVENT_DISCONNECT:
-        ESP_LOGI(TAG, "Disconnected");
-        conn_handle = BLE_HS_CONN_HANDLE_NONE;
+        TRACE("BLE disconnected reason=0x%x", e->disconnect.reason);
+        ble_core_on_disconnect();
+        ble_log_xfer_on_disconnect();
+        ble_fb_mirror_on_disconnect();
         advertise();
         break;
+    case BLE_GAP_EVENT_NOTIFY_TX:
+        /* każdy odbiorca liczy tylko swoje notyfikacje */
+        if (e->notify_tx.attr_handle == ble_log_xfer_handle)
+            ble_log_xfer_on_tx();
+        else if (is_telemetry(e->notify_tx.attr_handle))
+            ble_core_on_notify_tx();
+        break;
+    case BLE_GAP_EVENT_SUBSCRIBE:
+        ble_fb_mirror_on_subscribe(e->subscribe.conn_handle, e->subscribe.attr_handle,
+                                   e->subscribe.cur_notify);
+        break;
+    case BLE_GAP_EVENT_CONN_UPDATE:
+        TRACE("BLE conn params updated status=%d", e->conn_update.status);
+        break;
     default:
         break;
     }
     return 0;
 }
 
-static void advertise(void)
+static int set_adv_fields(const ble_adv_cfg_t *cfg)
 {
     struct ble_hs_adv_fields f = {0};
+
     f.name = (uint8_t *)"BikeMeter";
     f.name_len = strlen((char *)f.name);
     f.name_is_complete = 1;
-    f.uuids128 = (ble_uuid128_t *)&SVC_UUID;
-    f.num_uuids128 = 1;
-    f.uuids128_is_complete = 1;
-    ble_gap_adv_set_fields(&f);
+
+    if (cfg->mfg_len) {
+        f.mfg_data = cfg->mfg;
+        f.mfg_data_len = cfg->mfg_len;
+    } else {
+        f.uuids128 = (ble_uuid128_t *)&SVC_UUID;
+        f.num_uuids128 = 1;
+        f.uuids128_is_complete = 1;
+    }
+    return ble_gap_adv_set_fields(&f);
+}
+
+static void advertise(void)
+{
+    ble_adv_cfg_t cfg;
+    ble_core_adv_config(&cfg);
+
+    int rc = set_adv_fields(&cfg);
+    if (rc != 0) {
+        TRACE("BLE adv_set_fields rc=%d", rc);
+        return;
+    }
 
     struct ble_gap_adv_params p = {
-        .conn_mode = BLE_GAP_CONN_MODE_UND,
+        .conn_mode = cfg.connectable ? BLE_GAP_CONN_MODE_UND : BLE_GAP_CONN_MODE_NON,
         .disc_mode = BLE_GAP_DISC_MODE_GEN,
+        .itvl_min = BLE_GAP_ADV_ITVL_MS(cfg.itvl_ms),
+        .itvl_max = BLE_GAP_ADV_ITVL_MS(cfg.itvl_ms),
     };
     ble_gap_adv_start(own_addr_type, NULL, BLE_HS_FOREVER, &p,
                       gap_event, NULL);
 }
 
-/* ---------- helper NOTIFY ---------- */
-static void notify_float(uint16_t h, float v)
+/* ---------- adapter NimBLE dla rdzenia ---------- */
+static bool host_notify(uint16_t conn, ble_chr_t chr, const void *data, uint16_t len)
+{
+    /* dane z własnej puli; z msys idzie już tylko nagłówek ATT */
+    struct os_mbuf *om = ble_notify_pool_get(data, len);
+    if (!om) return false;
+    ble_gatts_notify_custom(conn, h_chr[chr], om);  /* zwalnia om także przy błędzie */
+    if (chr == BLE_CHR_SPEED) PERF_STAGE(PERF_STAGE_BLE);
+    return true;
+}
+
+static void host_adv_refresh(bool restart)
+{
+    if (restart) {
+        if (!ble_gap_adv_active()) return;
+        ble_gap_adv_stop();
+        advertise();
+        return;
+    }
+    ble_adv_cfg_t cfg;
+    ble_core_adv_config(&cfg);
+    set_adv_fields(&cfg);
+}
+
+static void host_conn_params(uint16_t conn, const ble_policy_params_t *pp)
+{
+    struct ble_gap_upd_params u = {
+        .itvl_min = pp->conn_itvl_min,
+        .itvl_max = pp->conn_itvl_max,
+        .latency = pp->latency,
+        .supervision_timeout = pp->supervision_tmo,
+    };
+    int rc = ble_gap_update_params(conn, &u);
+    if (rc != 0) TRACE("BLE update_params rc=%d", rc);
+}
+
+static void pool_free_event(struct ble_npl_event *ev)
 {
-    if (conn_handle == BLE_HS_CONN_HANDLE_NONE) return;
-    struct os_mbuf *om = ble_hs_mbuf_from_flat(&v, sizeof(v));
-    if (om) ble_gatts_notify_custom(conn_handle, h, om);
+    ble_core_on_tx_done();
 }
 
+static void host_lock(void)   { taskENTER_CRITICAL(&core_mux); }
+static void host_unlock(void) { taskEXIT_CRITICAL(&core_mux); }
+
+static const ble_core_host_t nimble_host = {
+    .notify      = host_notify,
+    .adv_refresh = host_adv_refresh,
+    .conn_params = host_conn_params,
+    .pool_usage  = ble_notify_pool_usage,
+    .now_us      = esp_timer_get_time,
+    .lock        = host_lock,
+    .unlock      = host_unlock,
+};
+
 /* ---------- API ---------- */
-void notify_speed(float v)     { notify_float(h_speed, v); }
-void notify_avg_speed(float v) { notify_float(h_avg,   v); }
-void notify_distance(float v)  { notify_float(h_dist,  v); }
+void notify_speed(float v)     { ble_core_publish(BLE_CHR_SPEED, v); }
+void notify_avg_speed(float v) { ble_core_publish(BLE_CHR_AVG,   v); }
+void notify_distance(float v)  { ble_core_publish(BLE_CHR_DIST,  v); }
+
+void ble_server_set_mode(ble_mode_t m)       { ble_core_set_mode(m); }
+void ble_server_broadcast_commit(void)       { ble_core_broadcast_commit(); }
+void ble_server_set_ride_state(ride_state_t s) { ble_core_set_ride_state(s); }
+void ble_server_set_bulk(bool on)            { ble_core_set_bulk(on); }
+void ble_server_pool_stats(ble_notify_stats_t *out) { ble_core_stats(out); }
+
+void ble_server_log_stats(void)
+{
+    ble_notify_stats_t st;
+    ble_core_stats(&st);
+    ESP_LOGI(TAG, "notify pool: %u/%u in use, hwm %u, pending %u, "
+             "sent %lu, deferred %lu, dropped %lu, lat max %lu us (%lu over bound)",
+             st.in_use, st.capacity, st.high_water, st.pending,
+             (unsigned long)st.sent, (unsigned long)st.deferred,
+             (unsigned long)st.dropped, (unsigned long)st.lat_max_us,
+             (unsigned long)st.lat_over);
+    ESP_LOGI(TAG, "msys: %d/%d free", os_msys_num_free(), os_msys_count());
+}
+
+#if CONFIG_PERF_CONSOLE
+static int cmd_ble(int argc, char **argv)
+{
+    ble_server_log_stats();
+    ble_fb_mirror_log_stats();
+    return 0;
+}
+
+void ble_server_console_register(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "ble",
+        .help = "Notify pool and msys use, queued/dropped samples, screen mirror",
+        .func = cmd_ble,
+    };
+    esp_console_cmd_register(&cmd);
+}
+#endif
 
 /* ---------- inicjalizacja ---------- */
 static void host_task(void *p)
@@ -140,7 +337,9 @@ static void host_task(void *p)
 static void on_sync(void)
 {
     ble_hs_id_infer_auto(0, &own_addr_type);
+    ble_core_on_sync();
     advertise();
+    ble_central_start(own_addr_type);
 }
 
 void ble_server_init(void)
@@ -149,6 +348,10 @@ void ble_server_init(void)
     esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT);
 
     nimble_port_init();
+    ble_notify_pool_init(pool_free_event);
+    ble_log_xfer_init();
+    ble_fb_mirror_init();
+    ble_core_init(&nimble_host);
     ble_svc_gap_init();
     ble_svc_gatt_init();
 
@@ -1,14 +1,30 @@
 #pragma once
+#include <stdbool.h>
+#include "ble_core.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 void ble_server_init(void);
+void ble_server_set_mode(ble_mode_t mode);
+
+/* Koniec próbki – w trybie rozgłoszeniowym odświeża dane ogłoszenia. */
+void ble_server_broadcast_commit(void);
+
+/* Polityka radia: interwały ogłoszeń i parametry połączenia wg stanu jazdy.
+ * Transfer masowy ma pierwszeństwo nad stanem jazdy. */
+void ble_server_set_ride_state(ride_state_t s);
+void ble_server_set_bulk(bool on);
 
 void notify_speed(float kmh);
 void notify_avg_speed(float kmh);
 void notify_distance(float km);
 
+/* Statystyki puli notyfikacji (też w charakterystyce diagnostycznej). */
+void ble_server_pool_stats(ble_notify_stats_t *out);
+void ble_server_log_stats(void);
+void ble_server_console_register(void);     /* komenda "ble" (CONFIG_PERF_CONSOLE) */
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,15 +1,82 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "esp_log.h"
 #include "ble_server.h"
+#include "ble_fb_mirror.h"
+#include "telemetry.h"
+#include "ride_log.h"
+#include "perf.h"
+#include "trace.h"
+#include "topology.h"
+#include "power.h"
+#include "heap_guard.h"
+#include "ride_screen.h"
+#include "speed_hist.h"
+#if CONFIG_PERF_CONSOLE
+#include "esp_console.h"
+#endif
+
+#define REC_Q_LEN 32
+
+static QueueHandle_t rec_q;
+
+/* wszystko statycznie: rozmiar znany po linkowaniu, sterta nie fragmentuje */
+static StaticQueue_t rec_q_buf;
+static uint8_t       rec_q_storage[REC_Q_LEN * sizeof(ride_sample_t)];
+static StackType_t   recorder_stack[3072];
+static StaticTask_t  recorder_tcb;
+static StackType_t   sensor_stack[4096];
+static StaticTask_t  sensor_tcb;
+
+/* ekran jazdy bez panelu – tylko źródło kopii ekranu przez BLE */
+static sh1106_fb_t   fb;
+static speed_hist_t  hist;
+static ui_screen_t   screen;
+
+/* ---------- rejestrator ----------
+ * Osobne zadanie o niskim priorytecie: kasowanie sektora trwa dziesiątki
+ * ms i nie może opóźniać pomiaru.
+ */
+static void recorder_task(void *arg)
+{
+    static ride_log_t   log;
+    static flash_port_t fp;
+    ride_sample_t s;
+    uint32_t t_base;
+
+    if (flash_port_esp_open(&fp, "ridelog") != ESP_OK ||
+        ride_log_open(&log, &fp) != ESP_OK) {
+        ESP_LOGE("REC", "no ride log partition");
+        vTaskDelete(NULL);
+    }
+    /* oś czasu ciągła między przejazdami – wymaga tego indeks czasu czytnika */
+    t_base = log.last_t_ms ? log.last_t_ms + 1 : 0;
+
+    while (1) {
+        xQueueReceive(rec_q, &s, portMAX_DELAY);
+        s.t_ms += t_base;
+        if (ride_log_append(&log, &s) != ESP_OK) ESP_LOGW("REC", "write failed");
+    }
+}
 
 static void sensor_task(void *arg)
 {
     float v = 10.0f;      /* km/h */
     float sum = 0.0f;
     float dist = 0.0f;    /* km   */
+    float prev = 0.0f;
     uint32_t n = 0;
 
+    sh1106_fb_clear(&fb);
+    speed_hist_reset(&hist);
+    ride_screen_init(&screen, &fb, &hist, esp_timer_get_time);
+
     while (1) {
+        /* symulowana próbka pełni rolę impulsu z czujnika */
+        PERF_PULSE(esp_timer_get_time());
+        PERF_STAGE(PERF_STAGE_SPEED);
         notify_speed(v);
 
         dist += v / 3600.0f;     /* +kilometr = v(km/h) * 1 s */
@@ -18,6 +85,39 @@ static void sensor_task(void *arg)
 
         notify_distance(dist);
         notify_avg_speed(sum / n);
+        ble_server_broadcast_commit();
+        telemetry_set_speed(v, sum / n, dist);
+
+        ride_sample_t rs = {
+            .t_ms = (uint32_t)(esp_timer_get_time() / 1000),
+            .speed_ckmh = (uint16_t)(v * 100.0f),
+            .dist_m = (uint32_t)(dist * 1000.0f),
+        };
+        xQueueSend(rec_q, &rs, 0);      /* pełna kolejka – próbka przepada */
+
+        speed_hist_push(&hist, rs.speed_ckmh);
+        ride_view_t rv = { v, n, rs.dist_m, 0, 1 };
+        ride_screen_set(&rv);
+        ui_render(&screen);
+        ble_fb_mirror_frame(&fb);
+        fb.dirty = 0;                   /* panelu nie ma, strony „wysłane” */
+
+        ble_server_set_ride_state(ble_policy_classify(v, prev, 1.0f));
+        prev = v;
+        /* po pierwszych próbkach rejestrator i konsola są już otwarte */
+        if (n == 3) heap_guard_seal();
+        if (n % 60 == 0) {
+            ble_policy_report(esp_timer_get_time());
+            ble_server_log_stats();
+            ble_fb_mirror_log_stats();
+            heap_guard_report();
+
+            telemetry_t t;
+            telemetry_get(&t);
+            ESP_LOGI("SENSOR", "HR %u bpm (%lld ms ago), power %d W (%lld ms ago)",
+                     t.hr_bpm, (long long)(t.hr_us ? (t.speed_us - t.hr_us) / 1000 : -1),
+                     t.power_w, (long long)(t.power_us ? (t.speed_us - t.power_us) / 1000 : -1));
+        }
 
         /* prosta symulacja */
         v += 1.5f;
@@ -29,6 +129,33 @@ static void sensor_task(void *arg)
 
 void app_main(void)
 {
+    trace_init();
+#if CONFIG_POWER_MGMT
+    power_init(NULL, 0);    /* budzi kontroler BLE (modem sleep) */
+#endif
+#if CONFIG_BLE_START_BROADCAST
+    /* przed startem hosta – pierwsze ogłoszenie już bez połączeń */
+    ble_server_set_mode(BLE_MODE_BROADCAST);
+#endif
     ble_server_init();
-    xTaskCreate(sensor_task, "sensor", 4096, NULL, 5, NULL);
+    rec_q = xQueueCreateStatic(REC_Q_LEN, sizeof(ride_sample_t), rec_q_storage, &rec_q_buf);
+    /* host NimBLE na rdzeniu radia (BT_NIMBLE_PINNED_TO_CORE), pomiar obok */
+    xTaskCreateStaticPinnedToCore(recorder_task, "recorder", sizeof(recorder_stack), NULL,
+                                  TOPO_PRIO_LOG, recorder_stack, &recorder_tcb, TOPO_CORE_UI);
+    xTaskCreateStaticPinnedToCore(sensor_task, "sensor", sizeof(sensor_stack), NULL,
+                                  TOPO_PRIO_SENSOR, sensor_stack, &sensor_tcb, TOPO_CORE_SENSOR);
+
+#if CONFIG_PERF_CONSOLE
+    /* konsola na UART0: "perf" wypisuje histogramy i obciążenie,
+     * "ble" pulę notyfikacji i msys */
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_cfg = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    esp_console_dev_uart_config_t uart_cfg = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    repl_cfg.prompt = "bike>";
+    esp_console_register_help_command();
+    perf_console_register();
+    ble_server_console_register();
+    if (esp_console_new_repl_uart(&uart_cfg, &repl_cfg, &repl) == ESP_OK)
+        esp_console_start_repl(repl);
+#endif
 }
@@ -0,0 +1,42 @@
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "telemetry.h"
+
+static telemetry_t  snap;
+static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+
+void telemetry_set_speed(float kmh, float avg_kmh, float dist_km)
+{
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&mux);
+    snap.speed_kmh = kmh;
+    snap.avg_kmh   = avg_kmh;
+    snap.dist_km   = dist_km;
+    snap.speed_us  = now;
+    taskEXIT_CRITICAL(&mux);
+}
+
+void telemetry_set_hr(uint16_t bpm)
+{
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&mux);
+    snap.hr_bpm = bpm;
+    snap.hr_us  = now;
+    taskEXIT_CRITICAL(&mux);
+}
+
+void telemetry_set_power(int16_t watts)
+{
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&mux);
+    snap.power_w  = watts;
+    snap.power_us = now;
+    taskEXIT_CRITICAL(&mux);
+}
+
+void telemetry_get(telemetry_t *out)
+{
+    taskENTER_CRITICAL(&mux);
+    *out = snap;
+    taskEXIT_CRITICAL(&mux);
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <stdint.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Wspólna migawka telemetrii: własny czujnik + czujniki zewnętrzne.
+ * Znaczniki czasu z esp_timer_get_time() [us], 0 = brak danych. */
+typedef struct {
+    float    speed_kmh;
+    float    avg_kmh;
+    float    dist_km;
+    int64_t  speed_us;
+
+    uint16_t hr_bpm;
+    int64_t  hr_us;
+
+    int16_t  power_w;
+    int64_t  power_us;
+} telemetry_t;
+
+void telemetry_set_speed(float kmh, float avg_kmh, float dist_km);
+void telemetry_set_hr(uint16_t bpm);
+void telemetry_set_power(int16_t watts);
+
+/* Spójna kopia całej migawki. */
+void telemetry_get(telemetry_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,83 @@
+#include <string.h>
+#include "sdkconfig.h"
+
+#if CONFIG_HEAP_GUARD
+
+#include <stdlib.h>
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "heap_guard.h"
+
+static const char *TAG = "HEAP";
+
+static volatile bool sealed;
+static volatile uint32_t allocs, bytes, frees, last_size;
+static char last_task[configMAX_TASK_NAME_LEN];
+static portMUX_TYPE guard_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/* ---------- hooki sterty (CONFIG_HEAP_USE_HOOKS) ---------- */
+void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    if (!sealed || !ptr) return;
+    portENTER_CRITICAL_SAFE(&guard_mux);
+    allocs++;
+    bytes += size;
+    last_size = size;
+    /* nazwa, nie uchwyt – zadanie może już nie żyć w chwili raportu;
+     * funkcje FreeRTOS są w IRAM (bez FREERTOS_PLACE_FUNCTIONS_INTO_FLASH) */
+    const char *name = pcTaskGetName(NULL);
+    size_t i = 0;
+    for (; i < sizeof(last_task) - 1 && name[i]; i++) last_task[i] = name[i];
+    last_task[i] = 0;
+    portEXIT_CRITICAL_SAFE(&guard_mux);
+#if CONFIG_HEAP_GUARD_ABORT
+    esp_rom_printf("heap alloc of %u B after seal\n", (unsigned)size);
+    abort();
+#endif
+}
+
+void IRAM_ATTR esp_heap_trace_free_hook(void *ptr)
+{
+    if (sealed && ptr) frees++;
+}
+
+/* ---------- API ---------- */
+void heap_guard_seal(void)
+{
+    sealed = true;
+    ESP_LOGI(TAG, "sealed, %u B free (min %u B)",
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_8BIT),
+             (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+}
+
+void heap_guard_stats(heap_guard_stats_t *out)
+{
+    portENTER_CRITICAL(&guard_mux);
+    out->allocs = allocs;
+    out->bytes = bytes;
+    out->frees = frees;
+    out->last_size = last_size;
+    strlcpy(out->last_task, last_task[0] ? last_task : "-", sizeof(out->last_task));
+    portEXIT_CRITICAL(&guard_mux);
+}
+
+void heap_guard_report(void)
+{
+    heap_guard_stats_t st;
+    heap_guard_stats(&st);
+
+    if (st.allocs)
+        ESP_LOGW(TAG, "%lu allocs (%lu B, %lu frees) after seal, last %lu B from %s",
+                 (unsigned long)st.allocs, (unsigned long)st.bytes, (unsigned long)st.frees,
+                 (unsigned long)st.last_size, st.last_task);
+    ESP_LOGI(TAG, "free %u B, min %u B, largest block %u B",
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_8BIT),
+             (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+}
+
+#endif /* CONFIG_HEAP_GUARD */
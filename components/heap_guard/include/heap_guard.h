@@ -0,0 +1,41 @@
+#pragma once
+#include <stdint.h>
+#include "sdkconfig.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Stan ustalony bez sterty.
+ *
+ * Zadania, kolejki, pierścienie i bufory sterowników są statyczne albo
+ * tworzone przy starcie. heap_guard_seal() zamyka fazę startu – każda
+ * późniejsza alokacja jest liczona (z nazwą zadania), a przy
+ * CONFIG_HEAP_GUARD_ABORT kończy się abortem.
+ */
+
+typedef struct {
+    uint32_t allocs;        /* alokacje po seal */
+    uint32_t bytes;
+    uint32_t frees;
+    char     last_task[16]; /* kto alokował ostatnio (configMAX_TASK_NAME_LEN) */
+    uint32_t last_size;
+} heap_guard_stats_t;
+
+#if CONFIG_HEAP_GUARD
+
+void heap_guard_seal(void);
+void heap_guard_stats(heap_guard_stats_t *out);
+
+/* Log: alokacje po starcie, wolna sterta i jej minimum. */
+void heap_guard_report(void);
+
+#else
+
+#define heap_guard_seal()   ((void)0)
+#define heap_guard_report() ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
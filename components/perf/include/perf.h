@@ -0,0 +1,80 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Sondy opóźnień i obciążenia.
+ *
+ * Impuls z czujnika koła (PERF_PULSE w ISR) zapisuje znacznik czasu
+ * z esp_timer (ISR i tak go czyta). Każdy kolejny etap (PERF_STAGE) przy
+ * pierwszym przejściu po danym impulsie dokłada różnicę do swojego
+ * histogramu o stałych kubełkach 2^i µs. Nie licznik cykli: przy DFS
+ * zmienia tempo, w light sleep stoi i jest osobny dla każdego rdzenia.
+ * Etap DISPLAY liczy od impulsu, który przerobił ostatni SPEED – to jego
+ * prędkość jest w klatce.
+ *
+ * Bez CONFIG_PERF_PROBES wszystkie makra znikają.
+ */
+
+typedef enum {
+    PERF_STAGE_SPEED = 0,   /* prędkość policzona */
+    PERF_STAGE_DISPLAY,     /* klatka z nią wysłana do wyświetlacza */
+    PERF_STAGE_BLE,         /* notyfikacja przekazana do stosu BLE */
+    PERF_STAGE_COUNT,
+} perf_stage_t;
+
+#define PERF_BUCKETS    20      /* ostatni: >= 2^19 µs (~0.5 s) */
+#define PERF_TASKS_MAX  16
+#define PERF_PACK_MAX   (4 + PERF_STAGE_COUNT * (12 + 2 * PERF_BUCKETS) + 4)
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t bucket[PERF_BUCKETS];
+} perf_hist_t;
+
+#if CONFIG_PERF_PROBES
+
+void perf_pulse_isr(int64_t now_us);
+void perf_stage(perf_stage_t s);
+
+/* Czas zajętości magistrali wyświetlacza (I2C) w µs. */
+void perf_bus_busy(uint32_t us);
+
+#define PERF_PULSE(now_us)      perf_pulse_isr(now_us)
+#define PERF_STAGE(s)           perf_stage(s)
+#define PERF_BUS_BUSY(us)       perf_bus_busy(us)
+
+const perf_hist_t *perf_hist(perf_stage_t s);
+const char *perf_stage_name(perf_stage_t s);
+
+/* Raport na log: histogramy, obciążenie zadań, stosy, magistrala. */
+void perf_report(void);
+
+/* Zwięzły blob binarny dla charakterystyki diagnostycznej (LE);
+ * obciążenie CPU i magistrali pochodzą z ostatniego perf_report():
+ *   u8 wersja, u8 etapy, u8 kubełki, u8 obciążenie CPU [%]
+ *   etap: u32 count, u32 max_us, u32 avg_us, u16 kubełki[] (nasycone)
+ *   u16 zajętość magistrali [‰], u16 zarezerwowane
+ * Zwraca długość (<= PERF_PACK_MAX), 0 gdy bufor za mały. */
+size_t perf_pack(uint8_t *buf, size_t cap);
+
+#if CONFIG_PERF_CONSOLE
+void perf_console_register(void);
+#endif
+
+#else
+
+#define PERF_PULSE(now_us)      ((void)0)
+#define PERF_STAGE(s)           ((void)0)
+#define PERF_BUS_BUSY(us)       ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,190 @@
+#include <string.h>
+#include "sdkconfig.h"
+
+#if CONFIG_PERF_PROBES
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "perf.h"
+
+static const char *TAG = "PERF";
+
+/* ---------- znacznik impulsu ---------- */
+/* seq nieparzyste = zapis w toku; czytelnik powtarza odczyt */
+typedef struct {
+    uint32_t seq;
+    int64_t  us;
+} pulse_t;
+
+static volatile pulse_t pulse;
+
+/* impuls, który ostatnio przerobił etap SPEED: klatkę liczymy od niego,
+ * bo do wysłania klatki mógł już przyjść następny impuls */
+static pulse_t  speed_pulse;
+static uint32_t stage_seen[PERF_STAGE_COUNT];
+static perf_hist_t hist[PERF_STAGE_COUNT];
+
+static const char *const stage_names[PERF_STAGE_COUNT] = {
+    "pulse->speed", "pulse->display", "pulse->ble",
+};
+
+void IRAM_ATTR perf_pulse_isr(int64_t now_us)
+{
+    pulse.seq++;
+    pulse.us = now_us;
+    pulse.seq++;
+}
+
+static void hist_add(perf_hist_t *h, uint32_t us)
+{
+    int b = 0;
+    while (b < PERF_BUCKETS - 1 && (us >> (b + 1)) != 0) b++;
+    h->bucket[b]++;
+    h->count++;
+    h->sum_us += us;
+    if (us > h->max_us) h->max_us = us;
+}
+
+void perf_stage(perf_stage_t s)
+{
+    int64_t now = esp_timer_get_time();
+    pulse_t p;
+
+    if (s == PERF_STAGE_DISPLAY) {
+        p = speed_pulse;
+    } else {
+        do {
+            p.seq = pulse.seq;
+            p.us = pulse.us;
+        } while ((p.seq & 1) || p.seq != pulse.seq);
+    }
+
+    if (p.seq == 0 || p.seq == stage_seen[s]) return;   /* ten impuls już policzony */
+    stage_seen[s] = p.seq;
+    if (s == PERF_STAGE_SPEED) speed_pulse = p;
+
+    hist_add(&hist[s], (uint32_t)(now - p.us));
+}
+
+const perf_hist_t *perf_hist(perf_stage_t s) { return &hist[s]; }
+const char *perf_stage_name(perf_stage_t s)  { return stage_names[s]; }
+
+/* ---------- magistrala ---------- */
+static volatile uint32_t bus_busy_us;
+
+void perf_bus_busy(uint32_t us)
+{
+    bus_busy_us += us;
+}
+
+/* ---------- zadania ---------- */
+typedef struct {
+    TaskHandle_t h;
+    uint32_t     runtime;
+} task_prev_t;
+
+static task_prev_t prev_tasks[PERF_TASKS_MAX];
+static uint32_t    prev_total;
+static int64_t     prev_bus_at;
+static uint32_t    prev_bus_us;
+static uint8_t     last_cpu_pct;
+static uint16_t    last_bus_permille;
+
+static uint32_t prev_runtime(TaskHandle_t h)
+{
+    for (int i = 0; i < PERF_TASKS_MAX; i++)
+        if (prev_tasks[i].h == h) return prev_tasks[i].runtime;
+    return 0;
+}
+
+static uint16_t bus_permille(void)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t busy = bus_busy_us;
+    uint16_t r = 0;
+
+    if (prev_bus_at && now > prev_bus_at)
+        r = (uint16_t)((uint64_t)(busy - prev_bus_us) * 1000 / (uint64_t)(now - prev_bus_at));
+    prev_bus_at = now;
+    prev_bus_us = busy;
+    last_bus_permille = r;
+    return r;
+}
+
+static void report_tasks(void)
+{
+    static TaskStatus_t st[PERF_TASKS_MAX];
+    uint32_t total;
+    UBaseType_t n = uxTaskGetSystemState(st, PERF_TASKS_MAX, &total);
+
+    /* licznik czasu jest wspólny dla rdzeni – na 2 rdzeniach suma to 200% */
+    uint32_t dt = total - prev_total;
+    uint32_t idle = 0;
+
+    for (UBaseType_t i = 0; i < n; i++) {
+        uint32_t run = st[i].ulRunTimeCounter - prev_runtime(st[i].xHandle);
+        uint32_t pct10 = dt ? (uint32_t)((uint64_t)run * 1000 / dt) : 0;
+        if (strncmp(st[i].pcTaskName, "IDLE", 4) == 0) idle += pct10;
+        ESP_LOGI(TAG, "task %-12s prio %2u load %3lu.%lu%% stack free %lu B",
+                 st[i].pcTaskName, (unsigned)st[i].uxCurrentPriority,
+                 (unsigned long)(pct10 / 10), (unsigned long)(pct10 % 10),
+                 (unsigned long)st[i].usStackHighWaterMark * sizeof(StackType_t));
+    }
+    for (UBaseType_t i = 0; i < n && i < PERF_TASKS_MAX; i++) {
+        prev_tasks[i].h = st[i].xHandle;
+        prev_tasks[i].runtime = st[i].ulRunTimeCounter;
+    }
+    prev_total = total;
+
+    uint32_t cap = 10 * 100 * portNUM_PROCESSORS;
+    last_cpu_pct = (uint8_t)(idle < cap ? (cap - idle) / (10 * portNUM_PROCESSORS) : 0);
+}
+
+void perf_report(void)
+{
+    for (int s = 0; s < PERF_STAGE_COUNT; s++) {
+        const perf_hist_t *h = &hist[s];
+        char line[PERF_BUCKETS * 11 + 1];  /* " 4294967295" na kubełek */
+        int o = 0;
+
+        for (int b = 0; b < PERF_BUCKETS && o < (int)sizeof(line); b++)
+            o += snprintf(line + o, sizeof(line) - o, " %lu", (unsigned long)h->bucket[b]);
+        ESP_LOGI(TAG, "%-14s n %lu avg %lu us max %lu us |%s",
+                 stage_names[s], (unsigned long)h->count,
+                 (unsigned long)(h->count ? h->sum_us / h->count : 0),
+                 (unsigned long)h->max_us, line);
+    }
+    report_tasks();
+    uint16_t bus = bus_permille();
+    ESP_LOGI(TAG, "cpu %u%%, display bus %u.%u%% busy", last_cpu_pct, bus / 10, bus % 10);
+}
+
+/* ---------- blob diagnostyczny ---------- */
+static uint8_t *put_le16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; return p + 2; }
+static uint8_t *put_le32(uint8_t *p, uint32_t v) { return put_le16(put_le16(p, v), v >> 16); }
+
+size_t perf_pack(uint8_t *buf, size_t cap)
+{
+    if (cap < PERF_PACK_MAX) return 0;
+    uint8_t *p = buf;
+
+    *p++ = 1;
+    *p++ = PERF_STAGE_COUNT;
+    *p++ = PERF_BUCKETS;
+    *p++ = last_cpu_pct;
+    for (int s = 0; s < PERF_STAGE_COUNT; s++) {
+        const perf_hist_t *h = &hist[s];
+        p = put_le32(p, h->count);
+        p = put_le32(p, h->max_us);
+        p = put_le32(p, h->count ? (uint32_t)(h->sum_us / h->count) : 0);
+        for (int b = 0; b < PERF_BUCKETS; b++)
+            p = put_le16(p, h->bucket[b] > 0xFFFF ? 0xFFFF : (uint16_t)h->bucket[b]);
+    }
+    p = put_le16(p, last_bus_permille);
+    p = put_le16(p, 0);
+    return p - buf;
+}
+
+#endif /* CONFIG_PERF_PROBES */
@@ -0,0 +1,24 @@
+#include "sdkconfig.h"
+
+#if CONFIG_PERF_CONSOLE
+
+#include "esp_console.h"
+#include "perf.h"
+
+static int cmd_perf(int argc, char **argv)
+{
+    perf_report();
+    return 0;
+}
+
+void perf_console_register(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "perf",
+        .help = "Latency histograms, task load, stacks and display bus use",
+        .func = cmd_perf,
+    };
+    esp_console_cmd_register(&cmd);
+}
+
+#endif /* CONFIG_PERF_CONSOLE */
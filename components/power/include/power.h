@@ -0,0 +1,43 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+/* Zarządzanie energią: DFS, tickless idle i automatyczny light sleep.
+ *
+ * Piny budzenia zostają przy swoich przerwaniach zboczowych; tuż przed
+ * uśpieniem dostają wakeup poziomem przeciwnym do bieżącego, po
+ * przebudzeniu wraca zbocze. Opadające zbocze z czasu snu zostaje
+ * w statusie GPIO i ISR obsłuży je normalnie; puszczenie pinu
+ * (wakeup stanem wysokim) jest kasowane, żeby nie udawało impulsu.
+ *
+ * Stemple esp_timer są korygowane o czas snu, ale przebudzenie trwa –
+ * dlatego w trakcie jazdy power_hold(true) blokuje light sleep i trzyma
+ * pełne taktowanie: okres impulsów jest mierzony dokładnie, a licznik
+ * cykli (perf, trace) tyka stałym tempem. Po postoju pierwszy impuls
+ * i tak tylko wznawia pomiar.
+ */
+
+#define POWER_WAKE_MAX      4
+
+/* Szacunek prądu (ESP32, datasheet) – do porównań, nie zamiast miernika */
+#define POWER_EST_SLEEP_UA  800
+#define POWER_EST_ACTIVE_UA 20000
+
+#if CONFIG_POWER_MGMT
+
+/* Piny muszą mieć już ustawione przerwanie zboczowe (gpio_set_intr_type). */
+esp_err_t power_init(const gpio_num_t *wake_pins, size_t count);
+
+/* Jazda: bez light sleep i na pełnym zegarze. Wywołania idempotentne. */
+void power_hold(bool on);
+
+/* Impuls, który obudził CPU, i pierwsza policzona z niego próbka. */
+void power_wake_sample(int64_t pulse_us, int64_t sample_us);
+
+void power_report(void);
+
+#endif
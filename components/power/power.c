@@ -0,0 +1,154 @@
+#include "sdkconfig.h"
+
+#if CONFIG_POWER_MGMT
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "hal/gpio_ll.h"
+#include "soc/gpio_struct.h"
+#include "power.h"
+
+#define WAKE_WINDOW_US  10000   /* impuls tyle po przebudzeniu = to on obudził */
+
+static const char *TAG = "POWER";
+
+static esp_pm_lock_handle_t ride_lock, ride_freq_lock;
+static bool     held;
+
+static gpio_num_t      wake_pin[POWER_WAKE_MAX];
+static gpio_int_type_t wake_edge[POWER_WAKE_MAX];
+static bool            armed_high[POWER_WAKE_MAX];
+static size_t          wake_count;
+
+/* statystyki snu */
+static volatile int64_t  slept_us;
+static volatile uint32_t sleeps;
+static volatile int64_t  last_wake_us;
+static int64_t           stats_from_us;
+
+typedef struct {
+    uint32_t n;
+    uint32_t max_us;
+    uint64_t sum_us;
+} lat_t;
+
+static lat_t lat_isr, lat_sample;
+
+/* ---------- light sleep ---------- */
+/* wołane z zadania idle, przy zablokowanych przerwaniach */
+static esp_err_t IRAM_ATTR sleep_enter(int64_t sleep_time_us, void *arg)
+{
+    for (size_t i = 0; i < wake_count; i++) {
+        gpio_num_t p = wake_pin[i];
+        armed_high[i] = gpio_ll_get_level(&GPIO, p) == 0;
+        gpio_ll_set_intr_type(&GPIO, p, armed_high[i] ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+        gpio_ll_wakeup_enable(&GPIO, p);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t IRAM_ATTR sleep_exit(int64_t sleep_time_us, void *arg)
+{
+    for (size_t i = 0; i < wake_count; i++) {
+        gpio_num_t p = wake_pin[i];
+        gpio_ll_wakeup_disable(&GPIO, p);
+        gpio_ll_set_intr_type(&GPIO, p, wake_edge[i]);
+        if (armed_high[i]) gpio_ll_clear_intr_status_bit(&GPIO, p);
+    }
+    slept_us += sleep_time_us;
+    sleeps++;
+    last_wake_us = esp_timer_get_time();
+    return ESP_OK;
+}
+
+esp_err_t power_init(const gpio_num_t *wake_pins, size_t count)
+{
+    if (count > POWER_WAKE_MAX) return ESP_ERR_INVALID_ARG;
+
+    esp_pm_config_t pm = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_POWER_MIN_MHZ,
+        .light_sleep_enable = true,
+    };
+    esp_err_t err = esp_pm_configure(&pm);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "pm configure failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    err = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "ride", &ride_lock);
+    if (err == ESP_OK) err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "ride_freq", &ride_freq_lock);
+    if (err != ESP_OK) return err;
+
+    for (size_t i = 0; i < count; i++) {
+        wake_pin[i] = wake_pins[i];
+        wake_edge[i] = GPIO.pin[wake_pins[i]].int_type;
+    }
+    wake_count = count;
+    if (count) esp_sleep_enable_gpio_wakeup();
+
+    esp_pm_sleep_cbs_register_config_t cbs = {
+        .enter_cb = sleep_enter,
+        .exit_cb = sleep_exit,
+    };
+    err = esp_pm_light_sleep_register_cbs(&cbs);
+    stats_from_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "DFS %d-%d MHz, light sleep, %u wake pins",
+             pm.min_freq_mhz, pm.max_freq_mhz, (unsigned)count);
+    return err;
+}
+
+void power_hold(bool on)
+{
+    if (on == held || !ride_lock) return;
+    held = on;
+    if (on) {
+        esp_pm_lock_acquire(ride_lock);
+        esp_pm_lock_acquire(ride_freq_lock);
+    } else {
+        esp_pm_lock_release(ride_freq_lock);
+        esp_pm_lock_release(ride_lock);
+    }
+}
+
+static void lat_add(lat_t *l, int64_t us)
+{
+    l->n++;
+    l->sum_us += us;
+    if (us > l->max_us) l->max_us = (uint32_t)us;
+}
+
+void power_wake_sample(int64_t pulse_us, int64_t sample_us)
+{
+    int64_t wake = last_wake_us;
+    if (!wake || pulse_us < wake || pulse_us - wake > WAKE_WINDOW_US) return;
+    lat_add(&lat_isr, pulse_us - wake);
+    lat_add(&lat_sample, sample_us - wake);
+}
+
+void power_report(void)
+{
+#if CONFIG_POWER_BENCH
+    int64_t now = esp_timer_get_time();
+    int64_t span = now - stats_from_us;
+    uint32_t res = span > 0 ? (uint32_t)(slept_us * 1000 / span) : 0;      /* ‰ */
+    uint32_t est = (POWER_EST_SLEEP_UA * res + POWER_EST_ACTIVE_UA * (1000 - res)) / 1000;
+
+    ESP_LOGI(TAG, "light sleep %lu.%lu%% (%lu sleeps), est. %lu.%02lu mA%s",
+             (unsigned long)(res / 10), (unsigned long)(res % 10), (unsigned long)sleeps,
+             (unsigned long)(est / 1000), (unsigned long)(est % 1000 / 10),
+             held ? ", riding lock held" : "");
+    if (lat_sample.n)
+        ESP_LOGI(TAG, "wake->isr avg %lu max %lu us, wake->sample avg %lu max %lu us (n %lu)",
+                 (unsigned long)(lat_isr.sum_us / lat_isr.n), (unsigned long)lat_isr.max_us,
+                 (unsigned long)(lat_sample.sum_us / lat_sample.n), (unsigned long)lat_sample.max_us,
+                 (unsigned long)lat_sample.n);
+    slept_us = 0;
+    sleeps = 0;
+    stats_from_us = now;
+#endif
+}
+
+#endif /* CONFIG_POWER_MGMT */
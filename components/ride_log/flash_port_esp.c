@@ -0,0 +1,54 @@
+#include "esp_partition.h"
+#include "flash_port.h"
+
+static esp_err_t part_read(flash_port_t *fp, uint32_t off, void *dst, size_t len)
+{
+    return esp_partition_read(fp->ctx, off, dst, len);
+}
+
+static esp_err_t part_write(flash_port_t *fp, uint32_t off, const void *src, size_t len)
+{
+    return esp_partition_write(fp->ctx, off, src, len);
+}
+
+static esp_err_t part_erase(flash_port_t *fp, uint32_t off)
+{
+    return esp_partition_erase_range(fp->ctx, off, FLASH_SECTOR_SIZE);
+}
+
+static esp_err_t part_map(flash_port_t *fp, const void **out)
+{
+    esp_partition_mmap_handle_t h;
+    esp_err_t err = esp_partition_mmap(fp->ctx, 0, fp->size, ESP_PARTITION_MMAP_DATA,
+                                       out, &h);
+    if (err != ESP_OK) return err;
+    fp->mapped = *out;
+    fp->map_handle = h;
+    return ESP_OK;
+}
+
+static void part_unmap(flash_port_t *fp)
+{
+    if (!fp->mapped) return;
+    esp_partition_munmap(fp->map_handle);
+    fp->mapped = NULL;
+}
+
+esp_err_t flash_port_esp_open(flash_port_t *fp, const char *label)
+{
+    const esp_partition_t *p = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                        ESP_PARTITION_SUBTYPE_ANY,
+                                                        label);
+    if (!p) return ESP_ERR_NOT_FOUND;
+
+    *fp = (flash_port_t) {
+        .size = p->size / FLASH_SECTOR_SIZE * FLASH_SECTOR_SIZE,
+        .read = part_read,
+        .write = part_write,
+        .erase_sector = part_erase,
+        .map = part_map,
+        .unmap = part_unmap,
+        .ctx = (void *)p,
+    };
+    return ESP_OK;
+}
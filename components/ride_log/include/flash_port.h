@@ -0,0 +1,38 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Minimalny interfejs pamięci NOR: zapis tylko zeruje bity, kasowanie
+ * całymi sektorami. Na płytce – partycja (flash_port_esp.c), na Linuksie –
+ * plik (host/flash_port_file.c).
+ */
+#define FLASH_SECTOR_SIZE   4096
+#define FLASH_PAGE_SIZE     256
+
+typedef struct flash_port {
+    uint32_t size;              /* wielokrotność FLASH_SECTOR_SIZE */
+    esp_err_t (*read)(struct flash_port *fp, uint32_t off, void *dst, size_t len);
+    esp_err_t (*write)(struct flash_port *fp, uint32_t off, const void *src, size_t len);
+    esp_err_t (*erase_sector)(struct flash_port *fp, uint32_t off);
+    /* Mapowanie całości tylko do odczytu (czytanie bez kopiowania). */
+    esp_err_t (*map)(struct flash_port *fp, const void **out);
+    void      (*unmap)(struct flash_port *fp);
+    void *ctx;
+    const void *mapped;
+    uint32_t    map_handle;
+
+    /* liczniki do pomiaru amplifikacji zapisu i zużycia */
+    uint32_t bytes_written;
+    uint32_t sectors_erased;
+} flash_port_t;
+
+/* Partycja danych o podanej etykiecie (tylko ESP-IDF). */
+esp_err_t flash_port_esp_open(flash_port_t *fp, const char *label);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "ride_reader.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Eksport przejazdu do CSV generowany w locie, kawałkami dowolnej
+ * wielkości. Pamięć stała (iterator + jedna linia), niezależnie od
+ * długości przejazdu – bajty idą prosto do transferu BLE.
+ *
+ * Format:  t_ms,speed_kmh,dist_m
+ *          123400,25.37,1234
+ */
+
+#define RIDE_EXPORT_LINE_MAX  40
+
+typedef struct {
+    ride_iter_t it;
+    uint32_t t_to;
+    uint32_t bytes;             /* wygenerowane do tej pory */
+    char     line[RIDE_EXPORT_LINE_MAX];
+    uint8_t  line_len;
+    uint8_t  line_pos;
+    bool     done;
+} ride_export_t;
+
+/* t_to = 0 – do końca dziennika. */
+void ride_export_begin(ride_export_t *x, const ride_reader_t *r,
+                       uint32_t t_from, uint32_t t_to);
+
+/* Wypełnia buf do cap bajtów; 0 = koniec eksportu. */
+size_t ride_export_read(ride_export_t *x, uint8_t *buf, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "flash_port.h"
+#include "telem_codec.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Rejestrator przejazdu: dziennik tylko do dopisywania na osobnej partycji.
+ *
+ * Próbki, skompresowane telem_codec (koder zerowany na początku każdej
+ * strony), trafiają do bufora jednej strony (256 B) w RAM; pełna strona jest
+ * zapisywana jednym programowaniem z nagłówkiem {magic, len, count, seq,
+ * CRC32}. Sektory są używane po kolei w pierścieniu (najstarszy kasowany
+ * jako następny), więc zużycie rozkłada się równo. Po zaniku zasilania
+ * ginie co najwyżej niezapisana strona z RAM.
+ */
+
+#define RIDE_LOG_MAGIC      0x524C      /* "RL" */
+#define RIDE_LOG_HDR_SIZE   12
+#define RIDE_LOG_PAYLOAD    (FLASH_PAGE_SIZE - RIDE_LOG_HDR_SIZE)
+
+typedef struct {
+    uint16_t magic;
+    uint8_t  len;           /* bajty danych za nagłówkiem */
+    uint8_t  count;         /* liczba próbek na stronie (maks. 255) */
+    uint32_t seq;           /* rośnie z każdą stroną      */
+    uint32_t crc;           /* CRC32 nagłówka (bez crc) + danych */
+} ride_log_page_hdr_t;
+
+typedef struct {
+    uint32_t pages_written;
+    uint32_t samples;
+    uint32_t payload_bytes;     /* bajty próbek przekazane przez aplikację */
+    uint32_t torn_pages;        /* strony odrzucone przy odtwarzaniu */
+} ride_log_stats_t;
+
+typedef struct {
+    flash_port_t *fp;
+    uint32_t write_off;         /* następna strona do zapisu */
+    uint32_t seq;
+    uint32_t last_t_ms;         /* czas ostatniej próbki w dzienniku */
+    uint8_t  page[FLASH_PAGE_SIZE];
+    uint8_t  len;
+    uint8_t  count;
+    telem_enc_t enc;
+    ride_log_stats_t stats;
+} ride_log_t;
+
+/* Odtwarza stan z pamięci (szuka najnowszej poprawnej strony).
+ * Czas próbek powinien rosnąć także między przejazdami – piszący dodaje
+ * last_t_ms z chwili otwarcia, od tego zależy wyszukiwanie w ride_reader. */
+esp_err_t ride_log_open(ride_log_t *log, flash_port_t *fp);
+
+esp_err_t ride_log_append(ride_log_t *log, const ride_sample_t *s);
+
+/* Zapisuje niepełną stronę (np. na koniec przejazdu). */
+esp_err_t ride_log_flush(ride_log_t *log);
+
+/* Sprawdza nagłówek i CRC strony (page = FLASH_PAGE_SIZE bajtów). */
+bool ride_log_page_valid(const uint8_t *page, ride_log_page_hdr_t *hdr);
+
+uint32_t ride_log_crc32(uint32_t crc, const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
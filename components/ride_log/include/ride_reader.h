@@ -0,0 +1,72 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "flash_port.h"
+#include "telem_codec.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Czytnik dziennika przejazdów bez kopiowania: partycja jest mapowana
+ * (esp_partition_mmap na płytce, mmap pliku na Linuksie), a dekoder
+ * czyta strony prosto z mapowania.
+ *
+ * Przy otwarciu budowany jest rzadki indeks czasu – pierwsza próbka
+ * każdego sektora (pierwsza próbka strony jest klatką kluczową, więc
+ * nie trzeba dekodować niczego więcej). Wyszukiwanie to przeszukiwanie
+ * binarne indeksu + co najwyżej jeden sektor stron.
+ */
+
+#define RIDE_READER_INDEX_MAX   512     /* sektory: do 2 MiB partycji */
+
+typedef struct {
+    uint32_t t_ms;
+    uint32_t page;              /* numer logiczny strony (chronologicznie) */
+} ride_index_entry_t;
+
+typedef struct {
+    flash_port_t *fp;
+    const uint8_t *base;
+    uint32_t start_off;         /* fizyczny adres logicznej strony 0 */
+    uint32_t n_pages;
+    ride_index_entry_t index[RIDE_READER_INDEX_MAX];
+    uint32_t n_index;
+} ride_reader_t;
+
+typedef struct {
+    const ride_reader_t *r;
+    uint32_t    page;           /* następna strona logiczna do otwarcia */
+    telem_dec_t dec;
+    bool        in_page;
+    bool        has_ahead;      /* próbka odczytana przez seek, jeszcze nie oddana */
+    ride_sample_t ahead;
+} ride_iter_t;
+
+typedef struct {
+    uint32_t samples;
+    uint32_t t_first_ms;
+    uint32_t t_last_ms;
+    uint32_t moving_ms;         /* czas z prędkością > 0 */
+    uint32_t dist_m;            /* dystans w zakresie (różnica licznika) */
+    uint16_t max_ckmh;
+} ride_summary_t;
+
+esp_err_t ride_reader_open(ride_reader_t *r, flash_port_t *fp);
+void      ride_reader_close(ride_reader_t *r);
+
+void ride_iter_begin(ride_iter_t *it, const ride_reader_t *r);
+
+/* Ustawia iterator tak, by następna próbka miała t_ms >= t (O(log n)). */
+void ride_iter_seek(ride_iter_t *it, uint32_t t_ms);
+
+/* 1 = próbka, 0 = koniec, -1 = uszkodzona strona (pomijana przy kolejnym wywołaniu). */
+int ride_iter_next(ride_iter_t *it, ride_sample_t *s);
+
+/* Podsumowanie próbek z [t_from, t_to) – np. dla ekranu podsumowania. */
+void ride_reader_summary(const ride_reader_t *r, uint32_t t_from, uint32_t t_to,
+                         ride_summary_t *out);
+
+#ifdef __cplusplus
+}
+#endif
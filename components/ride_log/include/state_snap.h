@@ -0,0 +1,56 @@
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+#include "flash_port.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Zwięzła, wersjonowana migawka stanu licznika.
+ *
+ * Kolejne wersje dopisywane są do sektora w rekordach o stałym rozmiarze
+ * (STATE_SNAP_REC_SIZE), każdy z numerem sekwencji i CRC32; kasowanie tylko
+ * wtedy, gdy sektor się zapełni – wtedy zapis przechodzi na drugi sektor,
+ * a pełny zostaje do czasu, aż nowy ma poprawny rekord. Odczyt bierze
+ * poprawny rekord o najwyższym numerze, więc zanik zasilania w trakcie
+ * zapisu zostawia poprzednią wersję.
+ * Nowe pola dopisujemy wyłącznie na końcu i podbijamy STATE_SNAP_VERSION –
+ * starsza, krótsza migawka wczytuje się z domyślnymi wartościami nowych pól.
+ */
+
+#define STATE_SNAP_VERSION   2
+#define STATE_SNAP_REC_SIZE  64     /* nagłówek + dane, 64 rekordy na sektor */
+
+typedef struct {
+    uint32_t odometer_m;
+    uint32_t trip_dist_m;
+    uint32_t trip_time_s;       /* czas jazdy (bez postojów) */
+    uint16_t trip_max_ckmh;     /* 0.01 km/h */
+    uint16_t wheel_mm;          /* obwód koła */
+    uint8_t  ui_page;
+    uint8_t  reserved[3];
+    /* v2: ustawienia z menu */
+    uint8_t  units;             /* 0 = km, 1 = mile */
+    uint8_t  contrast;          /* indeks poziomu jasności ekranu */
+    uint8_t  ble_mode;          /* 0 = z połączeniem, 1 = rozgłaszanie */
+    uint8_t  reserved2;
+} state_snap_t;
+
+typedef struct {
+    flash_port_t *fp;
+    uint32_t seq;               /* numer ostatnio wczytanej/zapisanej wersji */
+    uint8_t  sector;            /* sektor z tą wersją */
+    uint16_t next;              /* pierwszy wolny rekord w tym sektorze */
+} state_store_t;
+
+void state_snap_defaults(state_snap_t *s);
+
+/* ESP_ERR_NOT_FOUND = brak poprawnej migawki, *s ma wartości domyślne. */
+esp_err_t state_snap_load(state_store_t *st, flash_port_t *fp, state_snap_t *s);
+
+/* Dopisuje kolejny rekord; kasuje drugi sektor tylko przy pełnym. */
+esp_err_t state_snap_save(state_store_t *st, const state_snap_t *s);
+
+#ifdef __cplusplus
+}
+#endif
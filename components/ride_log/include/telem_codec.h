@@ -0,0 +1,73 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Strumieniowy kodek próbek telemetrii, stała pamięć po obu stronach.
+ *
+ * Każda próbka to różnice względem poprzedniej: delta-of-delta czasu,
+ * delta prędkości i delta-of-delta dystansu (przy równej jeździe dystans
+ * rośnie o prawie stały krok), zapisane jako varinty zigzag. Ciąg próbek
+ * o zerowych różnicach (postój, jazda ze stałą prędkością) zwija się do
+ * jednego tokenu „powtórz N razy”.
+ *
+ * Token (varint):  bit0 = 1 -> token >> 1 próbek o zerowych różnicach
+ *                  bity 1..0 = 00 -> próbka, token >> 2 = zigzag(ddt),
+ *                             dalej zigzag(dspeed), zigzag(dddist)
+ *                  bity 1..0 = 10 -> próbka zwięzła: ddt = 0,
+ *                             token >> 5 = zigzag(dspeed),
+ *                             bity 4..2 = zigzag(dddist)
+ * Zwięzła próbka to 1 B przy |dspeed| <= 1 i 2 B do |dspeed| <= 255 –
+ * tak wygląda większość jazdy (krok czasu stały, dystans +-1 obrót koła).
+ *
+ * Po telem_enc_reset() pierwsza próbka jest w praktyce klatką kluczową
+ * (różnice od zera), więc każdy blok dekoduje się niezależnie.
+ */
+
+#define TELEM_ENC_MAX_BYTES   25      /* zrzut serii (5) + próbka (10 + 5 + 5) */
+#define TELEM_RUN_MAX_BYTES   5
+
+typedef struct {
+    uint32_t t_ms;          /* czas od startu przejazdu */
+    uint16_t speed_ckmh;    /* 0.01 km/h */
+    uint32_t dist_m;
+} ride_sample_t;
+
+typedef struct {
+    uint32_t t_ms;
+    int32_t  dt;
+    uint16_t speed;
+    uint32_t dist;
+    int32_t  ddist;         /* poprzedni przyrost dystansu */
+    uint32_t run;           /* próbki czekające w serii (tylko koder) */
+} telem_codec_state_t;
+
+typedef struct {
+    telem_codec_state_t st;
+} telem_enc_t;
+
+typedef struct {
+    telem_codec_state_t st;
+    const uint8_t *p;
+    const uint8_t *end;
+} telem_dec_t;
+
+void telem_enc_reset(telem_enc_t *e);
+
+/* Zwraca liczbę bajtów zapisanych do out (0 – próbka dołączona do serii)
+ * albo -1, gdy cap < TELEM_ENC_MAX_BYTES; wtedy stan się nie zmienia. */
+int telem_enc_put(telem_enc_t *e, const ride_sample_t *s, uint8_t *out, size_t cap);
+
+/* Zamyka otwartą serię. Zwraca liczbę bajtów lub -1. */
+int telem_enc_flush(telem_enc_t *e, uint8_t *out, size_t cap);
+
+void telem_dec_init(telem_dec_t *d, const uint8_t *buf, size_t len);
+
+/* 1 = próbka w *s, 0 = koniec danych, -1 = uszkodzony strumień. */
+int telem_dec_next(telem_dec_t *d, ride_sample_t *s);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <string.h>
+#include "ride_export.h"
+
+static const char header[] = "t_ms,speed_kmh,dist_m\n";
+
+void ride_export_begin(ride_export_t *x, const ride_reader_t *r,
+                       uint32_t t_from, uint32_t t_to)
+{
+    memset(x, 0, sizeof(*x));
+    ride_iter_begin(&x->it, r);
+    ride_iter_seek(&x->it, t_from);
+    x->t_to = t_to ? t_to : UINT32_MAX;
+
+    memcpy(x->line, header, sizeof(header) - 1);
+    x->line_len = sizeof(header) - 1;
+}
+
+/* false = brak dalszych próbek */
+static bool next_line(ride_export_t *x)
+{
+    ride_sample_t s;
+    int rc;
+
+    while ((rc = ride_iter_next(&x->it, &s)) != 0) {
+        if (rc < 0) continue;                   /* uszkodzona strona – pomiń */
+        if (s.t_ms >= x->t_to) break;
+
+        int n = snprintf(x->line, sizeof(x->line), "%lu,%u.%02u,%lu\n",
+                         (unsigned long)s.t_ms, s.speed_ckmh / 100, s.speed_ckmh % 100,
+                         (unsigned long)s.dist_m);
+        x->line_len = (uint8_t)n;
+        x->line_pos = 0;
+        return true;
+    }
+    return false;
+}
+
+size_t ride_export_read(ride_export_t *x, uint8_t *buf, size_t cap)
+{
+    size_t out = 0;
+
+    while (out < cap && !x->done) {
+        if (x->line_pos == x->line_len && !next_line(x)) {
+            x->done = true;
+            break;
+        }
+        size_t n = x->line_len - x->line_pos;
+        if (n > cap - out) n = cap - out;
+        memcpy(buf + out, x->line + x->line_pos, n);
+        x->line_pos += n;
+        out += n;
+    }
+    x->bytes += out;
+    return out;
+}
@@ -0,0 +1,198 @@
+#include <string.h>
+#include "esp_log.h"
+#include "ride_log.h"
+
+static const char *TAG = "RIDE_LOG";
+
+/* ---------- CRC32 (IEEE, tablica półbajtowa – 64 B zamiast 1 KiB) ---------- */
+static const uint32_t crc_nibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+uint32_t ride_log_crc32(uint32_t crc, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ crc_nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ crc_nibble[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+/* ---------- nagłówek strony ---------- */
+static void put_le16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static void put_le32(uint8_t *p, uint32_t v) { put_le16(p, v); put_le16(p + 2, v >> 16); }
+static uint16_t get_le16(const uint8_t *p)   { return p[0] | (p[1] << 8); }
+static uint32_t get_le32(const uint8_t *p)   { return get_le16(p) | ((uint32_t)get_le16(p + 2) << 16); }
+
+static uint32_t page_crc(const uint8_t *page, uint8_t len)
+{
+    uint32_t crc = ride_log_crc32(0, page, 8);      /* nagłówek bez pola crc */
+    return ride_log_crc32(crc, page + RIDE_LOG_HDR_SIZE, len);
+}
+
+bool ride_log_page_valid(const uint8_t *page, ride_log_page_hdr_t *hdr)
+{
+    ride_log_page_hdr_t h = {
+        .magic = get_le16(&page[0]),
+        .len   = page[2],
+        .count = page[3],
+        .seq   = get_le32(&page[4]),
+        .crc   = get_le32(&page[8]),
+    };
+    if (h.magic != RIDE_LOG_MAGIC || h.len > RIDE_LOG_PAYLOAD) return false;
+    if (page_crc(page, h.len) != h.crc) return false;
+    if (hdr) *hdr = h;
+    return true;
+}
+
+static bool page_blank(const uint8_t *page)
+{
+    for (int i = 0; i < FLASH_PAGE_SIZE; i++) {
+        if (page[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+static void reset_page(ride_log_t *log)
+{
+    memset(log->page, 0xFF, sizeof(log->page));
+    log->len = 0;
+    log->count = 0;
+    telem_enc_reset(&log->enc);         /* każda strona dekoduje się osobno */
+}
+
+/* ---------- odtwarzanie ---------- */
+esp_err_t ride_log_open(ride_log_t *log, flash_port_t *fp)
+{
+    uint8_t  page[FLASH_PAGE_SIZE];
+    bool     found = false;
+    uint32_t best_off = 0, best_seq = 0;
+
+    memset(log, 0, sizeof(*log));
+    log->fp = fp;
+    reset_page(log);
+
+    if (fp->size < 2 * FLASH_SECTOR_SIZE || fp->size % FLASH_SECTOR_SIZE)
+        return ESP_ERR_INVALID_SIZE;
+
+    for (uint32_t off = 0; off < fp->size; off += FLASH_PAGE_SIZE) {
+        ride_log_page_hdr_t h;
+        esp_err_t err = fp->read(fp, off, page, sizeof(page));
+        if (err != ESP_OK) return err;
+
+        if (ride_log_page_valid(page, &h)) {
+            /* porównanie z przepełnieniem – seq może się przekręcić */
+            if (!found || (int32_t)(h.seq - best_seq) > 0) {
+                best_seq = h.seq;
+                best_off = off;
+                found = true;
+            }
+        } else if (!page_blank(page)) {
+            log->stats.torn_pages++;
+        }
+    }
+
+    if (!found) {
+        ESP_LOGI(TAG, "empty log");
+        return ESP_OK;
+    }
+
+    log->seq = best_seq + 1;
+    log->write_off = (best_off + FLASH_PAGE_SIZE) % fp->size;
+
+    /* czas ostatniej próbki – ciągłość osi czasu po restarcie */
+    ride_log_page_hdr_t h;
+    ride_sample_t s;
+    telem_dec_t dec;
+    esp_err_t err = fp->read(fp, best_off, page, sizeof(page));
+    if (err != ESP_OK) return err;
+    ride_log_page_valid(page, &h);
+    telem_dec_init(&dec, page + RIDE_LOG_HDR_SIZE, h.len);
+    while (telem_dec_next(&dec, &s) == 1) log->last_t_ms = s.t_ms;
+
+    /* Strona za ostatnią poprawną może być przerwanym zapisem – wtedy
+     * zaczynamy od świeżego sektora (kasowany przy pierwszym zapisie). */
+    if (log->write_off % FLASH_SECTOR_SIZE) {
+        err = fp->read(fp, log->write_off, page, sizeof(page));
+        if (err != ESP_OK) return err;
+        if (!page_blank(page)) {
+            log->write_off = (log->write_off / FLASH_SECTOR_SIZE + 1) *
+                             FLASH_SECTOR_SIZE % fp->size;
+        }
+    }
+    ESP_LOGI(TAG, "resume at 0x%lx, seq %lu, %lu torn page(s)",
+             (unsigned long)log->write_off, (unsigned long)log->seq,
+             (unsigned long)log->stats.torn_pages);
+    return ESP_OK;
+}
+
+/* ---------- zapis ---------- */
+static esp_err_t write_page(ride_log_t *log)
+{
+    flash_port_t *fp = log->fp;
+    esp_err_t err;
+
+    if (log->count == 0) return ESP_OK;
+
+    log->len += telem_enc_flush(&log->enc, &log->page[RIDE_LOG_HDR_SIZE + log->len],
+                                RIDE_LOG_PAYLOAD - log->len);
+
+    put_le16(&log->page[0], RIDE_LOG_MAGIC);
+    log->page[2] = log->len;
+    log->page[3] = log->count;
+    put_le32(&log->page[4], log->seq);
+    put_le32(&log->page[8], page_crc(log->page, log->len));
+
+    /* wejście w nowy sektor = skasowanie najstarszych danych w pierścieniu */
+    if (log->write_off % FLASH_SECTOR_SIZE == 0) {
+        err = fp->erase_sector(fp, log->write_off);
+        if (err != ESP_OK) return err;
+        fp->sectors_erased++;
+    }
+    err = fp->write(fp, log->write_off, log->page, FLASH_PAGE_SIZE);
+    if (err != ESP_OK) return err;
+    fp->bytes_written += FLASH_PAGE_SIZE;
+
+    log->write_off = (log->write_off + FLASH_PAGE_SIZE) % fp->size;
+    log->seq++;
+    log->stats.pages_written++;
+    reset_page(log);
+    return ESP_OK;
+}
+
+esp_err_t ride_log_append(ride_log_t *log, const ride_sample_t *s)
+{
+    uint8_t tmp[TELEM_ENC_MAX_BYTES];
+    telem_enc_t enc = log->enc;
+    int n = telem_enc_put(&enc, s, tmp, sizeof(tmp));
+
+    /* zostaw miejsce na zamknięcie serii przy zapisie strony */
+    if (log->count == UINT8_MAX ||
+        log->len + n + TELEM_RUN_MAX_BYTES > RIDE_LOG_PAYLOAD) {
+        esp_err_t err = write_page(log);
+        if (err != ESP_OK) return err;
+        enc = log->enc;
+        n = telem_enc_put(&enc, s, tmp, sizeof(tmp));
+    }
+
+    memcpy(&log->page[RIDE_LOG_HDR_SIZE + log->len], tmp, n);
+    log->enc = enc;
+    log->len += n;
+    log->count++;
+    log->last_t_ms = s->t_ms;
+
+    log->stats.samples++;
+    log->stats.payload_bytes += sizeof(*s);
+    return ESP_OK;
+}
+
+esp_err_t ride_log_flush(ride_log_t *log)
+{
+    return write_page(log);
+}
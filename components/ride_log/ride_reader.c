@@ -0,0 +1,178 @@
+#include <string.h>
+#include "esp_log.h"
+#include "ride_log.h"
+#include "ride_reader.h"
+
+#define PAGES_PER_SECTOR    (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+
+static const char *TAG = "RIDE_RD";
+
+static const uint8_t *page_ptr(const ride_reader_t *r, uint32_t page)
+{
+    return r->base + (r->start_off + page * FLASH_PAGE_SIZE) % r->fp->size;
+}
+
+/* Pierwsza próbka strony = klatka kluczowa; false gdy strona pusta/uszkodzona. */
+static bool first_sample(const ride_reader_t *r, uint32_t page, ride_sample_t *s)
+{
+    ride_log_page_hdr_t h;
+    telem_dec_t dec;
+    const uint8_t *pg = page_ptr(r, page);
+
+    if (!ride_log_page_valid(pg, &h)) return false;
+    telem_dec_init(&dec, pg + RIDE_LOG_HDR_SIZE, h.len);
+    return telem_dec_next(&dec, s) == 1;
+}
+
+esp_err_t ride_reader_open(ride_reader_t *r, flash_port_t *fp)
+{
+    const void *map;
+    bool found = false;
+    uint32_t newest_off = 0, newest_seq = 0;
+
+    memset(r, 0, sizeof(*r));
+    r->fp = fp;
+    if (!fp->map) return ESP_ERR_NOT_SUPPORTED;
+    if (fp->size / FLASH_SECTOR_SIZE > RIDE_READER_INDEX_MAX) return ESP_ERR_INVALID_SIZE;
+
+    esp_err_t err = fp->map(fp, &map);
+    if (err != ESP_OK) return err;
+    r->base = map;
+
+    for (uint32_t off = 0; off < fp->size; off += FLASH_PAGE_SIZE) {
+        ride_log_page_hdr_t h;
+        if (!ride_log_page_valid(r->base + off, &h)) continue;
+        if (!found || (int32_t)(h.seq - newest_seq) > 0) {
+            newest_seq = h.seq;
+            newest_off = off;
+            found = true;
+        }
+    }
+    if (!found) return ESP_OK;
+
+    /* najstarsze dane leżą w sektorze za najnowszym (pierścień) */
+    r->start_off = (newest_off / FLASH_SECTOR_SIZE + 1) * FLASH_SECTOR_SIZE % fp->size;
+    r->n_pages = fp->size / FLASH_PAGE_SIZE;
+
+    for (uint32_t sec = 0; sec < r->n_pages; sec += PAGES_PER_SECTOR) {
+        ride_sample_t s;
+        for (uint32_t p = sec; p < sec + PAGES_PER_SECTOR; p++) {
+            if (first_sample(r, p, &s)) {
+                r->index[r->n_index].t_ms = s.t_ms;
+                r->index[r->n_index].page = p;
+                r->n_index++;
+                break;
+            }
+        }
+    }
+    ESP_LOGI(TAG, "mapped %lu KiB, %lu index entries",
+             (unsigned long)(fp->size / 1024), (unsigned long)r->n_index);
+    return ESP_OK;
+}
+
+void ride_reader_close(ride_reader_t *r)
+{
+    if (r->fp && r->fp->unmap) r->fp->unmap(r->fp);
+    r->base = NULL;
+    r->n_pages = 0;
+    r->n_index = 0;
+}
+
+/* ---------- iterator ---------- */
+void ride_iter_begin(ride_iter_t *it, const ride_reader_t *r)
+{
+    memset(it, 0, sizeof(*it));
+    it->r = r;
+}
+
+int ride_iter_next(ride_iter_t *it, ride_sample_t *s)
+{
+    const ride_reader_t *r = it->r;
+
+    if (it->has_ahead) {
+        *s = it->ahead;
+        it->has_ahead = false;
+        return 1;
+    }
+    for (;;) {
+        if (it->in_page) {
+            int rc = telem_dec_next(&it->dec, s);
+            if (rc == 1) return 1;
+            it->in_page = false;
+            if (rc < 0) return -1;
+        }
+        if (it->page >= r->n_pages) return 0;
+
+        ride_log_page_hdr_t h;
+        const uint8_t *pg = page_ptr(r, it->page++);
+        if (!ride_log_page_valid(pg, &h)) continue;     /* pusta lub przerwana */
+
+        telem_dec_init(&it->dec, pg + RIDE_LOG_HDR_SIZE, h.len);
+        it->in_page = true;
+    }
+}
+
+void ride_iter_seek(ride_iter_t *it, uint32_t t_ms)
+{
+    const ride_reader_t *r = it->r;
+    ride_sample_t s;
+    uint32_t lo = 0, hi = r->n_index;
+
+    ride_iter_begin(it, r);
+    if (r->n_index == 0) return;
+
+    /* ostatni sektor, który zaczyna się nie później niż t */
+    while (hi - lo > 1) {
+        uint32_t mid = (lo + hi) / 2;
+        if (r->index[mid].t_ms <= t_ms) lo = mid;
+        else                            hi = mid;
+    }
+    it->page = r->index[lo].page;
+
+    /* w obrębie sektora: przeskakuj strony, dopóki następna zaczyna się <= t */
+    uint32_t end = (it->page / PAGES_PER_SECTOR + 1) * PAGES_PER_SECTOR;
+    for (uint32_t p = it->page + 1; p < end && p < r->n_pages; p++) {
+        if (!first_sample(r, p, &s)) continue;
+        if (s.t_ms > t_ms) break;
+        it->page = p;
+    }
+
+    int rc;
+    while ((rc = ride_iter_next(it, &s)) != 0) {
+        if (rc < 0) continue;
+        if (s.t_ms >= t_ms) {
+            it->ahead = s;
+            it->has_ahead = true;
+            return;
+        }
+    }
+}
+
+void ride_reader_summary(const ride_reader_t *r, uint32_t t_from, uint32_t t_to,
+                         ride_summary_t *out)
+{
+    ride_iter_t it;
+    ride_sample_t s, first = { 0 }, prev = { 0 };
+    int rc;
+
+    memset(out, 0, sizeof(*out));
+    ride_iter_begin(&it, r);
+    ride_iter_seek(&it, t_from);
+
+    while ((rc = ride_iter_next(&it, &s)) != 0) {
+        if (rc < 0) continue;
+        if (s.t_ms >= t_to) break;
+
+        if (out->samples == 0) {
+            first = s;
+            out->t_first_ms = s.t_ms;
+        } else if (prev.speed_ckmh > 0) {
+            out->moving_ms += s.t_ms - prev.t_ms;
+        }
+        if (s.speed_ckmh > out->max_ckmh) out->max_ckmh = s.speed_ckmh;
+        out->dist_m = s.dist_m - first.dist_m;
+        out->t_last_ms = s.t_ms;
+        out->samples++;
+        prev = s;
+    }
+}
@@ -0,0 +1,120 @@
+#include <string.h>
+#include "ride_log.h"
+#include "state_snap.h"
+
+#define SNAP_MAGIC      0x5353      /* "SS" */
+#define SNAP_HDR_SIZE   12          /* magic(2) ver(1) len(1) seq(4) crc(4) */
+#define SNAP_RECS       (FLASH_SECTOR_SIZE / STATE_SNAP_REC_SIZE)
+
+_Static_assert(SNAP_HDR_SIZE + sizeof(state_snap_t) <= STATE_SNAP_REC_SIZE,
+               "state_snap_t outgrew STATE_SNAP_REC_SIZE");
+
+static void put_le16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static void put_le32(uint8_t *p, uint32_t v) { put_le16(p, v); put_le16(p + 2, v >> 16); }
+static uint16_t get_le16(const uint8_t *p)   { return p[0] | (p[1] << 8); }
+static uint32_t get_le32(const uint8_t *p)   { return get_le16(p) | ((uint32_t)get_le16(p + 2) << 16); }
+
+void state_snap_defaults(state_snap_t *s)
+{
+    memset(s, 0, sizeof(*s));
+    s->wheel_mm = 2105;                 /* 700x25C */
+    s->contrast = 2;
+}
+
+static uint32_t snap_crc(const uint8_t *buf, uint8_t len)
+{
+    uint32_t crc = ride_log_crc32(0, buf, 8);       /* nagłówek bez pola crc */
+    return ride_log_crc32(crc, buf + SNAP_HDR_SIZE, len);
+}
+
+static bool erased(const uint8_t *p, size_t n)
+{
+    while (n--) if (*p++ != 0xFF) return false;
+    return true;
+}
+
+/* 0 = rekord uszkodzony (np. przerwany zapis), inaczej długość danych */
+static uint8_t parse_rec(const uint8_t *rec, uint32_t *seq)
+{
+    uint8_t len = rec[3];
+    if (get_le16(&rec[0]) != SNAP_MAGIC || rec[2] == 0 || len == 0 ||
+        SNAP_HDR_SIZE + len > STATE_SNAP_REC_SIZE)
+        return 0;
+    if (snap_crc(rec, len) != get_le32(&rec[8])) return 0;
+    *seq = get_le32(&rec[4]);
+    return len;
+}
+
+esp_err_t state_snap_load(state_store_t *st, flash_port_t *fp, state_snap_t *s)
+{
+    uint8_t  rec[STATE_SNAP_REC_SIZE];
+    uint16_t free_at[2];
+    bool     found = false;
+
+    st->fp = fp;
+    st->seq = 0;
+    st->sector = 1;
+    st->next = SNAP_RECS;               /* nic poprawnego: pierwszy zapis skasuje sektor 0 */
+    state_snap_defaults(s);
+
+    for (uint8_t sec = 0; sec < 2; sec++) {
+        free_at[sec] = SNAP_RECS;
+        for (uint16_t i = 0; i < SNAP_RECS; i++) {
+            uint32_t off = sec * FLASH_SECTOR_SIZE + i * STATE_SNAP_REC_SIZE;
+            if (fp->read(fp, off, rec, sizeof(rec)) != ESP_OK) return ESP_FAIL;
+            /* rekordy idą po kolei – pierwszy skasowany kończy sektor */
+            if (erased(rec, sizeof(rec))) {
+                free_at[sec] = i;
+                break;
+            }
+            uint32_t seq;
+            uint8_t len = parse_rec(rec, &seq);
+            if (!len || (found && (int32_t)(seq - st->seq) <= 0)) continue;
+
+            /* nowsza wersja niż nasza – bierzemy znane pola, resztę ignorujemy */
+            state_snap_defaults(s);
+            memcpy(s, rec + SNAP_HDR_SIZE, len < sizeof(*s) ? len : sizeof(*s));
+            st->seq = seq;
+            st->sector = sec;
+            found = true;
+        }
+    }
+    if (!found) return ESP_ERR_NOT_FOUND;
+    st->next = free_at[st->sector];
+    return ESP_OK;
+}
+
+esp_err_t state_snap_save(state_store_t *st, const state_snap_t *s)
+{
+    flash_port_t *fp = st->fp;
+    uint8_t  buf[SNAP_HDR_SIZE + sizeof(*s)];
+    uint8_t  sector = st->sector;
+    uint16_t next = st->next;
+    esp_err_t err;
+
+    put_le16(&buf[0], SNAP_MAGIC);
+    buf[2] = STATE_SNAP_VERSION;
+    buf[3] = sizeof(*s);
+    put_le32(&buf[4], st->seq + 1);
+    memcpy(&buf[SNAP_HDR_SIZE], s, sizeof(*s));
+    put_le32(&buf[8], snap_crc(buf, sizeof(*s)));
+
+    if (next >= SNAP_RECS) {
+        /* pełny sektor zostaje z ostatnią wersją, dopóki nowy nie ma swojej */
+        sector = !sector;
+        next = 0;
+        err = fp->erase_sector(fp, sector * FLASH_SECTOR_SIZE);
+        if (err != ESP_OK) return err;
+        fp->sectors_erased++;
+    }
+    uint32_t off = sector * FLASH_SECTOR_SIZE + next * STATE_SNAP_REC_SIZE;
+    err = fp->write(fp, off, buf, sizeof(buf));
+    /* przerwany rekord zajmuje miejsce – następny zapis idzie za nim */
+    st->sector = sector;
+    st->next = next + 1;
+    if (err != ESP_OK) return err;
+    fp->bytes_written += sizeof(buf);
+
+    st->seq++;
+    return ESP_OK;
+}
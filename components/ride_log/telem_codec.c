@@ -0,0 +1,145 @@
+#include <string.h>
+#include "telem_codec.h"
+
+/* ---------- varint / zigzag ---------- */
+static uint32_t zigzag(int32_t v)    { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static int32_t  unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+/* Arytmetyka delt modulo 2^32: przepełnienie int32 to UB, a skok czasu
+ * o więcej niż 2^31 ms daje ddt poza zakresem. Koder i dekoder zawijają
+ * tak samo, więc wynik jest bajt w bajt odtwarzalny. */
+static int32_t wrap_sub(int32_t a, int32_t b) { return (int32_t)((uint32_t)a - (uint32_t)b); }
+static int32_t wrap_add(int32_t a, int32_t b) { return (int32_t)((uint32_t)a + (uint32_t)b); }
+
+static int put_varint(uint8_t *p, uint64_t v)
+{
+    int n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static int get_varint(telem_dec_t *d, uint64_t *v)
+{
+    uint64_t r = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (d->p == d->end) return -1;
+        uint8_t b = *d->p++;
+        r |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = r;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* ---------- koder ---------- */
+void telem_enc_reset(telem_enc_t *e)
+{
+    memset(e, 0, sizeof(*e));
+}
+
+static int put_run(telem_enc_t *e, uint8_t *out)
+{
+    if (e->st.run == 0) return 0;
+    int n = put_varint(out, (e->st.run << 1) | 1);
+    e->st.run = 0;
+    return n;
+}
+
+int telem_enc_put(telem_enc_t *e, const ride_sample_t *s, uint8_t *out, size_t cap)
+{
+    if (cap < TELEM_ENC_MAX_BYTES) return -1;
+
+    int32_t dt     = (int32_t)(s->t_ms - e->st.t_ms);
+    int32_t ddt    = wrap_sub(dt, e->st.dt);
+    int32_t dspeed = (int32_t)s->speed_ckmh - e->st.speed;
+    int32_t ddist  = (int32_t)(s->dist_m - e->st.dist);
+    int32_t dddist = wrap_sub(ddist, e->st.ddist);
+
+    e->st.t_ms  = s->t_ms;
+    e->st.dt    = dt;
+    e->st.speed = s->speed_ckmh;
+    e->st.dist  = s->dist_m;
+    e->st.ddist = ddist;
+
+    /* licznik serii jest ograniczony tak, by token zmieścił się w 5 B */
+    if (ddt == 0 && dspeed == 0 && dddist == 0 && e->st.run < 0x7FFFFFFF) {
+        e->st.run++;
+        return 0;
+    }
+
+    int n = put_run(e, out);
+    uint32_t zs = zigzag(dspeed), zd = zigzag(dddist);
+    if (ddt == 0 && zd < 8) {
+        n += put_varint(out + n, (uint64_t)zs << 5 | zd << 2 | 2);
+        return n;
+    }
+    n += put_varint(out + n, (uint64_t)zigzag(ddt) << 2);  /* do 34 bitów */
+    n += put_varint(out + n, zs);
+    n += put_varint(out + n, zd);
+    return n;
+}
+
+int telem_enc_flush(telem_enc_t *e, uint8_t *out, size_t cap)
+{
+    if (cap < TELEM_RUN_MAX_BYTES) return -1;
+    return put_run(e, out);
+}
+
+/* ---------- dekoder ---------- */
+void telem_dec_init(telem_dec_t *d, const uint8_t *buf, size_t len)
+{
+    memset(&d->st, 0, sizeof(d->st));
+    d->p = buf;
+    d->end = buf + len;
+}
+
+static void apply(telem_dec_t *d, int32_t ddt, int32_t dspeed, int32_t dddist,
+                  ride_sample_t *s)
+{
+    d->st.dt     = wrap_add(d->st.dt, ddt);
+    d->st.t_ms  += (uint32_t)d->st.dt;
+    d->st.speed  = (uint16_t)(d->st.speed + dspeed);
+    d->st.ddist  = wrap_add(d->st.ddist, dddist);
+    d->st.dist  += (uint32_t)d->st.ddist;
+
+    s->t_ms       = d->st.t_ms;
+    s->speed_ckmh = d->st.speed;
+    s->dist_m     = d->st.dist;
+}
+
+int telem_dec_next(telem_dec_t *d, ride_sample_t *s)
+{
+    uint64_t tok, sp, di;
+
+    if (d->st.run) {
+        d->st.run--;
+        apply(d, 0, 0, 0, s);
+        return 1;
+    }
+    if (d->p == d->end) return 0;
+    if (get_varint(d, &tok) != 0) return -1;
+
+    if (tok & 1) {
+        if ((tok >> 1) == 0 || (tok >> 1) > 0x7FFFFFFF) return -1;
+        d->st.run = (uint32_t)(tok >> 1);
+        d->st.run--;
+        apply(d, 0, 0, 0, s);
+        return 1;
+    }
+    if (tok & 2) {
+        if ((tok >> 5) > UINT32_MAX) return -1;
+        apply(d, 0, unzigzag((uint32_t)(tok >> 5)), unzigzag((tok >> 2) & 7), s);
+        return 1;
+    }
+    if (get_varint(d, &sp) != 0 || get_varint(d, &di) != 0) return -1;
+    if ((tok >> 2) > UINT32_MAX || sp > UINT32_MAX || di > UINT32_MAX) return -1;
+    apply(d, unzigzag((uint32_t)(tok >> 2)), unzigzag((uint32_t)sp),
+          unzigzag((uint32_t)di), s);
+    return 1;
+}
@@ -1,6 +1,13 @@
 #ifndef MAIN_SH1106_H_
 #define MAIN_SH1106_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+#include "sh1106_fb.h"
+
 // Following definitions are bollowed from 
 // https://www.elecrow.com/download/SH1106%20datasheet.pdf
 
@@ -76,4 +83,54 @@
 #define OLED_CMD_SET_CHARGE_PUMP_OFF 0x0A
 
 
+// *********************
+// *                   *
+// *    Driver API     *
+// *                   *
+// *********************
+
+// Brings up the bus picked in menuconfig (I2C or SPI).
+void sh1106_bus_init(void);
+#ifdef CONFIG_SH1106_BUS_I2C
+void i2c_master_init(void);     // same as sh1106_bus_init(), kept for old callers
+#endif
+void sh1106_init(void);
+void sh1106_clear_screen(void);
+void sh1106_set_contrast(uint8_t contrast);
+// OLED_CMD_DISPLAY_ON / _OFF; contents stay in display RAM while off.
+void sh1106_set_power(bool on);
+
+// Draws up to 16 characters of 8x8 text on the given page (0-7).
+void sh1106_display_text(const char *text, uint8_t page);
+
+// Sends the dirty pages of the framebuffer and marks them clean.
+void sh1106_flush(sh1106_fb_t *fb);
+
+// Split flush: on SPI the pages go out by DMA after _start returns and
+// the CPU is free until _wait. Don't touch the framebuffer in between.
+// Pages that failed to send stay dirty; after a bus recovery the panel
+// is configured again and every page is marked dirty.
+void sh1106_flush_start(sh1106_fb_t *fb);
+void sh1106_flush_wait(void);
+
+// Bus health since boot. Every transfer is checked; a failed one gets a
+// bus recovery (I2C: clock pulses + STOP + driver reinstall) and one retry.
+typedef struct {
+	uint32_t xfers;
+	uint32_t nack;          // panel did not acknowledge
+	uint32_t timeout;       // bus busy or held low past the timeout
+	uint32_t other;         // driver state/argument errors, SPI errors
+	uint32_t recoveries;
+	uint32_t backoffs;      // clock steps down after repeated faults
+	uint32_t clk_hz;        // current bus clock
+	uint32_t lat_avg_us;    // per transfer, blocking part
+	uint32_t lat_max_us;
+} sh1106_bus_stats_t;
+
+void sh1106_bus_stats(sh1106_bus_stats_t *out);
+
+void task_sh1106_display_pattern(void *ignore);
+void task_sh1106_display_clear(void *ignore);
+void task_sh1106_display_text(const void *arg_text);
+
 #endif /* MAIN_SH1106_H_ */
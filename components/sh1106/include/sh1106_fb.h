@@ -0,0 +1,45 @@
+#ifndef MAIN_SH1106_FB_H_
+#define MAIN_SH1106_FB_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Local copy of the controller RAM. One byte is a vertical strip of 8
+// pixels (LSB on top), exactly as the SH1106 takes it over the wire, so
+// a page can be pushed without any conversion.
+#define SH1106_WIDTH    132
+#define SH1106_HEIGHT   64
+#define SH1106_PAGES    (SH1106_HEIGHT / 8)
+
+typedef struct {
+	union {
+		uint8_t  page[SH1106_PAGES][SH1106_WIDTH];
+		uint32_t word[SH1106_PAGES][SH1106_WIDTH / 4];  // for word-wide blits
+	};
+	uint8_t dirty;      // bit n = page n changed since last flush
+} sh1106_fb_t;
+
+void sh1106_fb_clear(sh1106_fb_t *fb);
+
+// Clears pages [first, first + count) only.
+void sh1106_fb_clear_pages(sh1106_fb_t *fb, uint8_t first, uint8_t count);
+
+// Vertical run of pixels y0..y1 (inclusive, any order) in column x.
+// Works a page at a time with a single mask per byte.
+void sh1106_fb_vline(sh1106_fb_t *fb, uint8_t x, uint8_t y0, uint8_t y1, bool on);
+
+// Copies w bytes into page row at column x, XOR-ed with xor_mask (0xFF
+// gives inverse video). The aligned middle goes 4 bytes at a time.
+void sh1106_fb_blit(sh1106_fb_t *fb, uint8_t x, uint8_t page,
+		const uint8_t *src, uint8_t w, uint8_t xor_mask);
+
+// Sets w bytes of a page row to the same pattern, word-wide in the middle.
+void sh1106_fb_fill(sh1106_fb_t *fb, uint8_t x, uint8_t page, uint8_t w, uint8_t pattern);
+
+// Column bytes of the 8x8 glyph for an ASCII character.
+const uint8_t *sh1106_font8x8(char c);
+
+// 8x8 text on a page boundary. Returns the column after the last glyph.
+uint8_t sh1106_fb_text(sh1106_fb_t *fb, uint8_t x, uint8_t page, const char *text);
+
+#endif /* MAIN_SH1106_FB_H_ */
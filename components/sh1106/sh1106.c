@@ -1,150 +1,90 @@
 #include <string.h>
 
-#include "driver/gpio.h"
-#include "driver/i2c.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 #include "sdkconfig.h" // generated by "make menuconfig"
 
 #include "sh1106.h"
-#include "font8x8_basic.h"
+#include "sh1106_bus.h"
+#include "sh1106_fb.h"
+#include "trace.h"
 
-#define SDA_PIN GPIO_NUM_5
-#define SCL_PIN GPIO_NUM_4
+// defined in sh1106_fb.c, the header has no include guard or static
+extern uint8_t font8x8_basic_tr[128][8];
 
 #define tag "SH1106"
 
-void i2c_master_init()
-{
-	i2c_config_t i2c_config = {
-		.mode = I2C_MODE_MASTER,
-		.sda_io_num = SDA_PIN,
-		.scl_io_num = SCL_PIN,
-		.sda_pullup_en = GPIO_PULLUP_ENABLE,
-		.scl_pullup_en = GPIO_PULLUP_ENABLE,
-		.master.clk_speed = 1000000
-	};
-	i2c_param_config(I2C_NUM_0, &i2c_config);
-	i2c_driver_install(I2C_NUM_0, I2C_MODE_MASTER, 0, 0, 0);
+// replayed after a bus recovery, the panel may have reset with it
+static uint8_t contrast_now = 0x80;    // SH1106 reset value
+static bool power_now = true;
+
+// Column/page addressing, same bytes on both buses.
+static void set_address(uint8_t page, uint8_t col) {
+	uint8_t cmd[3] = { col & 0x0F, 0x10 | (col >> 4), 0xB0 | (page & 0x07) };
+	sh1106_bus_cmd(cmd, sizeof(cmd));
 }
 
-void sh1106_set_display_start_line(i2c_cmd_handle_t cmd, uint_fast8_t start_line) {
+void sh1106_set_display_start_line(uint_fast8_t start_line) {
     // REQUIRES:
     //   0 <= start_line <= 63
-    if (start_line >= 0 && start_line <= 63) {
-        i2c_master_write_byte(cmd, OLED_CMD_SET_DISPLAY_START_LINE | start_line, true);
+    if (start_line <= 63) {
+        uint8_t cmd = OLED_CMD_SET_DISPLAY_START_LINE | start_line;
+        sh1106_bus_cmd(&cmd, 1);
     }
 }
 
 void sh1106_init() {
 	esp_err_t espRc;
 
-	i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-
-	i2c_master_start(cmd);
-	i2c_master_write_byte(cmd, (OLED_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-	i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_STREAM, true);
-
-	i2c_master_write_byte(cmd, OLED_CMD_SET_CHARGE_PUMP_CTRL, true);
-	i2c_master_write_byte(cmd, OLED_CMD_SET_CHARGE_PUMP_ON, true);
-
-	i2c_master_write_byte(cmd, OLED_CMD_SET_SEGMENT_REMAP_INVERSE, true); // reverse left-right mapping
-	i2c_master_write_byte(cmd, OLED_CMD_SET_COM_SCAN_MODE_REVERSE, true); // reverse up-bottom mapping
+	static const uint8_t init_seq[] = {
+		OLED_CMD_SET_CHARGE_PUMP_CTRL,
+		OLED_CMD_SET_CHARGE_PUMP_ON,
 
-	i2c_master_write_byte(cmd, OLED_CMD_DISPLAY_ON, true);
+		OLED_CMD_SET_SEGMENT_REMAP_INVERSE, // reverse left-right mapping
+		OLED_CMD_SET_COM_SCAN_MODE_REVERSE, // reverse up-bottom mapping
 
-	i2c_master_write_byte(cmd, 0x00, true); // reset column low bits
-	i2c_master_write_byte(cmd, 0x10, true); // reset column high bits
-	i2c_master_write_byte(cmd, 0xB0, true); // reset page
-    i2c_master_write_byte(cmd, 0x40, true); // set start line
-    i2c_master_write_byte(cmd, OLED_CMD_SET_DISPLAY_OFFSET, true);
-    i2c_master_write_byte(cmd, 0x00, true);
+		OLED_CMD_DISPLAY_ON,
 
-	i2c_master_stop(cmd);
+		0x00, // reset column low bits
+		0x10, // reset column high bits
+		0xB0, // reset page
+		0x40, // set start line
+		OLED_CMD_SET_DISPLAY_OFFSET,
+		0x00,
+	};
 
-	espRc = i2c_master_cmd_begin(I2C_NUM_0, cmd, 10/portTICK_PERIOD_MS);
+	espRc = sh1106_bus_cmd(init_seq, sizeof(init_seq));
 	if (espRc == ESP_OK) {
-		ESP_LOGI(tag, "OLED configured successfully");
+		TRACE("SH1106 configured");
 	} else {
 		ESP_LOGE(tag, "OLED configuration failed. code: 0x%.2X", espRc);
 	}
-	i2c_cmd_link_delete(cmd);
 }
 
 void task_sh1106_display_pattern(void *ignore) {
-	i2c_cmd_handle_t cmd;
+	uint8_t pattern[SH1106_WIDTH];
 
+	for (uint8_t j = 0; j < SH1106_WIDTH; j++) {
+		pattern[j] = 0xFF >> (j % 8);
+	}
 	for (uint8_t i = 0; i < 8; i++) {
-		cmd = i2c_cmd_link_create();
-		i2c_master_start(cmd);
-		i2c_master_write_byte(cmd, (OLED_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-		i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_SINGLE, true);
-		i2c_master_write_byte(cmd, 0xB0 | i, true);
-		i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_DATA_STREAM, true);
-		for (uint8_t j = 0; j < 132; j++) {
-			i2c_master_write_byte(cmd, 0xFF >> (j % 8), true);
-		}
-		i2c_master_stop(cmd);
-		i2c_master_cmd_begin(I2C_NUM_0, cmd, 10/portTICK_PERIOD_MS);
-		i2c_cmd_link_delete(cmd);
+		sh1106_bus_page(i, 0, pattern, SH1106_WIDTH);
 	}
+	sh1106_bus_wait();
 }
 
 void task_sh1106_display_clear(void *ignore) {
-	i2c_cmd_handle_t cmd;
+	static const uint8_t zero[SH1106_WIDTH];
 
-	uint8_t zero[132];
-    memset(zero, 0, 132);
 	for (uint8_t i = 0; i < 8; i++) {
-		cmd = i2c_cmd_link_create();
-		i2c_master_start(cmd);
-		i2c_master_write_byte(cmd, (OLED_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-		i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_SINGLE, true);
-		i2c_master_write_byte(cmd, 0xB0 | i, true);
-
-		i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_DATA_STREAM, true);
-		i2c_master_write(cmd, zero, 132, true);
-		i2c_master_stop(cmd);
-		i2c_master_cmd_begin(I2C_NUM_0, cmd, 10/portTICK_PERIOD_MS);
-		i2c_cmd_link_delete(cmd);
+		sh1106_bus_page(i, 0, zero, SH1106_WIDTH);
 	}
+	sh1106_bus_wait();
 
-    cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_STREAM, true);
-    i2c_master_write_byte(cmd, 0x00, true); // reset column
-    i2c_master_write_byte(cmd, 0x10, true);
-    i2c_master_write_byte(cmd, 0xB0, true); // reset page
-    i2c_master_stop(cmd);
-    i2c_master_cmd_begin(I2C_NUM_0, cmd, 10/portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
-}
-
-
-void task_sh1106_contrast(void *ignore) {
-	i2c_cmd_handle_t cmd;
-
-	uint8_t contrast = 0;
-	uint8_t direction = 1;
-	while (true) {
-		cmd = i2c_cmd_link_create();
-		i2c_master_start(cmd);
-		i2c_master_write_byte(cmd, (OLED_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-		i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_STREAM, true);
-		i2c_master_write_byte(cmd, OLED_CMD_SET_CONTRAST, true);
-		i2c_master_write_byte(cmd, contrast, true);
-		i2c_master_stop(cmd);
-		i2c_master_cmd_begin(I2C_NUM_0, cmd, 10/portTICK_PERIOD_MS);
-		i2c_cmd_link_delete(cmd);
-		vTaskDelay(1/portTICK_PERIOD_MS);
-
-		contrast += direction;
-		if (contrast == 0xFF) { direction = -1; }
-		if (contrast == 0x0) { direction = 1; }
-	}
-	vTaskDelete(NULL);
+	set_address(0, 0);
 }
 
 
@@ -152,61 +92,80 @@ void task_sh1106_display_text(const void *arg_text) {
 	char *text = (char*)arg_text;
 	uint8_t text_len = strlen(text);
 
-	i2c_cmd_handle_t cmd;
-
 	uint8_t cur_page = 0;
 
-	cmd = i2c_cmd_link_create();
-	i2c_master_start(cmd);
-	i2c_master_write_byte(cmd, (OLED_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-
-	i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_STREAM, true);
-	i2c_master_write_byte(cmd, 0x08, true); // reset column
-	i2c_master_write_byte(cmd, 0x10, true);
-	i2c_master_write_byte(cmd, 0xB0 | cur_page, true); // reset page
-
-	i2c_master_stop(cmd);
-	i2c_master_cmd_begin(I2C_NUM_0, cmd, 10/portTICK_PERIOD_MS);
-	i2c_cmd_link_delete(cmd);
+	set_address(cur_page, 8);
 
 	for (uint8_t i = 0; i < text_len; i++) {
 		if (text[i] == '\n') {
-			cmd = i2c_cmd_link_create();
-			i2c_master_start(cmd);
-			i2c_master_write_byte(cmd, (OLED_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-
-			i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_STREAM, true);
-			i2c_master_write_byte(cmd, 0x08, true); // reset column
-			i2c_master_write_byte(cmd, 0x10, true);
-			i2c_master_write_byte(cmd, 0xB0 | ++cur_page, true); // increment page
-
-			i2c_master_stop(cmd);
-			i2c_master_cmd_begin(I2C_NUM_0, cmd, 10/portTICK_PERIOD_MS);
-			i2c_cmd_link_delete(cmd);
+			set_address(++cur_page, 8); // increment page
 		} else {
-			cmd = i2c_cmd_link_create();
-			i2c_master_start(cmd);
-			i2c_master_write_byte(cmd, (OLED_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-
-			i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_DATA_STREAM, true);
-			i2c_master_write(cmd, font8x8_basic_tr[(uint8_t)text[i]], 8, true);
-
-			i2c_master_stop(cmd);
-			i2c_master_cmd_begin(I2C_NUM_0, cmd, 10/portTICK_PERIOD_MS);
-			i2c_cmd_link_delete(cmd);
+			sh1106_bus_data(font8x8_basic_tr[(uint8_t)text[i]], 8);
 		}
 	}
 }
 
 
-void app_main(void)
-{
-	i2c_master_init();
+void sh1106_set_contrast(uint8_t contrast) {
+	uint8_t cmd[2] = { OLED_CMD_SET_CONTRAST, contrast };
+	contrast_now = contrast;
+	sh1106_bus_cmd(cmd, sizeof(cmd));
+}
+
+void sh1106_set_power(bool on) {
+	// panel off keeps display RAM, so no redraw is needed after power on
+	uint8_t cmd = on ? OLED_CMD_DISPLAY_ON : OLED_CMD_DISPLAY_OFF;
+	power_now = on;
+	sh1106_bus_cmd(&cmd, 1);
+}
+
+// After a bus recovery: configuration, contrast and power state again,
+// and the whole frame on the next flush.
+static void reinit_after_reset(sh1106_fb_t *fb) {
+	if (!sh1106_bus_take_reset()) return;
 	sh1106_init();
+	sh1106_set_contrast(contrast_now);
+	if (!power_now) sh1106_set_power(false);
+	fb->dirty = 0xFF;
+	TRACE("SH1106 re-initialised after bus fault");
+}
 
-	task_sh1106_display_pattern(NULL);
-	vTaskDelay(1000/portTICK_PERIOD_MS);
+void sh1106_clear_screen(void) {
 	task_sh1106_display_clear(NULL);
-    task_sh1106_display_text("Hello!\nMultiline OK!\nAnother line.");
-	xTaskCreate(&task_sh1106_contrast, "ssid1306_contrast", 2048, NULL, 6, NULL);
+}
+
+void sh1106_display_text(const char *text, uint8_t page) {
+	uint8_t text_len = strlen(text);
+	uint8_t line[16 * 8];
+
+	if (text_len > 16) text_len = 16; // 16 x 8 px fits in one page
+
+	// whole line in one transfer instead of one per glyph
+	for (uint8_t i = 0; i < text_len; i++) {
+		memcpy(&line[i * 8], font8x8_basic_tr[(uint8_t)text[i] & 0x7F], 8);
+	}
+	sh1106_bus_page(page & 0x07, 2, line, text_len * 8); // column 2: visible area of 132 px RAM
+	sh1106_bus_wait();
+}
+
+void sh1106_flush_start(sh1106_fb_t *fb) {
+	reinit_after_reset(fb);
+	for (uint8_t p = 0; p < SH1106_PAGES; p++) {
+		if (!(fb->dirty & (1u << p))) continue;
+		// failed even after recovery: leave the rest dirty for the next frame
+		// instead of hammering a dead bus
+		if (sh1106_bus_page(p, 0, fb->page[p], SH1106_WIDTH) != ESP_OK) break;
+		fb->dirty &= ~(1u << p);
+	}
+	// a fault halfway may have wiped what was already sent
+	reinit_after_reset(fb);
+}
+
+void sh1106_flush_wait(void) {
+	sh1106_bus_wait();
+}
+
+void sh1106_flush(sh1106_fb_t *fb) {
+	sh1106_flush_start(fb);
+	sh1106_flush_wait();
 }
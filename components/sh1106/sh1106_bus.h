@@ -0,0 +1,35 @@
+#ifndef MAIN_SH1106_BUS_H_
+#define MAIN_SH1106_BUS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// Transport under the SH1106 driver, one implementation per bus
+// (sh1106_i2c.c or sh1106_spi.c, picked by Kconfig).
+
+// ESP32: GPIO6-11 drive the SPI flash, GPIO34-39 are input-only.
+// For #if checks on the Kconfig pin numbers.
+#define SH1106_BAD_OUT_PIN(p) (((p) >= 6 && (p) <= 11) || (p) >= 34)
+
+// Command bytes (D/C low on SPI, control byte 0x00 on I2C).
+esp_err_t sh1106_bus_cmd(const uint8_t *cmd, size_t len);
+
+// Display RAM bytes at the current address.
+esp_err_t sh1106_bus_data(const uint8_t *data, size_t len);
+
+// Sets page/column and writes data. May return before the transfer is
+// done (SPI queues it for DMA); data must stay untouched until
+// sh1106_bus_wait().
+esp_err_t sh1106_bus_page(uint8_t page, uint8_t col, const uint8_t *data, size_t len);
+
+// Waits for every queued sh1106_bus_page() transfer.
+esp_err_t sh1106_bus_wait(void);
+
+// True once after the transport recovered from a bus fault. The panel may
+// have lost power with it, so configuration and display RAM are suspect.
+bool sh1106_bus_take_reset(void);
+
+#endif /* MAIN_SH1106_BUS_H_ */
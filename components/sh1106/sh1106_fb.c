@@ -0,0 +1,85 @@
+#include <string.h>
+
+#include "sh1106_fb.h"
+#include "font8x8_basic.h"
+
+void sh1106_fb_clear(sh1106_fb_t *fb) {
+	memset(fb->page, 0, sizeof(fb->page));
+	fb->dirty = 0xFF;
+}
+
+void sh1106_fb_clear_pages(sh1106_fb_t *fb, uint8_t first, uint8_t count) {
+	for (uint8_t p = first; p < first + count && p < SH1106_PAGES; p++) {
+		memset(fb->page[p], 0, SH1106_WIDTH);
+		fb->dirty |= 1u << p;
+	}
+}
+
+void sh1106_fb_vline(sh1106_fb_t *fb, uint8_t x, uint8_t y0, uint8_t y1, bool on) {
+	if (y0 > y1) { uint8_t t = y0; y0 = y1; y1 = t; }
+	if (x >= SH1106_WIDTH || y0 >= SH1106_HEIGHT) return;
+	if (y1 >= SH1106_HEIGHT) y1 = SH1106_HEIGHT - 1;
+
+	for (uint8_t p = y0 >> 3; p <= y1 >> 3; p++) {
+		uint8_t lo = (p == y0 >> 3) ? (y0 & 7) : 0;
+		uint8_t hi = (p == y1 >> 3) ? (y1 & 7) : 7;
+		uint8_t mask = (uint8_t)((0xFF << lo) & (0xFF >> (7 - hi)));
+
+		if (on) fb->page[p][x] |= mask;
+		else    fb->page[p][x] &= ~mask;
+		fb->dirty |= 1u << p;
+	}
+}
+
+void sh1106_fb_blit(sh1106_fb_t *fb, uint8_t x, uint8_t page,
+		const uint8_t *src, uint8_t w, uint8_t xor_mask) {
+	if (page >= SH1106_PAGES || x >= SH1106_WIDTH) return;
+	if (x + w > SH1106_WIDTH) w = SH1106_WIDTH - x;
+
+	uint8_t *dst = &fb->page[page][x];
+	uint8_t *end = dst + w;
+	uint32_t xor32 = xor_mask * 0x01010101u;
+
+	// head up to the next word boundary of the row
+	while (dst < end && ((x & 3) != 0)) {
+		*dst++ = *src++ ^ xor_mask;
+		x++;
+	}
+	// src may be unaligned; memcpy compiles to a plain load when it is not
+	for (; dst + 4 <= end; dst += 4, src += 4) {
+		uint32_t v;
+		memcpy(&v, src, 4);
+		*(uint32_t *)dst = v ^ xor32;
+	}
+	while (dst < end) {
+		*dst++ = *src++ ^ xor_mask;
+	}
+	fb->dirty |= 1u << page;
+}
+
+void sh1106_fb_fill(sh1106_fb_t *fb, uint8_t x, uint8_t page, uint8_t w, uint8_t pattern) {
+	if (page >= SH1106_PAGES || x >= SH1106_WIDTH) return;
+	if (x + w > SH1106_WIDTH) w = SH1106_WIDTH - x;
+
+	uint8_t end = x + w;
+	uint32_t pat32 = pattern * 0x01010101u;
+
+	for (; x < end && (x & 3); x++) fb->page[page][x] = pattern;
+	for (; x + 4 <= end; x += 4) fb->word[page][x >> 2] = pat32;
+	for (; x < end; x++) fb->page[page][x] = pattern;
+	fb->dirty |= 1u << page;
+}
+
+const uint8_t *sh1106_font8x8(char c) {
+	return font8x8_basic_tr[(uint8_t)c & 0x7F];
+}
+
+uint8_t sh1106_fb_text(sh1106_fb_t *fb, uint8_t x, uint8_t page, const char *text) {
+	if (page >= SH1106_PAGES) return x;
+
+	for (; *text && x + 8 <= SH1106_WIDTH; text++, x += 8) {
+		memcpy(&fb->page[page][x], sh1106_font8x8(*text), 8);
+	}
+	fb->dirty |= 1u << page;
+	return x;
+}
@@ -0,0 +1,205 @@
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#include "sdkconfig.h"
+
+#include "sh1106.h"
+#include "sh1106_bus.h"
+#include "perf.h"
+
+#define SDA_PIN CONFIG_SH1106_I2C_SDA
+#define SCL_PIN CONFIG_SH1106_I2C_SCL
+
+#if SDA_PIN == SCL_PIN
+#error "SH1106: SDA and SCL are the same GPIO"
+#endif
+#if SH1106_BAD_OUT_PIN(SDA_PIN) || SH1106_BAD_OUT_PIN(SCL_PIN)
+#error "SH1106: I2C pin is flash-wired (GPIO6-11) or input-only (GPIO34-39)"
+#endif
+
+// command links live on the caller's stack: no heap traffic per transfer.
+// Largest user is a page write: start, 8 single bytes, data, stop.
+#define LINK_SIZE I2C_LINK_RECOMMENDED_SIZE(3)
+
+// A page is 140 bytes = 3.2 ms at 400 kHz; the timeout scales with the clock.
+#define TIMEOUT_MS_400K     10
+
+// Three recoveries within 10 s halve the clock, down to standard mode.
+#define BACKOFF_FAULTS      3
+#define BACKOFF_WINDOW_US   10000000
+#define CLK_MIN_HZ          100000
+
+#define RECOVERY_PULSES     9
+#define LOG_GAP_US          1000000     // at most one warning per second
+
+#define tag "SH1106_I2C"
+
+static uint32_t clk_hz = CONFIG_SH1106_I2C_CLK_HZ;
+static sh1106_bus_stats_t stats;
+static uint64_t lat_total_us;
+static int64_t fault_us[BACKOFF_FAULTS];   // ring of recent recovery times
+static uint8_t fault_next;
+static bool reset_pending;
+static int64_t last_log_us;
+
+static void driver_up(void) {
+	i2c_config_t i2c_config = {
+		.mode = I2C_MODE_MASTER,
+		.sda_io_num = SDA_PIN,
+		.scl_io_num = SCL_PIN,
+		.sda_pullup_en = GPIO_PULLUP_ENABLE,
+		.scl_pullup_en = GPIO_PULLUP_ENABLE,
+		.master.clk_speed = clk_hz
+	};
+	i2c_param_config(I2C_NUM_0, &i2c_config);
+	i2c_driver_install(I2C_NUM_0, I2C_MODE_MASTER, 0, 0, 0);
+}
+
+void sh1106_bus_init(void) {
+	driver_up();
+}
+
+void i2c_master_init(void) {
+	sh1106_bus_init();
+}
+
+// A slave that lost clock edges (glitch, brown-out) may be holding SDA
+// low in the middle of a byte and never see a STOP. Up to nine SCL pulses
+// let it shift the byte out, then a STOP frees the bus. The driver is
+// reinstalled from scratch, slower if faults keep coming.
+static void recover(void) {
+	i2c_driver_delete(I2C_NUM_0);
+
+	gpio_set_pull_mode(SDA_PIN, GPIO_PULLUP_ONLY);
+	gpio_set_pull_mode(SCL_PIN, GPIO_PULLUP_ONLY);
+	gpio_set_direction(SDA_PIN, GPIO_MODE_INPUT_OUTPUT_OD);
+	gpio_set_direction(SCL_PIN, GPIO_MODE_INPUT_OUTPUT_OD);
+	gpio_set_level(SDA_PIN, 1);
+	gpio_set_level(SCL_PIN, 1);
+	esp_rom_delay_us(5);
+	for (int i = 0; i < RECOVERY_PULSES && !gpio_get_level(SDA_PIN); i++) {
+		gpio_set_level(SCL_PIN, 0);
+		esp_rom_delay_us(5);
+		gpio_set_level(SCL_PIN, 1);
+		esp_rom_delay_us(5);
+	}
+	// STOP: SDA rises while SCL is high
+	gpio_set_level(SCL_PIN, 0);
+	esp_rom_delay_us(5);
+	gpio_set_level(SDA_PIN, 0);
+	esp_rom_delay_us(5);
+	gpio_set_level(SCL_PIN, 1);
+	esp_rom_delay_us(5);
+	gpio_set_level(SDA_PIN, 1);
+	esp_rom_delay_us(5);
+	bool stuck = !gpio_get_level(SDA_PIN);
+
+	int64_t now = esp_timer_get_time();
+	int64_t oldest = fault_us[fault_next];
+	fault_us[fault_next] = now;
+	fault_next = (fault_next + 1) % BACKOFF_FAULTS;
+	bool backoff = oldest && now - oldest < BACKOFF_WINDOW_US && clk_hz > CLK_MIN_HZ;
+	if (backoff) {
+		clk_hz = clk_hz / 2 > CLK_MIN_HZ ? clk_hz / 2 : CLK_MIN_HZ;
+		stats.backoffs++;
+		for (int i = 0; i < BACKOFF_FAULTS; i++) fault_us[i] = 0;   // new window at the new clock
+	}
+
+	driver_up();
+	stats.recoveries++;
+	reset_pending = true;       // panel may have reset too
+
+	if (backoff || stuck || now - last_log_us > LOG_GAP_US) {
+		ESP_LOGW(tag, "bus recovered (#%lu)%s, clock %lu Hz", (unsigned long)stats.recoveries,
+				 stuck ? ", SDA still low" : "", (unsigned long)clk_hz);
+		last_log_us = now;
+	}
+}
+
+static esp_err_t begin(i2c_cmd_handle_t cmd) {
+	TickType_t timeout = pdMS_TO_TICKS(TIMEOUT_MS_400K * 400000 / clk_hz);
+	int64_t t0 = esp_timer_get_time();
+	esp_err_t err = i2c_master_cmd_begin(I2C_NUM_0, cmd, timeout ? timeout : 1);
+	uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
+
+	PERF_BUS_BUSY(dt);
+	stats.xfers++;
+	lat_total_us += dt;
+	if (dt > stats.lat_max_us) stats.lat_max_us = dt;
+	switch (err) {
+	case ESP_OK:            break;
+	case ESP_FAIL:          stats.nack++; break;       // panel did not ACK
+	case ESP_ERR_TIMEOUT:   stats.timeout++; break;    // bus busy or held low
+	default:                stats.other++; break;
+	}
+	return err;
+}
+
+// runs and frees a queued command; one recovery and retry on failure,
+// after that the caller's next frame tries again
+static esp_err_t run(i2c_cmd_handle_t cmd) {
+	esp_err_t err = begin(cmd);
+	if (err != ESP_OK) {
+		recover();
+		err = begin(cmd);
+	}
+	i2c_cmd_link_delete_static(cmd);
+	return err;
+}
+
+static esp_err_t write_ctrl(uint8_t control, const uint8_t *buf, size_t len) {
+	uint8_t link[LINK_SIZE];
+	i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(link, sizeof(link));
+	i2c_master_start(cmd);
+	i2c_master_write_byte(cmd, (OLED_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
+	i2c_master_write_byte(cmd, control, true);
+	i2c_master_write(cmd, buf, len, true);
+	i2c_master_stop(cmd);
+	return run(cmd);
+}
+
+esp_err_t sh1106_bus_cmd(const uint8_t *cmd, size_t len) {
+	return write_ctrl(OLED_CONTROL_BYTE_CMD_STREAM, cmd, len);
+}
+
+esp_err_t sh1106_bus_data(const uint8_t *data, size_t len) {
+	return write_ctrl(OLED_CONTROL_BYTE_DATA_STREAM, data, len);
+}
+
+esp_err_t sh1106_bus_page(uint8_t page, uint8_t col, const uint8_t *data, size_t len) {
+	// address and data in one transaction
+	uint8_t link[LINK_SIZE];
+	i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(link, sizeof(link));
+	i2c_master_start(cmd);
+	i2c_master_write_byte(cmd, (OLED_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
+	i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_SINGLE, true);
+	i2c_master_write_byte(cmd, col & 0x0F, true);
+	i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_SINGLE, true);
+	i2c_master_write_byte(cmd, 0x10 | (col >> 4), true);
+	i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_SINGLE, true);
+	i2c_master_write_byte(cmd, 0xB0 | page, true);
+	i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_DATA_STREAM, true);
+	i2c_master_write(cmd, data, len, true);
+	i2c_master_stop(cmd);
+	return run(cmd);
+}
+
+esp_err_t sh1106_bus_wait(void) {
+	return ESP_OK;      // legacy I2C driver is blocking
+}
+
+bool sh1106_bus_take_reset(void) {
+	bool r = reset_pending;
+	reset_pending = false;
+	return r;
+}
+
+void sh1106_bus_stats(sh1106_bus_stats_t *out) {
+	*out = stats;
+	out->clk_hz = clk_hz;
+	out->lat_avg_us = stats.xfers ? (uint32_t)(lat_total_us / stats.xfers) : 0;
+}
@@ -0,0 +1,163 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "sdkconfig.h"
+
+#include "sh1106.h"
+#include "sh1106_bus.h"
+
+#define SPI_HOST_ID     SPI3_HOST   // VSPI
+#define DC_PIN          CONFIG_SH1106_SPI_DC
+#define RST_PIN         CONFIG_SH1106_SPI_RST
+
+// one address + one data transaction per page, a whole frame in flight
+#define QUEUE_DEPTH     (2 * SH1106_PAGES)
+
+#if SH1106_BAD_OUT_PIN(CONFIG_SH1106_SPI_MOSI) || SH1106_BAD_OUT_PIN(CONFIG_SH1106_SPI_SCLK) || \
+	SH1106_BAD_OUT_PIN(CONFIG_SH1106_SPI_CS) || SH1106_BAD_OUT_PIN(DC_PIN) || SH1106_BAD_OUT_PIN(RST_PIN)
+#error "SH1106: SPI pin is flash-wired (GPIO6-11) or input-only (GPIO34-39)"
+#endif
+
+#define tag "SH1106_SPI"
+
+static spi_device_handle_t dev;
+static spi_transaction_t trans[QUEUE_DEPTH];
+static uint8_t queued;          // transactions handed to the driver
+static uint8_t next_slot;
+static sh1106_bus_stats_t stats;
+static uint64_t lat_total_us;   // polling transfers only; DMA ones run in the background
+static uint32_t lat_n;
+
+// SPI has no acknowledge: only driver errors can be seen here
+static esp_err_t count(esp_err_t err) {
+	stats.xfers++;
+	if (err == ESP_ERR_TIMEOUT) stats.timeout++;
+	else if (err != ESP_OK) stats.other++;
+	return err;
+}
+
+// D/C level travels in the transaction's user field
+static void IRAM_ATTR pre_transfer(spi_transaction_t *t) {
+	gpio_set_level(DC_PIN, (int)(intptr_t)t->user);
+}
+
+void sh1106_bus_init(void) {
+	spi_bus_config_t bus = {
+		.mosi_io_num = CONFIG_SH1106_SPI_MOSI,
+		.miso_io_num = -1,
+		.sclk_io_num = CONFIG_SH1106_SPI_SCLK,
+		.quadwp_io_num = -1,
+		.quadhd_io_num = -1,
+		.max_transfer_sz = SH1106_WIDTH,
+	};
+	spi_device_interface_config_t cfg = {
+		.clock_speed_hz = CONFIG_SH1106_SPI_CLK_HZ,
+		.mode = 0,
+		.spics_io_num = CONFIG_SH1106_SPI_CS,
+		.queue_size = QUEUE_DEPTH,
+		.pre_cb = pre_transfer,
+	};
+
+	gpio_reset_pin(DC_PIN);
+	gpio_set_direction(DC_PIN, GPIO_MODE_OUTPUT);
+	if (RST_PIN >= 0) {
+		gpio_reset_pin(RST_PIN);
+		gpio_set_direction(RST_PIN, GPIO_MODE_OUTPUT);
+		gpio_set_level(RST_PIN, 0);
+		vTaskDelay(pdMS_TO_TICKS(1));   // datasheet: >= 10 us low
+		gpio_set_level(RST_PIN, 1);
+		vTaskDelay(pdMS_TO_TICKS(1));
+	}
+
+	ESP_ERROR_CHECK(spi_bus_initialize(SPI_HOST_ID, &bus, SPI_DMA_CH_AUTO));
+	ESP_ERROR_CHECK(spi_bus_add_device(SPI_HOST_ID, &cfg, &dev));
+	ESP_LOGI(tag, "SPI bus up at %d Hz", CONFIG_SH1106_SPI_CLK_HZ);
+}
+
+static esp_err_t send(const uint8_t *buf, size_t len, int dc) {
+	spi_transaction_t t = {
+		.length = len * 8,
+		.tx_buffer = buf,
+		.user = (void *)(intptr_t)dc,
+	};
+	// anything queued has to go out first, or the D/C order breaks
+	sh1106_bus_wait();
+	int64_t t0 = esp_timer_get_time();
+	esp_err_t err = spi_device_polling_transmit(dev, &t);
+	uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
+	lat_total_us += dt;
+	lat_n++;
+	if (dt > stats.lat_max_us) stats.lat_max_us = dt;
+	return count(err);
+}
+
+esp_err_t sh1106_bus_cmd(const uint8_t *cmd, size_t len) {
+	return send(cmd, len, 0);
+}
+
+esp_err_t sh1106_bus_data(const uint8_t *data, size_t len) {
+	return send(data, len, 1);
+}
+
+static esp_err_t queue(spi_transaction_t *t) {
+	esp_err_t err = count(spi_device_queue_trans(dev, t, portMAX_DELAY));
+	if (err == ESP_OK) queued++;
+	return err;
+}
+
+esp_err_t sh1106_bus_page(uint8_t page, uint8_t col, const uint8_t *data, size_t len) {
+	// slots are reused round-robin, so only once all of them are back
+	if (queued + 2 > QUEUE_DEPTH) sh1106_bus_wait();
+
+	// address bytes fit in tx_data, no DMA buffer needed
+	spi_transaction_t *a = &trans[next_slot++ % QUEUE_DEPTH];
+	memset(a, 0, sizeof(*a));
+	a->flags = SPI_TRANS_USE_TXDATA;
+	a->length = 3 * 8;
+	a->tx_data[0] = 0xB0 | page;
+	a->tx_data[1] = col & 0x0F;
+	a->tx_data[2] = 0x10 | (col >> 4);
+	a->user = (void *)0;
+
+	// page data straight from the framebuffer (internal RAM, DMA capable)
+	spi_transaction_t *d = &trans[next_slot++ % QUEUE_DEPTH];
+	memset(d, 0, sizeof(*d));
+	d->length = len * 8;
+	d->tx_buffer = data;
+	d->user = (void *)1;
+
+	esp_err_t err = queue(a);
+	return err == ESP_OK ? queue(d) : err;
+}
+
+esp_err_t sh1106_bus_wait(void) {
+	esp_err_t ret = ESP_OK;
+	spi_transaction_t *done;
+
+	while (queued) {
+		esp_err_t err = spi_device_get_trans_result(dev, &done, portMAX_DELAY);
+		if (err != ESP_OK) {
+			ret = err;
+			stats.other++;
+		}
+		queued--;
+	}
+	return ret;
+}
+
+bool sh1106_bus_take_reset(void) {
+	return false;       // no bus recovery on SPI
+}
+
+void sh1106_bus_stats(sh1106_bus_stats_t *out) {
+	*out = stats;
+	out->clk_hz = CONFIG_SH1106_SPI_CLK_HZ;
+	out->lat_avg_us = lat_n ? (uint32_t)(lat_total_us / lat_n) : 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+
+/* Rozkład zadań na rdzenie i ich priorytety.
+ *
+ * Rdzeń 0: radio (host i kontroler NimBLE, esp_timer). Rdzeń czujnika:
+ * ISR kontaktronu i obróbka impulsów wysoko, wyświetlacz i zapis
+ * dziennika nisko. Przerwanie ląduje na rdzeniu, który je instaluje –
+ * dlatego GPIO i magistralę wyświetlacza inicjujemy z zadania
+ * przypiętego do rdzenia czujnika.
+ */
+
+#if CONFIG_TOPO_PINNED
+
+#define TOPO_CORE_SENSOR    CONFIG_TOPO_SENSOR_CORE
+#define TOPO_CORE_UI        CONFIG_TOPO_SENSOR_CORE
+#define TOPO_PRIO_SENSOR    CONFIG_TOPO_SENSOR_PRIO
+#define TOPO_PRIO_UI        CONFIG_TOPO_UI_PRIO
+#define TOPO_PRIO_LOG       CONFIG_TOPO_LOG_PRIO
+
+#if CONFIG_TOPO_SENSOR_CORE == 0 && !CONFIG_FREERTOS_UNICORE
+#warning "sensor core shares core 0 with the radio"
+#endif
+#if CONFIG_BT_NIMBLE_ENABLED && CONFIG_BT_NIMBLE_PINNED_TO_CORE == CONFIG_TOPO_SENSOR_CORE
+#error "set BT_NIMBLE_PINNED_TO_CORE to the radio core (0)"
+#endif
+#if CONFIG_BT_CONTROLLER_ENABLED && defined(CONFIG_BT_CTRL_PINNED_TO_CORE) && \
+    CONFIG_BT_CTRL_PINNED_TO_CORE == CONFIG_TOPO_SENSOR_CORE
+#error "set BT_CTRL_PINNED_TO_CORE to the radio core (0)"
+#endif
+
+#else
+
+/* dawny układ: bez przypięcia, priorytety jak przed wprowadzeniem topologii */
+#define TOPO_CORE_SENSOR    tskNO_AFFINITY
+#define TOPO_CORE_UI        tskNO_AFFINITY
+#define TOPO_PRIO_SENSOR    5
+#define TOPO_PRIO_UI        1
+#define TOPO_PRIO_LOG       2
+
+#endif
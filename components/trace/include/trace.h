@@ -0,0 +1,59 @@
+#pragma once
+#include <stdint.h>
+#include "sdkconfig.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Odroczony ślad binarny.
+ *
+ * TRACE("fmt", a, b, c, d) nie formatuje niczego: zapisuje adres stałego
+ * napisu formatu, czas z esp_timer i do 4 argumentów 32-bitowych
+ * w pierścieniu swojego rdzenia (rezerwacja slotu jednym atomowym
+ * fetch_add, bez blokad). Działa w ISR i przy wyłączonym cache flash.
+ *
+ * Argumenty: liczby całkowite, wskaźniki i napisy stałe (%s czyta adres
+ * z rodata). Float nie przejdzie – podaj np. setne części jako int.
+ *
+ * Formatuje zadanie o priorytecie idle (trace_init) albo host ze zrzutu
+ * (tools/trace_decode.py + ELF). Co sekundę hook ticka wstawia na każdym
+ * rdzeniu znacznik synchronizacji (fmt == NULL, arg = pełny czas
+ * esp_timer w µs), z którego wpisy dostają starsze 32 bity czasu.
+ * Nie licznik cykli: przy DFS zmienia tempo, a w light sleep stoi.
+ */
+
+#define TRACE_ARGS  4
+
+typedef struct {
+    uint32_t    seq;        /* numer wpisu + 1; zapisywany na końcu */
+    uint32_t    us;         /* esp_timer, młodsze 32 bity */
+    const char *fmt;        /* NULL = znacznik synchronizacji */
+    uint32_t    arg[TRACE_ARGS];
+} trace_rec_t;
+
+#if CONFIG_TRACE
+
+void trace_emit(const char *fmt, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+
+/* Uruchamia zadanie opróżniające i znaczniki synchronizacji. Wpisy
+ * sprzed wywołania czekają w pierścieniach. */
+void trace_init(void);
+
+/* Wpisy nadpisane, zanim zadanie zdążyło je odebrać. */
+uint32_t trace_lost(void);
+
+#define TRACE(...)  TRACE_PICK_(__VA_ARGS__, 0, 0, 0, 0, 0)
+#define TRACE_PICK_(fmt, a, b, c, d, ...) \
+    trace_emit(fmt, TRACE_U32_(a), TRACE_U32_(b), TRACE_U32_(c), TRACE_U32_(d))
+#define TRACE_U32_(x) ((uint32_t)(uintptr_t)(x))
+
+#else
+
+#define TRACE(...)  ((void)0)
+#define trace_init() ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
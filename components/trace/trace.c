@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <string.h>
+#include "sdkconfig.h"
+
+#if CONFIG_TRACE
+
+#include "esp_cpu.h"
+#include "esp_freertos_hooks.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "trace.h"
+
+#define RING_LEN    CONFIG_TRACE_RING_LEN
+#define RING_MASK   (RING_LEN - 1)
+#define SYNC_TICKS  CONFIG_FREERTOS_HZ      /* znacznik co sekundę */
+
+_Static_assert((RING_LEN & RING_MASK) == 0, "TRACE_RING_LEN must be a power of two");
+
+typedef struct {
+    uint32_t    head;       /* następny wolny numer (producenci) */
+    uint32_t    tail;       /* następny do odebrania (tylko drain) */
+    trace_rec_t rec[RING_LEN];
+} trace_ring_t;
+
+static DRAM_ATTR trace_ring_t rings[portNUM_PROCESSORS];
+static uint32_t lost;
+
+/* ---------- producent ---------- */
+void IRAM_ATTR trace_emit(const char *fmt, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3)
+{
+    uint32_t us = (uint32_t)esp_timer_get_time();
+    trace_ring_t *r = &rings[esp_cpu_get_core_id()];
+
+    /* atomowo, bo ISR może wejść w połowie zapisu zadania na tym samym
+     * rdzeniu, a zadanie może zostać przeniesione na drugi */
+    uint32_t n = __atomic_fetch_add(&r->head, 1, __ATOMIC_RELAXED);
+    trace_rec_t *e = &r->rec[n & RING_MASK];
+
+    __atomic_store_n(&e->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    e->us = us;
+    e->fmt = fmt;
+    e->arg[0] = a0;
+    e->arg[1] = a1;
+    e->arg[2] = a2;
+    e->arg[3] = a3;
+    __atomic_store_n(&e->seq, n + 1, __ATOMIC_RELEASE);
+}
+
+static void IRAM_ATTR sync_hook(void)
+{
+    static uint32_t ticks[portNUM_PROCESSORS];
+    int core = esp_cpu_get_core_id();
+
+    if (++ticks[core] < SYNC_TICKS) return;
+    ticks[core] = 0;
+    uint64_t us = (uint64_t)esp_timer_get_time();
+    trace_emit(NULL, (uint32_t)us, (uint32_t)(us >> 32), 0, 0);
+}
+
+/* ---------- konsument ---------- */
+/* false = pusto albo wpis pod tail jeszcze się zapisuje */
+static bool take(trace_ring_t *r, trace_rec_t *out)
+{
+    for (;;) {
+        uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        if (r->tail == head) return false;
+        if (head - r->tail > RING_LEN) {            /* producenci nas okrążyli */
+            lost += head - r->tail - RING_LEN;
+            r->tail = head - RING_LEN;
+        }
+
+        trace_rec_t *e = &r->rec[r->tail & RING_MASK];
+        uint32_t want = r->tail + 1;
+        uint32_t seq = __atomic_load_n(&e->seq, __ATOMIC_ACQUIRE);
+        if (seq == 0 || (int32_t)(seq - want) < 0) return false;
+        if (seq == want) {
+            memcpy(out, e, sizeof(*out));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&e->seq, __ATOMIC_RELAXED) == want) {
+                r->tail++;
+                return true;
+            }
+        }
+        /* nadpisany nowszym wpisem */
+        lost++;
+        r->tail++;
+    }
+}
+
+uint32_t trace_lost(void)
+{
+    return lost;
+}
+
+#if CONFIG_TRACE_DRAIN_BINARY
+static void print_rec(int core, const trace_rec_t *t)
+{
+    printf("TRC %d %08lx %08lx %08lx %08lx %08lx %08lx\n", core,
+           (unsigned long)t->us, (unsigned long)(uintptr_t)t->fmt,
+           (unsigned long)t->arg[0], (unsigned long)t->arg[1],
+           (unsigned long)t->arg[2], (unsigned long)t->arg[3]);
+}
+#else
+static void print_rec(int core, const trace_rec_t *t)
+{
+    /* starsze bity czasu z ostatniego znacznika tego rdzenia; wpisom
+     * sprzed pierwszego (start) wystarczy młodsze 32 */
+    static uint64_t sync_us[portNUM_PROCESSORS];
+
+    if (!t->fmt) {
+        sync_us[core] = t->arg[0] | (uint64_t)t->arg[1] << 32;
+        return;
+    }
+    uint64_t us = sync_us[core] + (int32_t)(t->us - (uint32_t)sync_us[core]);
+    printf("T%d %6lu.%03lu ", core, (unsigned long)(us / 1000), (unsigned long)(us % 1000));
+    printf(t->fmt, t->arg[0], t->arg[1], t->arg[2], t->arg[3]);
+    putchar('\n');
+}
+#endif
+
+static void drain_task(void *arg)
+{
+    trace_rec_t t;
+    uint32_t lost_seen = 0;
+
+    for (;;) {
+        for (int c = 0; c < portNUM_PROCESSORS; c++)
+            while (take(&rings[c], &t)) print_rec(c, &t);
+        if (lost != lost_seen) {
+            printf("TRC-LOST %lu\n", (unsigned long)(lost - lost_seen));
+            lost_seen = lost;
+        }
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_TRACE_DRAIN_MS));
+    }
+}
+
+void trace_init(void)
+{
+    for (int c = 0; c < portNUM_PROCESSORS; c++)
+        esp_register_freertos_tick_hook_for_cpu(sync_hook, c);
+    static StackType_t  stack[3072];
+    static StaticTask_t tcb;
+
+    xTaskCreateStatic(drain_task, "trace", sizeof(stack), NULL, tskIDLE_PRIORITY, stack, &tcb);
+}
+
+#endif /* CONFIG_TRACE */
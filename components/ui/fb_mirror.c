@@ -0,0 +1,129 @@
+#include <string.h>
+#include "fb_mirror.h"
+
+#define RUN_MAX     128
+#define ALL_PAGES   ((uint8_t)((1u << SH1106_PAGES) - 1))
+
+void fb_mirror_init(fb_mirror_t *m, uint32_t min_frame_us)
+{
+    memset(m, 0, sizeof(*m));
+    m->min_frame_us = min_frame_us;
+    m->last_frame_us = INT64_MIN / 2;
+    m->key = true;                  /* odbiorca nie ma jeszcze obrazu */
+}
+
+void fb_mirror_key(fb_mirror_t *m)
+{
+    m->active = false;
+    m->key = true;
+}
+
+bool fb_mirror_begin(fb_mirror_t *m, const sh1106_fb_t *fb, int64_t now)
+{
+    if (m->active || (!m->key && !m->pending)) return false;
+    if (now - m->last_frame_us < m->min_frame_us) return false;
+
+    uint8_t want = m->key ? ALL_PAGES : m->pending;
+    uint8_t mask = 0;
+    uint16_t len = 0;
+
+    if (m->key) memset(m->ref, 0, sizeof(m->ref));
+    for (int p = 0; p < SH1106_PAGES; p++) {
+        if (!(want & 1u << p)) continue;
+        const uint8_t *src = fb->page[p];
+        uint8_t *ref = m->ref[p];
+        uint8_t any = 0;
+        for (int c = 0; c < SH1106_WIDTH; c++) {
+            uint8_t d = src[c] ^ ref[c];
+            m->x[len + c] = d;
+            any |= d;
+        }
+        /* strona przerysowana tak samo nie idzie w ogóle */
+        if (!any && !m->key) continue;
+        memcpy(ref, src, SH1106_WIDTH);
+        mask |= 1u << p;
+        len += SH1106_WIDTH;
+    }
+    m->pending = 0;
+    if (!mask) return false;
+
+    m->mask = mask;
+    m->len = len;
+    m->pos = 0;
+    m->pkt = 0;
+    m->seq++;
+    m->frame_key = m->key;
+    m->key = false;
+    m->active = true;
+    m->last_frame_us = now;
+    m->frames++;
+    if (m->frame_key) m->keys++;
+    return true;
+}
+
+size_t fb_mirror_next(fb_mirror_t *m, uint8_t *out, size_t cap)
+{
+    if (!m->active || cap < FB_MIRROR_PKT_MIN) return 0;
+
+    const uint8_t *x = m->x;
+    size_t n = 0;
+    out[n++] = m->seq;
+    out[n++] = (m->frame_key ? FB_MIRROR_KEY : 0) | (m->pkt & FB_MIRROR_IDX_MASK);
+    if (m->pkt == 0) out[n++] = m->mask;
+
+    uint16_t pos = m->pos, end = m->len;
+    while (pos < end && n < cap) {
+        if (x[pos] == 0) {
+            uint16_t r = 1;
+            while (pos + r < end && r < RUN_MAX && x[pos + r] == 0) r++;
+            if (pos + r == end) {       /* zera do końca ramki – nie wysyłamy */
+                pos = end;
+                break;
+            }
+            out[n++] = 0x80 | (r - 1);
+            pos += r;
+            continue;
+        }
+        /* dosłownie aż do dwóch zer z rzędu (pojedyncze zero taniej w środku) */
+        size_t room = cap - n - 1;
+        if (room == 0) break;
+        uint16_t l = 1;
+        while (pos + l < end && l < RUN_MAX && l < room &&
+               !(x[pos + l] == 0 && (pos + l + 1 == end || x[pos + l + 1] == 0)))
+            l++;
+        out[n++] = l - 1;
+        memcpy(out + n, x + pos, l);
+        n += l;
+        pos += l;
+    }
+    m->pos = pos;
+    if (pos >= end) {
+        out[1] |= FB_MIRROR_END;
+        m->active = false;
+    }
+    m->pkt++;
+    m->bytes += n;
+    return n;
+}
+
+bool fb_mirror_pump(fb_mirror_t *m, uint8_t *buf, size_t cap,
+                    fb_mirror_send_t send, void *ctx)
+{
+    while (m->active) {
+        uint16_t pos = m->pos;
+        uint8_t  pkt = m->pkt;
+        uint32_t bytes = m->bytes;
+
+        size_t n = fb_mirror_next(m, buf, cap);
+        if (n == 0) break;
+        if (!send(ctx, buf, n)) {
+            /* cofnięcie kodera: ten sam pakiet pójdzie następnym razem */
+            m->pos = pos;
+            m->pkt = pkt;
+            m->bytes = bytes;
+            m->active = true;
+            return true;
+        }
+    }
+    return false;
+}
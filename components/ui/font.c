@@ -0,0 +1,126 @@
+#include <string.h>
+#include "font.h"
+
+static struct {
+    font_glyph_t g;
+    uint32_t     used;              /* znacznik LRU, 0 = pusty */
+} cache[FONT_CACHE];
+
+static uint32_t     tick;
+static font_stats_t stats;
+
+/* ---------- UTF-8 ---------- */
+uint32_t utf8_next(const char **s)
+{
+    const uint8_t *p = (const uint8_t *)*s;
+    uint32_t cp;
+    int n;
+
+    if (p[0] == 0) return 0;
+    if (p[0] < 0x80)                { *s += 1; return p[0]; }
+    else if ((p[0] & 0xE0) == 0xC0) { cp = p[0] & 0x1F; n = 1; }
+    else if ((p[0] & 0xF0) == 0xE0) { cp = p[0] & 0x0F; n = 2; }
+    else if ((p[0] & 0xF8) == 0xF0) { cp = p[0] & 0x07; n = 3; }
+    else goto bad;
+
+    for (int i = 1; i <= n; i++) {
+        if ((p[i] & 0xC0) != 0x80) goto bad;    /* łapie też NUL w środku */
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    *s += n + 1;
+    return cp;
+
+bad:
+    *s += 1;
+    return FONT_FALLBACK;
+}
+
+/* ---------- atlas ---------- */
+static const font_glyph_desc_t *find(uint32_t cp)
+{
+    int lo = 0, hi = font_atlas.count - 1;
+
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        uint16_t c = font_atlas.glyphs[mid].cp;
+        if (c == cp) return &font_atlas.glyphs[mid];
+        if (c < cp) lo = mid + 1;
+        else        hi = mid - 1;
+    }
+    return NULL;
+}
+
+static void decode(const font_glyph_desc_t *d, font_glyph_t *g)
+{
+    const uint8_t *p = font_atlas.data + d->off;
+
+    g->cp = d->cp;
+    g->width = d->width;
+    memset(g->col, 0, sizeof(g->col));
+    if (!d->rle) {
+        memcpy(g->col, p, d->width);
+        return;
+    }
+
+    /* maska powtórzeń: bit i = kolumna i taka sama jak i-1 */
+    uint8_t mask = *p++;
+    for (uint8_t i = 0; i < d->width; i++)
+        g->col[i] = (mask >> i) & 1 ? g->col[i - 1] : *p++;
+}
+
+const font_glyph_t *font_glyph(uint32_t cp)
+{
+    int victim = 0;
+
+    tick++;
+    for (int i = 0; i < FONT_CACHE; i++) {
+        if (cache[i].used && cache[i].g.cp == cp) {
+            cache[i].used = tick;
+            stats.hits++;
+            return &cache[i].g;
+        }
+        if (cache[i].used < cache[victim].used) victim = i;
+    }
+
+    const font_glyph_desc_t *d = find(cp);
+    if (!d) {
+        if (cp == FONT_FALLBACK) return NULL;      /* atlas bez '?' */
+        return font_glyph(FONT_FALLBACK);
+    }
+    stats.misses++;
+    decode(d, &cache[victim].g);
+    cache[victim].used = tick;
+    return &cache[victim].g;
+}
+
+/* ---------- napisy ---------- */
+uint16_t font_text_width(const char *s)
+{
+    uint16_t w = 0;
+    uint32_t cp;
+
+    while ((cp = utf8_next(&s)) != 0) {
+        const font_glyph_t *g = font_glyph(cp);
+        if (g) w += g->width;
+    }
+    return w;
+}
+
+uint16_t font_draw(uint8_t *row, uint16_t cap, uint16_t x, const char *s)
+{
+    uint32_t cp;
+
+    while ((cp = utf8_next(&s)) != 0) {
+        const font_glyph_t *g = font_glyph(cp);
+        if (!g) continue;
+        if (x + g->width > cap) break;
+        for (uint8_t i = 0; i < g->width; i++) row[x + i] |= g->col[i];
+        x += g->width;
+    }
+    return x;
+}
+
+void font_get_stats(font_stats_t *out)
+{
+    *out = stats;
+}
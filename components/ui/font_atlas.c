@@ -0,0 +1,178 @@
+/* Wygenerowane przez tools/gen_font.py – nie edytować ręcznie. */
+#include "font.h"
+
+/* 113 glifów, dane 758 B (bez kompresji 791 B), tablica 678 B */
+
+static const uint8_t atlas_data[758] = {
+    0x06, 0x00, 0x06, 0x5F, 0x5F, 0x06, 0x00, 0x12, 0x03, 0x00, 0x03, 0x00, 0x24, 0x14, 0x7F, 0x14,
+    0x7F, 0x14, 0x00, 0x24, 0x2E, 0x6B, 0x6B, 0x3A, 0x12, 0x00, 0x46, 0x66, 0x30, 0x18, 0x0C, 0x66,
+    0x62, 0x00, 0x30, 0x7A, 0x4F, 0x5D, 0x37, 0x7A, 0x48, 0x00, 0x04, 0x07, 0x03, 0x00, 0x1C, 0x3E,
+    0x63, 0x41, 0x00, 0x41, 0x63, 0x3E, 0x1C, 0x00, 0x08, 0x2A, 0x3E, 0x1C, 0x1C, 0x3E, 0x2A, 0x08,
+    0x2A, 0x08, 0x3E, 0x08, 0x00, 0x80, 0xE0, 0x60, 0x00, 0x3E, 0x08, 0x00, 0x60, 0x60, 0x00, 0x60,
+    0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00, 0x3E, 0x7F, 0x71, 0x59, 0x4D, 0x7F, 0x3E, 0x00, 0x28,
+    0x40, 0x42, 0x7F, 0x40, 0x00, 0x62, 0x73, 0x59, 0x49, 0x6F, 0x66, 0x00, 0x22, 0x63, 0x49, 0x49,
+    0x7F, 0x36, 0x00, 0x18, 0x1C, 0x16, 0x53, 0x7F, 0x7F, 0x50, 0x00, 0x27, 0x67, 0x45, 0x45, 0x7D,
+    0x39, 0x00, 0x3C, 0x7E, 0x4B, 0x49, 0x79, 0x30, 0x00, 0x03, 0x03, 0x71, 0x79, 0x0F, 0x07, 0x00,
+    0x36, 0x7F, 0x49, 0x49, 0x7F, 0x36, 0x00, 0x06, 0x4F, 0x49, 0x69, 0x3F, 0x1E, 0x00, 0x66, 0x66,
+    0x00, 0x80, 0xE6, 0x66, 0x00, 0x08, 0x1C, 0x36, 0x63, 0x41, 0x00, 0x3E, 0x24, 0x00, 0x41, 0x63,
+    0x36, 0x1C, 0x08, 0x00, 0x02, 0x03, 0x51, 0x59, 0x0F, 0x06, 0x00, 0x3E, 0x7F, 0x41, 0x5D, 0x5D,
+    0x1F, 0x1E, 0x00, 0x7C, 0x7E, 0x13, 0x13, 0x7E, 0x7C, 0x00, 0x14, 0x41, 0x7F, 0x49, 0x7F, 0x36,
+    0x00, 0x1C, 0x3E, 0x63, 0x41, 0x41, 0x63, 0x22, 0x00, 0x41, 0x7F, 0x7F, 0x41, 0x63, 0x3E, 0x1C,
+    0x00, 0x41, 0x7F, 0x7F, 0x49, 0x5D, 0x41, 0x63, 0x00, 0x41, 0x7F, 0x7F, 0x49, 0x1D, 0x01, 0x03,
+    0x00, 0x1C, 0x3E, 0x63, 0x41, 0x51, 0x73, 0x72, 0x00, 0x2A, 0x7F, 0x08, 0x7F, 0x00, 0x41, 0x7F,
+    0x7F, 0x41, 0x00, 0x30, 0x70, 0x40, 0x41, 0x7F, 0x3F, 0x01, 0x00, 0x41, 0x7F, 0x7F, 0x08, 0x1C,
+    0x77, 0x63, 0x00, 0x41, 0x7F, 0x7F, 0x41, 0x40, 0x60, 0x70, 0x00, 0x42, 0x7F, 0x0E, 0x1C, 0x0E,
+    0x7F, 0x00, 0x42, 0x7F, 0x06, 0x0C, 0x18, 0x7F, 0x00, 0x1C, 0x3E, 0x63, 0x41, 0x63, 0x3E, 0x1C,
+    0x00, 0x41, 0x7F, 0x7F, 0x49, 0x09, 0x0F, 0x06, 0x00, 0x1E, 0x3F, 0x21, 0x71, 0x7F, 0x5E, 0x00,
+    0x41, 0x7F, 0x7F, 0x09, 0x19, 0x7F, 0x66, 0x00, 0x26, 0x6F, 0x4D, 0x59, 0x73, 0x32, 0x00, 0x03,
+    0x41, 0x7F, 0x7F, 0x41, 0x03, 0x00, 0x2A, 0x7F, 0x40, 0x7F, 0x00, 0x1F, 0x3F, 0x60, 0x60, 0x3F,
+    0x1F, 0x00, 0x42, 0x7F, 0x30, 0x18, 0x30, 0x7F, 0x00, 0x43, 0x67, 0x3C, 0x18, 0x3C, 0x67, 0x43,
+    0x00, 0x07, 0x4F, 0x78, 0x78, 0x4F, 0x07, 0x00, 0x47, 0x63, 0x71, 0x59, 0x4D, 0x67, 0x73, 0x00,
+    0x0A, 0x7F, 0x41, 0x00, 0x01, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x00, 0x0A, 0x41, 0x7F, 0x00,
+    0x08, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x08, 0x00, 0xFE, 0x80, 0x03, 0x07, 0x04, 0x00, 0x20, 0x74,
+    0x54, 0x54, 0x3C, 0x78, 0x40, 0x00, 0x41, 0x7F, 0x3F, 0x48, 0x48, 0x78, 0x30, 0x00, 0x38, 0x7C,
+    0x44, 0x44, 0x6C, 0x28, 0x00, 0x30, 0x78, 0x48, 0x49, 0x3F, 0x7F, 0x40, 0x00, 0x38, 0x7C, 0x54,
+    0x54, 0x5C, 0x18, 0x00, 0x48, 0x7E, 0x7F, 0x49, 0x03, 0x02, 0x00, 0x98, 0xBC, 0xA4, 0xA4, 0xF8,
+    0x7C, 0x04, 0x00, 0x41, 0x7F, 0x7F, 0x08, 0x04, 0x7C, 0x78, 0x00, 0x44, 0x7D, 0x7D, 0x40, 0x00,
+    0x60, 0xE0, 0x80, 0x80, 0xFD, 0x7D, 0x00, 0x41, 0x7F, 0x7F, 0x10, 0x38, 0x6C, 0x44, 0x00, 0x41,
+    0x7F, 0x7F, 0x40, 0x00, 0x7C, 0x7C, 0x18, 0x38, 0x1C, 0x7C, 0x78, 0x00, 0x0A, 0x7C, 0x04, 0x7C,
+    0x78, 0x00, 0x38, 0x7C, 0x44, 0x44, 0x7C, 0x38, 0x00, 0x84, 0xFC, 0xF8, 0xA4, 0x24, 0x3C, 0x18,
+    0x00, 0x18, 0x3C, 0x24, 0xA4, 0xF8, 0xFC, 0x84, 0x00, 0x44, 0x7C, 0x78, 0x4C, 0x04, 0x1C, 0x18,
+    0x00, 0x48, 0x5C, 0x54, 0x54, 0x74, 0x24, 0x00, 0x04, 0x3E, 0x7F, 0x44, 0x24, 0x00, 0x3C, 0x7C,
+    0x40, 0x40, 0x3C, 0x7C, 0x40, 0x00, 0x1C, 0x3C, 0x60, 0x60, 0x3C, 0x1C, 0x00, 0x3C, 0x7C, 0x70,
+    0x38, 0x70, 0x7C, 0x3C, 0x00, 0x44, 0x6C, 0x38, 0x10, 0x38, 0x6C, 0x44, 0x00, 0x9C, 0xBC, 0xA0,
+    0xA0, 0xFC, 0x7C, 0x00, 0x4C, 0x64, 0x74, 0x5C, 0x4C, 0x64, 0x00, 0x22, 0x08, 0x3E, 0x77, 0x41,
+    0x00, 0x77, 0x77, 0x00, 0x22, 0x41, 0x77, 0x3E, 0x08, 0x00, 0x02, 0x03, 0x01, 0x03, 0x02, 0x03,
+    0x01, 0x00, 0x38, 0x7C, 0xC6, 0x82, 0xC7, 0x7D, 0x38, 0x00, 0x38, 0x7C, 0x44, 0x46, 0x7D, 0x38,
+    0x00, 0x7C, 0x7E, 0x13, 0x13, 0xFE, 0xFC, 0x00, 0x20, 0x74, 0x54, 0x54, 0x3C, 0xF8, 0xC0, 0x00,
+    0x38, 0x7C, 0xC6, 0x82, 0x83, 0xC7, 0x44, 0x00, 0x38, 0x7C, 0x44, 0x46, 0x6D, 0x28, 0x00, 0x41,
+    0x7F, 0x7F, 0x49, 0x5D, 0xC1, 0xE3, 0x00, 0x38, 0x7C, 0x54, 0x54, 0xDC, 0x98, 0x00, 0x51, 0x7F,
+    0x7F, 0x49, 0x40, 0x60, 0x70, 0x00, 0x51, 0x7F, 0x7F, 0x48, 0x00, 0xFE, 0xFE, 0x0C, 0x18, 0x31,
+    0xFF, 0xFE, 0x00, 0x7C, 0x7C, 0x04, 0x06, 0x7D, 0x78, 0x00, 0x4C, 0xDE, 0x9A, 0xB3, 0xE7, 0x64,
+    0x00, 0x48, 0x5C, 0x54, 0x56, 0x75, 0x24, 0x00, 0x8E, 0xC6, 0xE2, 0xB2, 0x9B, 0xCF, 0xE6, 0x00,
+    0x4C, 0x64, 0x74, 0x5E, 0x4D, 0x64, 0x00, 0x8E, 0xC6, 0xE2, 0xB3, 0x9B, 0xCE, 0xE6, 0x00, 0x4C,
+    0x64, 0x75, 0x5D, 0x4C, 0x64, 0x00,
+};
+
+static const font_glyph_desc_t atlas_glyphs[113] = {
+    { 0x0020, 3, 1,    0 },   /*   */
+    { 0x0021, 5, 0,    2 },   /* ! */
+    { 0x0022, 6, 1,    7 },   /* " */
+    { 0x0023, 8, 1,   12 },   /* # */
+    { 0x0024, 7, 0,   19 },   /* $ */
+    { 0x0025, 8, 0,   26 },   /* % */
+    { 0x0026, 8, 0,   34 },   /* & */
+    { 0x0027, 4, 0,   42 },   /* ' */
+    { 0x0028, 5, 0,   46 },   /* ( */
+    { 0x0029, 5, 0,   51 },   /* ) */
+    { 0x002A, 8, 0,   56 },   /* * */
+    { 0x002B, 7, 1,   64 },   /* + */
+    { 0x002C, 4, 0,   69 },   /* , */
+    { 0x002D, 7, 1,   73 },   /* - */
+    { 0x002E, 3, 0,   76 },   /* . */
+    { 0x002F, 8, 0,   79 },   /* / */
+    { 0x0030, 8, 0,   87 },   /* 0 */
+    { 0x0031, 7, 1,   95 },   /* 1 */
+    { 0x0032, 7, 0,  101 },   /* 2 */
+    { 0x0033, 7, 0,  108 },   /* 3 */
+    { 0x0034, 8, 0,  115 },   /* 4 */
+    { 0x0035, 7, 0,  123 },   /* 5 */
+    { 0x0036, 7, 0,  130 },   /* 6 */
+    { 0x0037, 7, 0,  137 },   /* 7 */
+    { 0x0038, 7, 0,  144 },   /* 8 */
+    { 0x0039, 7, 0,  151 },   /* 9 */
+    { 0x003A, 3, 0,  158 },   /* : */
+    { 0x003B, 4, 0,  161 },   /* ; */
+    { 0x003C, 6, 0,  165 },   /* < */
+    { 0x003D, 7, 1,  171 },   /* = */
+    { 0x003E, 6, 0,  174 },   /* > */
+    { 0x003F, 7, 0,  180 },   /* ? */
+    { 0x0040, 8, 0,  187 },   /* @ */
+    { 0x0041, 7, 0,  195 },   /* A */
+    { 0x0042, 8, 1,  202 },   /* B */
+    { 0x0043, 8, 0,  209 },   /* C */
+    { 0x0044, 8, 0,  217 },   /* D */
+    { 0x0045, 8, 0,  225 },   /* E */
+    { 0x0046, 8, 0,  233 },   /* F */
+    { 0x0047, 8, 0,  241 },   /* G */
+    { 0x0048, 7, 1,  249 },   /* H */
+    { 0x0049, 5, 0,  254 },   /* I */
+    { 0x004A, 8, 0,  259 },   /* J */
+    { 0x004B, 8, 0,  267 },   /* K */
+    { 0x004C, 8, 0,  275 },   /* L */
+    { 0x004D, 8, 1,  283 },   /* M */
+    { 0x004E, 8, 1,  290 },   /* N */
+    { 0x004F, 8, 0,  297 },   /* O */
+    { 0x0050, 8, 0,  305 },   /* P */
+    { 0x0051, 7, 0,  313 },   /* Q */
+    { 0x0052, 8, 0,  320 },   /* R */
+    { 0x0053, 7, 0,  328 },   /* S */
+    { 0x0054, 7, 0,  335 },   /* T */
+    { 0x0055, 7, 1,  342 },   /* U */
+    { 0x0056, 7, 0,  347 },   /* V */
+    { 0x0057, 8, 1,  354 },   /* W */
+    { 0x0058, 8, 0,  361 },   /* X */
+    { 0x0059, 7, 0,  369 },   /* Y */
+    { 0x005A, 8, 0,  376 },   /* Z */
+    { 0x005B, 5, 1,  384 },   /* [ */
+    { 0x005C, 8, 0,  388 },   /* backslash */
+    { 0x005D, 5, 1,  396 },   /* ] */
+    { 0x005E, 8, 0,  400 },   /* ^ */
+    { 0x005F, 8, 1,  408 },   /* _ */
+    { 0x0060, 4, 0,  410 },   /* ` */
+    { 0x0061, 8, 0,  414 },   /* a */
+    { 0x0062, 8, 0,  422 },   /* b */
+    { 0x0063, 7, 0,  430 },   /* c */
+    { 0x0064, 8, 0,  437 },   /* d */
+    { 0x0065, 7, 0,  445 },   /* e */
+    { 0x0066, 7, 0,  452 },   /* f */
+    { 0x0067, 8, 0,  459 },   /* g */
+    { 0x0068, 8, 0,  467 },   /* h */
+    { 0x0069, 5, 0,  475 },   /* i */
+    { 0x006A, 7, 0,  480 },   /* j */
+    { 0x006B, 8, 0,  487 },   /* k */
+    { 0x006C, 5, 0,  495 },   /* l */
+    { 0x006D, 8, 0,  500 },   /* m */
+    { 0x006E, 7, 1,  508 },   /* n */
+    { 0x006F, 7, 0,  514 },   /* o */
+    { 0x0070, 8, 0,  521 },   /* p */
+    { 0x0071, 8, 0,  529 },   /* q */
+    { 0x0072, 8, 0,  537 },   /* r */
+    { 0x0073, 7, 0,  545 },   /* s */
+    { 0x0074, 6, 0,  552 },   /* t */
+    { 0x0075, 8, 0,  558 },   /* u */
+    { 0x0076, 7, 0,  566 },   /* v */
+    { 0x0077, 8, 0,  573 },   /* w */
+    { 0x0078, 8, 0,  581 },   /* x */
+    { 0x0079, 7, 0,  589 },   /* y */
+    { 0x007A, 7, 0,  596 },   /* z */
+    { 0x007B, 7, 1,  603 },   /* { */
+    { 0x007C, 3, 0,  609 },   /* | */
+    { 0x007D, 7, 1,  612 },   /* } */
+    { 0x007E, 8, 0,  618 },   /* ~ */
+    { 0x00D3, 8, 0,  626 },   /* Ó */
+    { 0x00F3, 7, 0,  634 },   /* ó */
+    { 0x0104, 7, 0,  641 },   /* Ą */
+    { 0x0105, 8, 0,  648 },   /* ą */
+    { 0x0106, 8, 0,  656 },   /* Ć */
+    { 0x0107, 7, 0,  664 },   /* ć */
+    { 0x0118, 8, 0,  671 },   /* Ę */
+    { 0x0119, 7, 0,  679 },   /* ę */
+    { 0x0141, 8, 0,  686 },   /* Ł */
+    { 0x0142, 5, 0,  694 },   /* ł */
+    { 0x0143, 8, 0,  699 },   /* Ń */
+    { 0x0144, 7, 0,  707 },   /* ń */
+    { 0x015A, 7, 0,  714 },   /* Ś */
+    { 0x015B, 7, 0,  721 },   /* ś */
+    { 0x0179, 8, 0,  728 },   /* Ź */
+    { 0x017A, 7, 0,  736 },   /* ź */
+    { 0x017B, 8, 0,  743 },   /* Ż */
+    { 0x017C, 7, 0,  751 },   /* ż */
+};
+
+const font_atlas_t font_atlas = {
+    .glyphs = atlas_glyphs,
+    .count  = 113,
+    .data   = atlas_data,
+    .data_len = 758,
+};
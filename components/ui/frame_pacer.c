@@ -0,0 +1,64 @@
+#include <string.h>
+#include "frame_pacer.h"
+
+void pacer_init(frame_pacer_t *p, const pacer_cfg_t *cfg, int64_t now)
+{
+    memset(p, 0, sizeof(*p));
+    p->cfg = *cfg;
+    p->last_frame_us = now - cfg->min_frame_us;     /* pierwsza klatka od razu */
+    p->last_active_us = now;
+    p->panel = PANEL_ON;
+}
+
+panel_state_t pacer_activity(frame_pacer_t *p, bool active, int64_t now)
+{
+    if (active) p->last_active_us = now;
+
+    int64_t idle = now - p->last_active_us;
+    if (p->cfg.off_us && idle >= p->cfg.off_us)
+        p->panel = PANEL_OFF;
+    else if (p->cfg.dim_us && idle >= p->cfg.dim_us)
+        p->panel = PANEL_DIM;
+    else
+        p->panel = PANEL_ON;
+    return p->panel;
+}
+
+bool pacer_frame_due(frame_pacer_t *p, uint8_t dirty, int64_t now)
+{
+    p->st.wakeups++;
+    /* wyłączony panel nic nie pokaże; ramka czeka na włączenie */
+    if (!dirty || p->panel == PANEL_OFF) return false;
+    if (now - p->last_frame_us < p->cfg.min_frame_us) {
+        p->st.held++;
+        return false;
+    }
+    p->last_frame_us = now;
+    p->st.frames++;
+    p->st.pages += __builtin_popcount(dirty);
+    return true;
+}
+
+static void earlier(int64_t *sleep, int64_t at_us)
+{
+    if (at_us < *sleep) *sleep = at_us;
+}
+
+uint32_t pacer_sleep_us(const frame_pacer_t *p, uint8_t dirty, int64_t now)
+{
+    int64_t s = p->cfg.heartbeat_us;
+
+    if (dirty && p->panel != PANEL_OFF)
+        earlier(&s, p->last_frame_us + p->cfg.min_frame_us - now);
+    if (p->panel == PANEL_ON && p->cfg.dim_us)
+        earlier(&s, p->last_active_us + p->cfg.dim_us - now);
+    if (p->panel != PANEL_OFF && p->cfg.off_us)
+        earlier(&s, p->last_active_us + p->cfg.off_us - now);
+    return s > 0 ? (uint32_t)s : 0;
+}
+
+void pacer_take_stats(frame_pacer_t *p, pacer_stats_t *out)
+{
+    *out = p->st;
+    memset(&p->st, 0, sizeof(p->st));
+}
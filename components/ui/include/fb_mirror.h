@@ -0,0 +1,83 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sh1106_fb.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Kopia ekranu dla zdalnego odbiorcy (podgląd, zrzuty ekranu).
+ *
+ * Koder trzyma obraz, jaki ma odbiorca, i wysyła tylko strony zmienione od
+ * poprzedniej ramki jako XOR z tym obrazem, skompresowany RLE – zmiana samej
+ * prędkości to kilkadziesiąt bajtów zamiast 1056. Bez HAL-u: wołający
+ * zgłasza zabrudzone strony przed flush, zaczyna ramkę i wyciąga pakiety,
+ * dopóki transport ma bufory.
+ *
+ * Pakiet (jedna notyfikacja):
+ *   [0]  seq ramki
+ *   [1]  flagi: FB_MIRROR_KEY, FB_MIRROR_END, bity 0-5 = numer pakietu w ramce
+ *   [2]  maska stron (tylko w pakiecie 0)
+ *   dalej tokeny strumienia = strony z maski po kolei, SH1106_WIDTH B każda:
+ *     0x80 | (n - 1)  n bajtów zerowych (bez zmian), n = 1..128
+ *     0x00 | (n - 1)  n bajtów XOR dosłownie
+ * Ramka kluczowa: XOR z pustym ekranem, maska = wszystkie strony. Odbiorca
+ * po luce w seq / numerze pakietu czeka na ramkę kluczową. Końcowe zera
+ * ramki są pomijane – reszta stron bez zmian.
+ */
+
+#define FB_MIRROR_KEY       0x80
+#define FB_MIRROR_END       0x40
+#define FB_MIRROR_IDX_MASK  0x3F
+#define FB_MIRROR_PKT_MIN   8       /* najmniejszy sensowny pakiet (MTU 23 daje 20) */
+#define FB_MIRROR_FULL      (SH1106_PAGES * SH1106_WIDTH)
+
+typedef struct {
+    uint8_t  ref[SH1106_PAGES][SH1106_WIDTH];  /* obraz u odbiorcy */
+    uint8_t  x[FB_MIRROR_FULL];     /* XOR ramki w trakcie wysyłania */
+    uint32_t min_frame_us;          /* 1 / maks. FPS kopii */
+    int64_t  last_frame_us;
+    uint16_t len, pos;              /* długość strumienia i pozycja kodera */
+    uint8_t  pending;               /* strony zmienione od ostatniej ramki */
+    uint8_t  mask;                  /* strony bieżącej ramki */
+    uint8_t  seq, pkt;
+    bool     active;                /* ramka w trakcie wysyłania */
+    bool     frame_key;             /* bieżąca ramka jest kluczowa */
+    bool     key;                   /* następna ramka kluczowa */
+    uint32_t frames, keys, bytes;   /* statystyki */
+} fb_mirror_t;
+
+void fb_mirror_init(fb_mirror_t *m, uint32_t min_frame_us);
+
+/* Przed sh1106_flush: strony zmienione w tej klatce. */
+static inline void fb_mirror_note(fb_mirror_t *m, uint8_t dirty) { m->pending |= dirty; }
+
+/* Nowy odbiorca albo zgubiony pakiet: przerywa ramkę, następna kluczowa. */
+void fb_mirror_key(fb_mirror_t *m);
+
+/* Zaczyna ramkę z bieżącego obrazu, jeśli poprzednia jest wysłana, minął
+ * odstęp maks. FPS i coś widocznie się zmieniło. */
+bool fb_mirror_begin(fb_mirror_t *m, const sh1106_fb_t *fb, int64_t now);
+
+/* Kolejny pakiet bieżącej ramki, cap >= FB_MIRROR_PKT_MIN.
+ * 0 = brak ramki w trakcie wysyłania. */
+size_t fb_mirror_next(fb_mirror_t *m, uint8_t *out, size_t cap);
+
+static inline bool fb_mirror_busy(const fb_mirror_t *m) { return m->active; }
+
+/* Transport dla fb_mirror_pump: true = pakiet zabrany (także stracony po
+ * drodze – wtedy transport woła fb_mirror_key), false = brak bufora. */
+typedef bool (*fb_mirror_send_t)(void *ctx, const uint8_t *pkt, size_t len);
+
+/* Wysyła pakiety bieżącej ramki, dopóki send je zabiera. Pakiet bez bufora
+ * zostaje w koderze i wychodzi przy następnym wywołaniu – nic nie ginie.
+ * true = ramka czeka na bufory: wołający musi wywołać pump ponownie
+ * (ponowienie z timera albo następna klatka), inaczej ramka utknie,
+ * a fb_mirror_begin nie zacznie następnej. buf >= cap >= FB_MIRROR_PKT_MIN. */
+bool fb_mirror_pump(fb_mirror_t *m, uint8_t *buf, size_t cap,
+                    fb_mirror_send_t send, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
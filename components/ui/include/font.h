@@ -0,0 +1,66 @@
+#pragma once
+#include <stdint.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Czcionka proporcjonalna 8 px z UTF-8 (ASCII + polskie litery).
+ *
+ * Atlas (font_atlas.c, generowany przez tools/gen_font.py) leży we flashu:
+ * tablica glifów posortowana po kodzie znaku i strumień danych, w którym
+ * glif jest kolumnami gotowymi do wpisania w stronę SH1106 – surowo albo
+ * jako RLE serii jednakowych kolumn, jeśli tak wychodzi krócej.
+ * Rozpakowane glify trzymamy w małej pamięci podręcznej LRU w RAM;
+ * ekran składa się z kilkunastu powtarzających się znaków, więc
+ * dekodowanie zdarza się rzadko.
+ */
+
+#define FONT_MAX_W      8
+#define FONT_CACHE      16
+#define FONT_FALLBACK   '?'
+
+typedef struct {
+    uint16_t cp;            /* punkt kodowy */
+    uint8_t  width;         /* z kolumną odstępu */
+    uint8_t  rle;
+    uint16_t off;           /* w font_atlas_t.data */
+} font_glyph_desc_t;
+
+typedef struct {
+    const font_glyph_desc_t *glyphs;
+    uint16_t                 count;
+    const uint8_t           *data;
+    uint16_t                 data_len;
+} font_atlas_t;
+
+typedef struct {
+    uint16_t cp;
+    uint8_t  width;
+    uint8_t  col[FONT_MAX_W];
+} font_glyph_t;
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+} font_stats_t;
+
+extern const font_atlas_t font_atlas;
+
+/* Kolejny punkt kodowy z *s, przesuwa *s. Błędna sekwencja daje
+ * FONT_FALLBACK i przeskakuje jeden bajt; koniec napisu daje 0. */
+uint32_t utf8_next(const char **s);
+
+/* Glif z pamięci podręcznej; nieznany znak daje FONT_FALLBACK. */
+const font_glyph_t *font_glyph(uint32_t cp);
+
+uint16_t font_text_width(const char *s);
+
+/* Rysuje napis w wierszu strony row[0..cap) od kolumny x (OR).
+ * Zwraca kolumnę za ostatnim narysowanym glifem. */
+uint16_t font_draw(uint8_t *row, uint16_t cap, uint16_t x, const char *s);
+
+void font_get_stats(font_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Tempo odświeżania ekranu.
+ *
+ * Pętla ekranu rysuje do ramki przy każdym przebudzeniu (impuls koła,
+ * enkoder, puls serca), a pacer decyduje, czy zabrudzone strony idą na
+ * magistralę: od razu, gdy minął odstęp maks. FPS, albo później, gdy
+ * zmiana przyszła za szybko. Bez zmian pętla śpi do pulsu serca. Po czasie
+ * bez aktywności (jazda, enkoder) panel jest przygaszany, potem wyłączany;
+ * aktywność przywraca go przy najbliższej klatce. Bez HAL-u – wołający
+ * wysyła komendy panelu przy zmianie stanu.
+ */
+
+typedef enum {
+    PANEL_ON = 0,
+    PANEL_DIM,
+    PANEL_OFF,
+} panel_state_t;
+
+typedef struct {
+    uint32_t min_frame_us;      /* 1 / maks. FPS */
+    uint32_t heartbeat_us;      /* najdłuższy sen bez zmian */
+    uint32_t dim_us;            /* bezczynność do przygaszenia, 0 = nigdy */
+    uint32_t off_us;            /* bezczynność do wyłączenia, 0 = nigdy */
+} pacer_cfg_t;
+
+typedef struct {
+    uint32_t wakeups;           /* decyzje pacera */
+    uint32_t frames;            /* ramki wysłane */
+    uint32_t pages;             /* strony wysłane */
+    uint32_t held;              /* zmiany odłożone przez limit FPS */
+    uint32_t bus_us;            /* czas wysyłania – dolicza wołający */
+} pacer_stats_t;
+
+typedef struct {
+    pacer_cfg_t   cfg;
+    int64_t       last_frame_us;
+    int64_t       last_active_us;
+    panel_state_t panel;
+    pacer_stats_t st;
+} frame_pacer_t;
+
+void pacer_init(frame_pacer_t *p, const pacer_cfg_t *cfg, int64_t now);
+
+/* active: jazda albo obsługa enkodera. Zwraca stan, w jakim ma być panel. */
+panel_state_t pacer_activity(frame_pacer_t *p, bool active, int64_t now);
+
+/* true = wyślij teraz strony z maski dirty (liczone jako klatka). */
+bool pacer_frame_due(frame_pacer_t *p, uint8_t dirty, int64_t now);
+
+/* Jak długo spać do następnej decyzji, jeśli nic nie obudzi wcześniej. */
+uint32_t pacer_sleep_us(const frame_pacer_t *p, uint8_t dirty, int64_t now);
+
+/* Statystyki od poprzedniego wywołania. */
+void pacer_take_stats(frame_pacer_t *p, pacer_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+#include "ui_widget.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Ekran jazdy licznika: układ widgetów i wartości, które rysują.
+ *
+ * Wspólny dla firmware'u i narzędzi na hoście (benchmark, symulator
+ * powtórek), więc powtórka przejazdu daje bajt w bajt te same klatki.
+ * Jeden ekran na program – wartości powiązane z widgetami są statyczne.
+ */
+
+#define RIDE_BAR_MAX_CKMH   6000    /* pełny pasek = 60 km/h */
+#define RIDE_ZOOM_COUNT     5
+
+typedef struct {
+    float    kmh;
+    uint32_t revs;          /* parzystość miga ikoną koła */
+    uint32_t odometer_m;
+    uint8_t  units;         /* 0 = km, 1 = mile */
+    uint8_t  zoom;          /* < RIDE_ZOOM_COUNT */
+} ride_view_t;
+
+void ride_screen_init(ui_screen_t *s, sh1106_fb_t *fb, const speed_hist_t *hist,
+                      int64_t (*now_us)(void));
+
+/* Przepisuje widok do wartości widgetów; rysuje dopiero ui_render(). */
+void ride_screen_set(const ride_view_t *v);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,21 @@
+#pragma once
+#include <stdint.h>
+#include "sh1106_fb.h"
+#include "speed_hist.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Wykres kolumn z speed_hist_query() w prostokącie ramki obrazu:
+ * kolumny x0 .. x0+ncols-1, strony page0 .. page0+pages-1. Każda kolumna
+ * to pionowy odcinek min..max rysowany maską na bajt strony; punkt
+ * średniej jest wygaszony, gdy odcinek ma co najmniej 3 piksele. */
+void speed_graph_plot(sh1106_fb_t *fb, uint8_t x0, uint8_t page0, uint8_t pages,
+                      const speed_bucket_t *col, uint16_t ncols, uint16_t vmax_ckmh);
+
+/* Zakres osi Y: maksimum z kolumn zaokrąglone w górę do 10 km/h. */
+uint16_t speed_graph_scale(const speed_bucket_t *col, uint16_t ncols);
+
+#ifdef __cplusplus
+}
+#endif
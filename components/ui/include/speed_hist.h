@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Historia prędkości o stałej pamięci z piramidą min/max/avg.
+ *
+ * Poziom 0 to pojedyncze próbki (wołający podaje je w stałym takcie,
+ * np. 1 Hz), kubełek poziomu k scala dwa kubełki poziomu k-1, czyli
+ * 2^k próbek. Każdy poziom trzyma ostatnie SPEED_HIST_BUCKETS kubełków
+ * w pierścieniu; rodzic powstaje w chwili domknięcia pary, więc koszt
+ * dodania próbki jest zamortyzowany O(1).
+ *
+ * Zapytanie o dowolny zakres wybiera najniższy poziom, w którym zakres
+ * mieści się w szerokości wykresu, i czyta co najwyżej tyle kubełków,
+ * ile jest kolumn. Niedomknięty kubełek na końcu składa się z ogonów
+ * niższych poziomów (najwyżej jeden kubełek na poziom).
+ */
+
+#define SPEED_HIST_LEVELS    12     /* 1 .. 2048 próbek na kubełek */
+#define SPEED_HIST_BUCKETS   136    /* >= szerokość wykresu */
+
+typedef struct {
+    uint16_t min;           /* 0.01 km/h; min > max = brak danych */
+    uint16_t max;
+    uint16_t avg;
+} speed_bucket_t;
+
+typedef struct {
+    speed_bucket_t ring[SPEED_HIST_LEVELS][SPEED_HIST_BUCKETS];
+    uint32_t count;         /* próbek od początku */
+} speed_hist_t;
+
+void speed_hist_reset(speed_hist_t *h);
+void speed_hist_push(speed_hist_t *h, uint16_t speed_ckmh);
+
+/* Ostatnie span próbek rozłożone na ncols kolumn (ncols <= SPEED_HIST_BUCKETS),
+ * najnowsza w out[ncols-1]. Kolumny sprzed początku historii są puste.
+ * Zwraca użyty poziom piramidy. */
+int speed_hist_query(const speed_hist_t *h, uint32_t span,
+                     speed_bucket_t *out, uint16_t ncols);
+
+#ifdef __cplusplus
+}
+#endif
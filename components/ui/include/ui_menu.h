@@ -0,0 +1,81 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "sh1106_fb.h"
+#include "ui_widget.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Hierarchiczne menu sterowane enkoderem.
+ *
+ * Strona 0 ekranu to tytuł, strony 1..7 to pozycje (przewijane).
+ * Obrót przesuwa zaznaczenie albo, w trybie edycji, zmienia wartość;
+ * przycisk wchodzi do podmenu, uruchamia akcję albo włącza/kończy edycję.
+ * Renderer pamięta, co stoi w każdym wierszu ekranu, i rysuje ponownie
+ * tylko wiersze, których tekst lub podświetlenie (negatyw) się zmieniły.
+ * Zmiana wartości trafia od razu do zmiennej i do on_change – utrwalenie
+ * zostawiamy wołającemu.
+ */
+
+#define MENU_DEPTH      4
+#define MENU_ROWS       (SH1106_PAGES - 1)
+
+typedef enum {
+    MENU_SUBMENU,
+    MENU_VALUE,     /* liczba uint16 w zakresie min..max co step */
+    MENU_CHOICE,    /* indeks uint8 w liście opcji */
+    MENU_ACTION,
+    MENU_BACK,      /* poziom wyżej; z korzenia zamyka menu */
+} menu_kind_t;
+
+struct menu_page;
+
+typedef struct {
+    const char *label;
+    menu_kind_t kind;
+    union {
+        const struct menu_page *sub;
+        struct { uint16_t *value; uint16_t min, max, step; const char *unit; } num;
+        struct { uint8_t *value; const char *const *options; uint8_t count; } choice;
+        void (*action)(void);
+    };
+} menu_item_t;
+
+typedef struct menu_page {
+    const char        *title;
+    const menu_item_t *items;
+    uint8_t            count;
+} menu_page_t;
+
+typedef struct {
+    const menu_page_t *page[MENU_DEPTH];
+    uint8_t  sel_at[MENU_DEPTH];        /* zaznaczenie na poziomach wyżej */
+    uint8_t  depth;
+    uint8_t  sel;
+    uint8_t  top;                       /* pierwsza widoczna pozycja */
+    bool     editing;
+    bool     open;
+    void   (*on_change)(const menu_item_t *it);
+
+    struct {
+        char text[UI_TEXT_MAX];
+        bool inverse;
+        bool valid;
+    } row[SH1106_PAGES];                /* co jest teraz na ekranie */
+    uint32_t rows_drawn;                /* licznik do profilowania */
+} ui_menu_t;
+
+void ui_menu_open(ui_menu_t *m, const menu_page_t *root,
+                  void (*on_change)(const menu_item_t *it));
+
+/* steps = detenty enkodera (ze znakiem), press = wciśnięcie przycisku.
+ * Zwraca false, gdy menu zostało zamknięte. */
+bool ui_menu_input(ui_menu_t *m, int steps, bool press);
+
+/* Rysuje zmienione wiersze; zwraca ich liczbę. */
+uint8_t ui_menu_render(ui_menu_t *m, sh1106_fb_t *fb);
+
+#ifdef __cplusplus
+}
+#endif
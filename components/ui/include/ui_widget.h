@@ -0,0 +1,91 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "sh1106_fb.h"
+#include "speed_hist.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Retained-mode widgety na siatce stron SH1106.
+ *
+ * Widget zna swój prostokąt (kolumny x..x+w-1, strony page..page+pages-1)
+ * i wskaźnik na powiązaną wartość. ui_render() porównuje wartość z tą
+ * ostatnio narysowaną i rysuje tylko zmienione widgety: najpierw cały
+ * wiersz strony w buforze, potem jeden blit słowami 32-bit do ramki.
+ * Każdy widget zbiera czas rysowania i pole, które zabrudził.
+ */
+
+#define UI_TEXT_MAX   33        /* bajty UTF-8 z NUL; wiersz to ~20 znaków */
+
+typedef enum {
+    UI_LABEL,       /* tekst UTF-8 czcionką proporcjonalną, jedna strona */
+    UI_NUMBER,      /* liczba stałoprzecinkowa, cyfry 16x16, dwie strony */
+    UI_BAR,         /* pasek 0..max, jedna strona */
+    UI_ICON,        /* bitmapa w x 8*pages, klatka wybierana wartością */
+    UI_GRAPH,       /* speed_hist w zadanym zakresie */
+} ui_kind_t;
+
+typedef struct {
+    uint8_t x, page, w, pages;
+} ui_rect_t;
+
+typedef struct {
+    uint32_t draws;
+    uint32_t last_us;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint16_t dirty_bytes;       /* bajty ramki przy ostatnim rysowaniu */
+} ui_widget_stats_t;
+
+typedef struct {
+    ui_kind_t   kind;
+    const char *name;
+    ui_rect_t   r;
+    bool        valid;          /* false = narysuj przy najbliższym ui_render() */
+    union {
+        struct { const char *text; char shown[UI_TEXT_MAX]; } label;
+        struct { const int32_t *value; uint8_t decimals; int32_t shown; } number;
+        struct { const int32_t *value; int32_t max; int32_t shown; } bar;
+        struct { const int32_t *value; const uint8_t *frames; int32_t shown; } icon;
+        struct { const speed_hist_t *hist; const uint32_t *span;
+                 uint32_t shown_count, shown_span; } graph;
+    };
+    ui_widget_stats_t stats;
+} ui_widget_t;
+
+#define UI_RECT(x_, page_, w_, pages_)  { .x = (x_), .page = (page_), .w = (w_), .pages = (pages_) }
+
+#define UI_LABEL_W(name_, x, page, w, text_) \
+    { .kind = UI_LABEL, .name = (name_), .r = UI_RECT(x, page, w, 1), .label = { .text = (text_) } }
+#define UI_NUMBER_W(name_, x, page, w, value_, decimals_) \
+    { .kind = UI_NUMBER, .name = (name_), .r = UI_RECT(x, page, w, 2), \
+      .number = { .value = (value_), .decimals = (decimals_) } }
+#define UI_BAR_W(name_, x, page, w, value_, max_) \
+    { .kind = UI_BAR, .name = (name_), .r = UI_RECT(x, page, w, 1), .bar = { .value = (value_), .max = (max_) } }
+#define UI_ICON_W(name_, x, page, w, pages, value_, frames_) \
+    { .kind = UI_ICON, .name = (name_), .r = UI_RECT(x, page, w, pages), \
+      .icon = { .value = (value_), .frames = (frames_) } }
+#define UI_GRAPH_W(name_, x, page, w, pages, hist_, span_) \
+    { .kind = UI_GRAPH, .name = (name_), .r = UI_RECT(x, page, w, pages), \
+      .graph = { .hist = (hist_), .span = (span_) } }
+
+typedef struct {
+    sh1106_fb_t  *fb;
+    ui_widget_t  *w;
+    uint8_t       count;
+    int64_t     (*now_us)(void);    /* NULL = bez pomiaru czasu */
+} ui_screen_t;
+
+void ui_screen_init(ui_screen_t *s, sh1106_fb_t *fb, ui_widget_t *w, uint8_t count,
+                    int64_t (*now_us)(void));
+
+/* Wymusza narysowanie wszystkich widgetów (np. po zmianie ekranu). */
+void ui_invalidate(ui_screen_t *s);
+
+/* Rysuje zmienione widgety. Zwraca liczbę zabrudzonych bajtów ramki. */
+uint32_t ui_render(ui_screen_t *s);
+
+#ifdef __cplusplus
+}
+#endif
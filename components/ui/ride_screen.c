@@ -0,0 +1,54 @@
+#include <stdio.h>
+#include "ride_screen.h"
+
+/* zakres wykresu w sekundach; 0 = cały przejazd */
+static const struct { uint32_t span_s; const char *label; } zooms[RIDE_ZOOM_COUNT] = {
+    { 60, "1m" }, { 300, "5m" }, { 1800, "30m" }, { 3600, "1h" }, { 0, "all" },
+};
+
+/* wartości powiązane z widgetami */
+static int32_t  speed_dkmh;         /* 0.1 km/h */
+static int32_t  speed_ckmh;
+static int32_t  wheel_phase;        /* klatka ikony, miga z obrotem koła */
+static char     odo[UI_TEXT_MAX];
+static uint32_t span_s;
+
+static const uint8_t wheel_icon[2][8] = {
+    { 0x3C, 0x42, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3C },
+    { 0x3C, 0x7E, 0xFF, 0xFF, 0xFF, 0xFF, 0x7E, 0x3C },
+};
+
+/* widoczne 128 z 132 kolumn RAM zaczyna się od kolumny 2 */
+static ui_widget_t widgets[] = {
+    UI_NUMBER_W("speed", 2,   0, 80,  &speed_dkmh, 1),
+    UI_LABEL_W ("unit",  90,  1, 32,  "km/h"),
+    UI_ICON_W  ("wheel", 122, 0, 8, 1, &wheel_phase, &wheel_icon[0][0]),
+    UI_LABEL_W ("odo",   2,   2, 128, odo),
+    UI_BAR_W   ("bar",   2,   3, 80,  &speed_ckmh, RIDE_BAR_MAX_CKMH),
+    UI_LABEL_W ("zoom",  90,  3, 40,  ""),
+    UI_GRAPH_W ("graph", 2,   4, 128, 4, NULL, &span_s),
+};
+#define WIDGET_COUNT (sizeof(widgets) / sizeof(widgets[0]))
+#define W_UNIT  1
+#define W_ZOOM  5
+#define W_GRAPH 6
+
+void ride_screen_init(ui_screen_t *s, sh1106_fb_t *fb, const speed_hist_t *hist,
+                      int64_t (*now_us)(void))
+{
+    widgets[W_GRAPH].graph.hist = hist;
+    ui_screen_init(s, fb, widgets, WIDGET_COUNT, now_us);
+}
+
+void ride_screen_set(const ride_view_t *v)
+{
+    float k = v->units ? 0.621371f : 1.0f;
+    speed_dkmh = (int32_t)(v->kmh * k * 10.0f + 0.5f);
+    speed_ckmh = (int32_t)(v->kmh * 100.0f);
+    wheel_phase = v->revs & 1;
+    snprintf(odo, sizeof(odo), "ODO %9.1f %s",
+             v->odometer_m * k / 1000.0f, v->units ? "mi" : "km");
+    span_s = zooms[v->zoom].span_s;
+    widgets[W_UNIT].label.text = v->units ? "mph" : "km/h";
+    widgets[W_ZOOM].label.text = zooms[v->zoom].label;
+}
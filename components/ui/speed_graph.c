@@ -0,0 +1,50 @@
+#include "speed_graph.h"
+
+#define SCALE_STEP   1000   /* 10 km/h */
+
+static uint8_t y_of(uint16_t v, uint16_t vmax, uint8_t bottom, uint8_t h)
+{
+    if (v > vmax) v = vmax;
+    return bottom - (uint8_t)((uint32_t)v * (h - 1) / vmax);
+}
+
+uint16_t speed_graph_scale(const speed_bucket_t *col, uint16_t ncols)
+{
+    uint16_t vmax = 0;
+    for (uint16_t c = 0; c < ncols; c++)
+        if (col[c].min <= col[c].max && col[c].max > vmax) vmax = col[c].max;
+
+    uint32_t r = ((uint32_t)vmax / SCALE_STEP + 1) * SCALE_STEP;
+    return r > 0xFFFF ? 0xFFFF : (uint16_t)r;
+}
+
+void speed_graph_plot(sh1106_fb_t *fb, uint8_t x0, uint8_t page0, uint8_t pages,
+                      const speed_bucket_t *col, uint16_t ncols, uint16_t vmax_ckmh)
+{
+    if (page0 >= SH1106_PAGES || pages == 0) return;
+    if (page0 + pages > SH1106_PAGES) pages = SH1106_PAGES - page0;
+    if (x0 + ncols > SH1106_WIDTH) ncols = SH1106_WIDTH - x0;
+    if (vmax_ckmh == 0) vmax_ckmh = SCALE_STEP;
+
+    uint8_t top = page0 * 8;
+    uint8_t h = pages * 8;                  /* wysokość w pikselach */
+    uint8_t bottom = top + h - 1;
+
+    for (uint8_t p = page0; p < page0 + pages; p++) {
+        for (uint16_t c = 0; c < ncols; c++) fb->page[p][x0 + c] = 0;
+        fb->dirty |= 1u << p;
+    }
+
+    for (uint16_t c = 0; c < ncols; c++) {
+        const speed_bucket_t *b = &col[c];
+        if (b->min > b->max) continue;
+
+        uint8_t y_lo  = y_of(b->min, vmax_ckmh, bottom, h);
+        uint8_t y_hi  = y_of(b->max, vmax_ckmh, bottom, h);
+        uint8_t y_avg = y_of(b->avg, vmax_ckmh, bottom, h);
+
+        sh1106_fb_vline(fb, x0 + c, y_hi, y_lo, true);
+        if (y_lo - y_hi >= 2 && y_avg > y_hi && y_avg < y_lo)
+            sh1106_fb_vline(fb, x0 + c, y_avg, y_avg, false);
+    }
+}
@@ -0,0 +1,87 @@
+#include <stdbool.h>
+#include <string.h>
+#include "speed_hist.h"
+
+static const speed_bucket_t EMPTY = { .min = 0xFFFF, .max = 0, .avg = 0 };
+
+void speed_hist_reset(speed_hist_t *h)
+{
+    memset(h, 0, sizeof(*h));
+}
+
+static speed_bucket_t merge(const speed_bucket_t *a, const speed_bucket_t *b)
+{
+    speed_bucket_t r = {
+        .min = a->min < b->min ? a->min : b->min,
+        .max = a->max > b->max ? a->max : b->max,
+        .avg = (uint16_t)(((uint32_t)a->avg + b->avg + 1) / 2),
+    };
+    return r;
+}
+
+void speed_hist_push(speed_hist_t *h, uint16_t speed_ckmh)
+{
+    uint32_t idx = h->count++;
+    speed_bucket_t *b = &h->ring[0][idx % SPEED_HIST_BUCKETS];
+
+    b->min = b->max = b->avg = speed_ckmh;
+
+    /* domknięta para -> kubełek poziom wyżej */
+    for (int k = 0; k + 1 < SPEED_HIST_LEVELS && (idx & 1); k++) {
+        const speed_bucket_t *ring = h->ring[k];
+        h->ring[k + 1][(idx >> 1) % SPEED_HIST_BUCKETS] =
+            merge(&ring[(idx - 1) % SPEED_HIST_BUCKETS], &ring[idx % SPEED_HIST_BUCKETS]);
+        idx >>= 1;
+    }
+}
+
+/* Próbki po ostatnim pełnym kubełku poziomu lvl, złożone z ogonów niższych poziomów. */
+static speed_bucket_t partial(const speed_hist_t *h, int lvl)
+{
+    speed_bucket_t r = EMPTY;
+    uint32_t sum = 0, n = 0;
+
+    for (int k = 0; k < lvl; k++) {
+        if (!(h->count & (1u << k))) continue;
+        const speed_bucket_t *b = &h->ring[k][((h->count >> k) - 1) % SPEED_HIST_BUCKETS];
+        if (b->min < r.min) r.min = b->min;
+        if (b->max > r.max) r.max = b->max;
+        sum += (uint32_t)b->avg << k;
+        n += 1u << k;
+    }
+    if (n) r.avg = (uint16_t)((sum + n / 2) / n);
+    return r;
+}
+
+int speed_hist_query(const speed_hist_t *h, uint32_t span,
+                     speed_bucket_t *out, uint16_t ncols)
+{
+    if (ncols == 0) return 0;
+    if (ncols > SPEED_HIST_BUCKETS) ncols = SPEED_HIST_BUCKETS;
+    if (span == 0) span = 1;
+
+    int lvl = 0;
+    while (lvl + 1 < SPEED_HIST_LEVELS && ((span - 1) >> lvl) + 1 > ncols) lvl++;
+
+    uint32_t nb = ((span - 1) >> lvl) + 1;          /* kubełków w oknie */
+    if (nb > ncols) nb = ncols;                     /* ponad zasięg najwyższego poziomu */
+
+    uint32_t full = h->count >> lvl;
+    bool has_tail = (h->count & ((1u << lvl) - 1)) != 0;
+    speed_bucket_t tail = has_tail ? partial(h, lvl) : EMPTY;
+
+    /* kolumna -> kubełek liczony od najnowszego; przy nb < ncols kolumny się powtarzają */
+    for (uint16_t c = 0; c < ncols; c++) {
+        uint32_t j = (uint32_t)(ncols - 1 - c) * nb / ncols;
+
+        if (has_tail) {
+            if (j == 0) { out[c] = tail; continue; }
+            j--;
+        }
+        if (j < full && j < SPEED_HIST_BUCKETS)
+            out[c] = h->ring[lvl][(full - 1 - j) % SPEED_HIST_BUCKETS];
+        else
+            out[c] = EMPTY;
+    }
+    return lvl;
+}
@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <string.h>
+#include "ui_menu.h"
+#include "font.h"
+
+#define ROW_X       2           /* widoczne 128 z 132 kolumn RAM */
+#define ROW_W       128
+
+static const menu_page_t *cur(const ui_menu_t *m) { return m->page[m->depth]; }
+
+static void invalidate(ui_menu_t *m)
+{
+    for (int i = 0; i < SH1106_PAGES; i++) m->row[i].valid = false;
+}
+
+void ui_menu_open(ui_menu_t *m, const menu_page_t *root,
+                  void (*on_change)(const menu_item_t *it))
+{
+    memset(m, 0, sizeof(*m));
+    m->page[0] = root;
+    m->on_change = on_change;
+    m->open = true;
+}
+
+/* ---------- wejście ---------- */
+static void scroll_to_sel(ui_menu_t *m)
+{
+    if (m->sel < m->top) m->top = m->sel;
+    if (m->sel >= m->top + MENU_ROWS) m->top = m->sel - MENU_ROWS + 1;
+}
+
+static void edit(ui_menu_t *m, const menu_item_t *it, int steps)
+{
+    if (it->kind == MENU_VALUE) {
+        int32_t v = *it->num.value + steps * it->num.step;
+        if (v < it->num.min) v = it->num.min;
+        if (v > it->num.max) v = it->num.max;
+        if (v == *it->num.value) return;
+        *it->num.value = (uint16_t)v;
+    } else {
+        int n = it->choice.count;
+        *it->choice.value = (uint8_t)(((*it->choice.value + steps) % n + n) % n);
+    }
+    if (m->on_change) m->on_change(it);
+}
+
+static void leave(ui_menu_t *m)
+{
+    if (m->depth == 0) {
+        m->open = false;
+        return;
+    }
+    m->depth--;
+    m->sel = m->sel_at[m->depth];
+    m->top = 0;
+    scroll_to_sel(m);
+}
+
+bool ui_menu_input(ui_menu_t *m, int steps, bool press)
+{
+    if (!m->open) return false;
+    const menu_item_t *it = &cur(m)->items[m->sel];
+
+    if (steps) {
+        if (m->editing) {
+            edit(m, it, steps);
+        } else {
+            int n = cur(m)->count;
+            m->sel = (uint8_t)(((m->sel + steps) % n + n) % n);
+            scroll_to_sel(m);
+        }
+    }
+    if (!press) return true;
+
+    it = &cur(m)->items[m->sel];
+    switch (it->kind) {
+    case MENU_SUBMENU:
+        if (m->depth + 1 < MENU_DEPTH) {
+            m->sel_at[m->depth++] = m->sel;
+            m->page[m->depth] = it->sub;
+            m->sel = m->top = 0;
+        }
+        break;
+    case MENU_VALUE:
+    case MENU_CHOICE:
+        m->editing = !m->editing;
+        break;
+    case MENU_ACTION:
+        it->action();
+        if (m->on_change) m->on_change(it);
+        break;
+    case MENU_BACK:
+        leave(m);
+        break;
+    }
+    return m->open;
+}
+
+/* ---------- rysowanie ---------- */
+static void format_row(const ui_menu_t *m, const menu_item_t *it, bool sel, char *out)
+{
+    /* wiersz = etykieta + \t + wartość w UI_TEXT_MAX; wartość ma
+     * pierwszeństwo, więc ucinana jest etykieta (zawsze zostaje \t) */
+    char val[UI_TEXT_MAX - 1] = "";
+
+    switch (it->kind) {
+    case MENU_SUBMENU: strcpy(val, ">"); break;
+    case MENU_VALUE:
+        snprintf(val, sizeof(val), "%u%s", *it->num.value, it->num.unit ? it->num.unit : "");
+        break;
+    case MENU_CHOICE:
+        snprintf(val, sizeof(val), "%s", it->choice.options[*it->choice.value]);
+        break;
+    default: break;
+    }
+    if (sel && m->editing) {
+        char tmp[sizeof(val)];
+        snprintf(tmp, sizeof(tmp), "<%.*s>", (int)sizeof(tmp) - 3, val);
+        strcpy(val, tmp);
+    }
+
+    /* etykieta i wartość rozdzielone tabulatorem, układa je draw_row() */
+    size_t vl = strlen(val);
+    size_t ll = strnlen(it->label, UI_TEXT_MAX - 2 - vl);
+    memcpy(out, it->label, ll);
+    out[ll] = '\t';
+    memcpy(out + ll + 1, val, vl + 1);
+}
+
+static void draw_row(ui_menu_t *m, sh1106_fb_t *fb, uint8_t page, const char *text, bool inverse)
+{
+    if (m->row[page].valid && m->row[page].inverse == inverse &&
+        strcmp(m->row[page].text, text) == 0)
+        return;
+
+    uint8_t buf[ROW_W] = { 0 };
+    char label[UI_TEXT_MAX];
+    const char *val = strchr(text, '\t');
+
+    /* etykieta do lewej, wartość do prawej; wartość ma pierwszeństwo */
+    snprintf(label, sizeof(label), "%.*s", val ? (int)(val - text) : UI_TEXT_MAX - 1, text);
+    if (val) {
+        val++;
+        uint16_t vw = font_text_width(val);
+        uint16_t vx = vw < ROW_W ? ROW_W - vw : 0;
+        font_draw(buf, ROW_W, vx, val);
+        font_draw(buf, vx, 0, label);
+    } else {
+        font_draw(buf, ROW_W, 0, label);
+    }
+    sh1106_fb_blit(fb, ROW_X, page, buf, ROW_W, inverse ? 0xFF : 0x00);
+
+    strcpy(m->row[page].text, text);
+    m->row[page].inverse = inverse;
+    m->row[page].valid = true;
+    m->rows_drawn++;
+}
+
+uint8_t ui_menu_render(ui_menu_t *m, sh1106_fb_t *fb)
+{
+    uint32_t before = m->rows_drawn;
+    const menu_page_t *p = cur(m);
+    char text[UI_TEXT_MAX];
+
+    if (!m->open) {
+        invalidate(m);      /* po powrocie ekran jazdy zamaże wszystko */
+        return 0;
+    }
+
+    snprintf(text, sizeof(text), "%s", p->title);
+    draw_row(m, fb, 0, text, false);
+
+    for (uint8_t r = 0; r < MENU_ROWS; r++) {
+        uint8_t i = m->top + r;
+        if (i < p->count) {
+            format_row(m, &p->items[i], i == m->sel, text);
+            draw_row(m, fb, r + 1, text, i == m->sel);
+        } else {
+            draw_row(m, fb, r + 1, "", false);
+        }
+    }
+    return (uint8_t)(m->rows_drawn - before);
+}
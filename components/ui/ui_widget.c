@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <string.h>
+#include "ui_widget.h"
+#include "speed_graph.h"
+#include "font.h"
+
+/* ---------- duże cyfry ---------- */
+/* 8x8 skalowane 2x przy starcie: kolumna 8 px -> dwie kolumny po 16 px */
+#define BIG_CHARS   "0123456789.- "
+#define BIG_COUNT   (sizeof(BIG_CHARS) - 1)
+#define BIG_W       16
+
+static uint8_t big[BIG_COUNT][2][BIG_W];      /* [znak][strona][kolumna] */
+static bool    big_ready;
+
+static void big_init(void)
+{
+    for (unsigned i = 0; i < BIG_COUNT; i++) {
+        const uint8_t *g = sh1106_font8x8(BIG_CHARS[i]);
+        for (int col = 0; col < 8; col++) {
+            uint16_t v = 0;
+            for (int bit = 0; bit < 8; bit++)
+                if (g[col] & (1u << bit)) v |= 3u << (2 * bit);
+            big[i][0][2 * col] = big[i][0][2 * col + 1] = (uint8_t)v;
+            big[i][1][2 * col] = big[i][1][2 * col + 1] = (uint8_t)(v >> 8);
+        }
+    }
+    big_ready = true;
+}
+
+static const uint8_t *big_glyph(char c, int page)
+{
+    const char *p = c ? strchr(BIG_CHARS, c) : NULL;
+    size_t i = p ? (size_t)(p - BIG_CHARS) : BIG_COUNT - 1;
+    return big[i][page];
+}
+
+/* ---------- rysowanie ---------- */
+static void draw_label(sh1106_fb_t *fb, ui_widget_t *w)
+{
+    uint8_t row[SH1106_WIDTH] = { 0 };
+
+    font_draw(row, w->r.w, 0, w->label.text);
+    sh1106_fb_blit(fb, w->r.x, w->r.page, row, w->r.w, 0);
+
+    strncpy(w->label.shown, w->label.text, UI_TEXT_MAX - 1);
+    w->label.shown[UI_TEXT_MAX - 1] = '\0';
+}
+
+static void draw_number(sh1106_fb_t *fb, ui_widget_t *w)
+{
+    char txt[12];
+    int32_t v = *w->number.value;
+    uint32_t a = v < 0 ? -(uint32_t)v : (uint32_t)v;
+    uint32_t div = 1;
+
+    for (uint8_t i = 0; i < w->number.decimals; i++) div *= 10;
+    int n = w->number.decimals
+          ? snprintf(txt, sizeof(txt), "%s%lu.%0*lu", v < 0 ? "-" : "",
+                     (unsigned long)(a / div), w->number.decimals, (unsigned long)(a % div))
+          : snprintf(txt, sizeof(txt), "%ld", (long)v);
+
+    /* do prawej krawędzi; co się nie mieści, odpada z lewej */
+    for (int page = 0; page < 2; page++) {
+        uint8_t row[SH1106_WIDTH] = { 0 };
+        int x = w->r.w - n * BIG_W;
+        for (int i = 0; i < n; i++, x += BIG_W)
+            if (x >= 0) memcpy(&row[x], big_glyph(txt[i], page), BIG_W);
+        sh1106_fb_blit(fb, w->r.x, w->r.page + page, row, w->r.w, 0);
+    }
+    w->number.shown = v;
+}
+
+static void draw_bar(sh1106_fb_t *fb, ui_widget_t *w)
+{
+    uint8_t row[SH1106_WIDTH];
+    int32_t v = *w->bar.value;
+    uint8_t inner = w->r.w - 2;
+    uint32_t fill = v <= 0 || w->bar.max <= 0 ? 0
+                  : v >= w->bar.max ? inner : (uint32_t)v * inner / w->bar.max;
+
+    /* ramka: pełne boki, góra i dół jako piksele 1 i 6 */
+    row[0] = row[w->r.w - 1] = 0x7E;
+    memset(&row[1], 0x7E, fill);
+    memset(&row[1 + fill], 0x42, inner - fill);
+    sh1106_fb_blit(fb, w->r.x, w->r.page, row, w->r.w, 0);
+    w->bar.shown = v;
+}
+
+static void draw_icon(sh1106_fb_t *fb, ui_widget_t *w)
+{
+    int32_t v = *w->icon.value;
+    const uint8_t *f = w->icon.frames + (size_t)v * w->r.w * w->r.pages;
+
+    for (uint8_t p = 0; p < w->r.pages; p++)
+        sh1106_fb_blit(fb, w->r.x, w->r.page + p, f + p * w->r.w, w->r.w, 0);
+    w->icon.shown = v;
+}
+
+static void draw_graph(sh1106_fb_t *fb, ui_widget_t *w)
+{
+    speed_bucket_t cols[SH1106_WIDTH];
+    const speed_hist_t *h = w->graph.hist;
+    uint32_t span = *w->graph.span ? *w->graph.span : h->count;
+
+    speed_hist_query(h, span, cols, w->r.w);
+    speed_graph_plot(fb, w->r.x, w->r.page, w->r.pages, cols, w->r.w,
+                     speed_graph_scale(cols, w->r.w));
+    w->graph.shown_count = h->count;
+    w->graph.shown_span = *w->graph.span;
+}
+
+static bool changed(const ui_widget_t *w)
+{
+    if (!w->valid) return true;
+
+    switch (w->kind) {
+    case UI_LABEL:  return strncmp(w->label.text, w->label.shown, UI_TEXT_MAX - 1) != 0;
+    case UI_NUMBER: return *w->number.value != w->number.shown;
+    case UI_BAR:    return *w->bar.value != w->bar.shown;
+    case UI_ICON:   return *w->icon.value != w->icon.shown;
+    case UI_GRAPH:  return w->graph.hist->count != w->graph.shown_count ||
+                           *w->graph.span != w->graph.shown_span;
+    }
+    return false;
+}
+
+/* ---------- ekran ---------- */
+void ui_screen_init(ui_screen_t *s, sh1106_fb_t *fb, ui_widget_t *w, uint8_t count,
+                    int64_t (*now_us)(void))
+{
+    if (!big_ready) big_init();
+    s->fb = fb;
+    s->w = w;
+    s->count = count;
+    s->now_us = now_us;
+    ui_invalidate(s);
+}
+
+void ui_invalidate(ui_screen_t *s)
+{
+    for (uint8_t i = 0; i < s->count; i++) s->w[i].valid = false;
+}
+
+uint32_t ui_render(ui_screen_t *s)
+{
+    uint32_t dirty = 0;
+
+    for (uint8_t i = 0; i < s->count; i++) {
+        ui_widget_t *w = &s->w[i];
+        if (!changed(w)) continue;
+
+        int64_t t0 = s->now_us ? s->now_us() : 0;
+        switch (w->kind) {
+        case UI_LABEL:  draw_label(s->fb, w);  break;
+        case UI_NUMBER: draw_number(s->fb, w); break;
+        case UI_BAR:    draw_bar(s->fb, w);    break;
+        case UI_ICON:   draw_icon(s->fb, w);   break;
+        case UI_GRAPH:  draw_graph(s->fb, w);  break;
+        }
+        w->valid = true;
+
+        ui_widget_stats_t *st = &w->stats;
+        uint32_t us = s->now_us ? (uint32_t)(s->now_us() - t0) : 0;
+        st->draws++;
+        st->last_us = us;
+        st->total_us += us;
+        if (us > st->max_us) st->max_us = us;
+        st->dirty_bytes = w->r.w * w->r.pages;
+        dirty += st->dirty_bytes;
+    }
+    return dirty;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "state_snap.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Czujnik koła: filtr impulsów, prędkość i liczniki przejazdu.
+ *
+ * Bez HAL-u – ten sam kod liczy w ISR licznika i w symulatorze na hoście
+ * (host/replay.c), który odtwarza zapisane znaczniki czasu impulsów.
+ */
+
+#define WHEEL_DEBOUNCE_US   20000       /* drgania kontaktronu */
+#define WHEEL_STOP_US       3000000     /* brak impulsu = postój */
+
+typedef struct {
+    int64_t  last_us;       /* ostatni przyjęty impuls */
+    int64_t  period_us;     /* odstęp dwóch ostatnich przyjętych */
+    uint32_t revs;
+    uint32_t bounces;       /* impulsy odrzucone przez filtr */
+} wheel_t;
+
+/* Impuls z czujnika. Zwraca odstęp od poprzedniego przyjętego impulsu
+ * albo 0, gdy impuls to drganie styku. Pierwszy impuls po postoju tylko
+ * wznawia pomiar: odstęp to czas stania, nie obrót, więc okres = 0 i
+ * prędkość zostaje 0 do następnego impulsu. Inline, bo woła go ISR z IRAM. */
+static inline int64_t wheel_pulse(wheel_t *w, int64_t now)
+{
+    int64_t dt = now - w->last_us;
+    if (dt < WHEEL_DEBOUNCE_US) {
+        w->bounces++;
+        return 0;
+    }
+    w->period_us = dt > WHEEL_STOP_US ? 0 : dt;
+    w->last_us = now;
+    w->revs++;
+    return dt;
+}
+
+/* km/h z ostatniego okresu; 0 po WHEEL_STOP_US bez impulsu. */
+float wheel_speed_kmh(int64_t period_us, int64_t last_us, int64_t now, uint16_t wheel_mm);
+
+/* Przyrosty licznika i przejazdu między kolejnymi klatkami. */
+typedef struct {
+    uint32_t revs_seen;
+    uint32_t mm_frac;       /* reszta poniżej metra */
+    uint32_t trip_us;       /* reszta czasu jazdy poniżej sekundy */
+    int64_t  prev_us;
+} wheel_trip_t;
+
+void wheel_trip_init(wheel_trip_t *t, uint32_t revs, int64_t now);
+void wheel_trip_update(wheel_trip_t *t, state_snap_t *s, uint32_t revs, float kmh, int64_t now);
+
+#ifdef __cplusplus
+}
+#endif
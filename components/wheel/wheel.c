@@ -0,0 +1,34 @@
+#include "wheel.h"
+
+float wheel_speed_kmh(int64_t period_us, int64_t last_us, int64_t now, uint16_t wheel_mm)
+{
+    if (period_us <= 0 || now - last_us > WHEEL_STOP_US) return 0.0f;
+    return (float)wheel_mm / period_us * 3600.0f;       /* mm/us -> km/h */
+}
+
+void wheel_trip_init(wheel_trip_t *t, uint32_t revs, int64_t now)
+{
+    t->revs_seen = revs;
+    t->mm_frac = 0;
+    t->trip_us = 0;
+    t->prev_us = now;
+}
+
+void wheel_trip_update(wheel_trip_t *t, state_snap_t *s, uint32_t revs, float kmh, int64_t now)
+{
+    /* dystans w mm, żeby nie gubić ułamków metra */
+    uint32_t mm = (revs - t->revs_seen) * s->wheel_mm + t->mm_frac;
+    t->revs_seen = revs;
+    t->mm_frac = mm % 1000;
+    s->odometer_m += mm / 1000;
+    s->trip_dist_m += mm / 1000;
+    if (kmh * 100.0f > s->trip_max_ckmh) s->trip_max_ckmh = (uint16_t)(kmh * 100.0f);
+
+    /* pętla budzi się też od enkodera, więc liczymy rzeczywisty czas */
+    if (kmh > 0.0f) {
+        t->trip_us += (uint32_t)(now - t->prev_us);
+        s->trip_time_s += t->trip_us / 1000000;
+        t->trip_us %= 1000000;
+    }
+    t->prev_us = now;
+}
@@ -0,0 +1,455 @@
+/* Mikrobenchmarki gorących ścieżek na hoście: ns/op i bajty, które dana
+ * operacja wysyła dalej (magistrala wyświetlacza, radio, flash).
+ * Liczby z PC nie przenoszą się 1:1 na ESP32 – służą do porównań między
+ * wersjami; bajty na magistrali są dokładne. Opcjonalny argument to plik
+ * próbek z `replay -R` – kodek telemetrii mierzony jest wtedy też na nim. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sh1106_fb.h"
+#include "font.h"
+#include "speed_hist.h"
+#include "speed_graph.h"
+#include "ui_widget.h"
+#include "ui_menu.h"
+#include "ride_screen.h"
+#include "fb_mirror.h"
+#include "telem_codec.h"
+#include "ride_log.h"
+#include "ride_reader.h"
+#include "ride_export.h"
+#include "flash_port_file.h"
+#include "ble_core.h"
+#include "ble_fake_host.h"
+
+/* sh1106_bus_page: I2C = adres + 3 x (ctrl, komenda) + ctrl danych + strona,
+ * SPI = 3 komendy adresu + strona */
+#define I2C_PAGE_BYTES  (1 + 6 + 1 + SH1106_WIDTH)
+#define SPI_PAGE_BYTES  (3 + SH1106_WIDTH)
+/* ATT notify: nagłówek L2CAP 4 + opcode 1 + uchwyt 2 */
+#define ATT_NOTIFY_OVERHEAD 7
+
+static double now_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static volatile uint32_t sink;      /* żeby kompilator nie wyrzucił pętli */
+
+static void report(const char *name, double ns, double bytes, const char *unit)
+{
+    if (unit)
+        printf("%-30s %10.1f ns/op %10.1f %s/op\n", name, ns, bytes, unit);
+    else
+        printf("%-30s %10.1f ns/op\n", name, ns);
+}
+
+/* strony wysłane przez flush (zabrudzone) i ich wyczyszczenie */
+static unsigned take_dirty(sh1106_fb_t *fb)
+{
+    unsigned n = __builtin_popcount(fb->dirty);
+    fb->dirty = 0;
+    return n;
+}
+
+/* ---------- ekran jazdy ---------- */
+static sh1106_fb_t  fb;
+static speed_hist_t hist;
+
+static void bench_screen(void)
+{
+    enum { N = 20000 };
+    ui_screen_t scr;
+    unsigned pages = 0;
+
+    speed_hist_reset(&hist);
+    for (int i = 0; i < 4000; i++) speed_hist_push(&hist, (uint16_t)(2000 + (i * 37) % 1500));
+    ride_screen_init(&scr, &fb, &hist, NULL);
+    ride_view_t v = { 25.0f, 0, 1234567, 0, 1 };
+    ride_screen_set(&v);
+
+    double t0 = now_ns();
+    for (int i = 0; i < N; i++) {
+        ui_invalidate(&scr);
+        sink += ui_render(&scr);
+        pages += take_dirty(&fb);
+    }
+    double ns = (now_ns() - t0) / N;
+    report("ui_render full (I2C)", ns, (double)pages / N * I2C_PAGE_BYTES, "B bus");
+    report("ui_render full (SPI)", ns, (double)pages / N * SPI_PAGE_BYTES, "B bus");
+
+    /* typowa klatka w jeździe: zmienia się tylko prędkość (i pasek) */
+    pages = 0;
+    t0 = now_ns();
+    for (int i = 0; i < N; i++) {
+        v.kmh = 20.0f + (i % 150) * 0.1f;
+        ride_screen_set(&v);
+        sink += ui_render(&scr);
+        pages += take_dirty(&fb);
+    }
+    ns = (now_ns() - t0) / N;
+    report("ui_render speed only (I2C)", ns, (double)pages / N * I2C_PAGE_BYTES, "B bus");
+
+    /* nic się nie zmieniło – sam koszt porównań */
+    pages = 0;
+    t0 = now_ns();
+    for (int i = 0; i < N; i++) {
+        ride_screen_set(&v);
+        sink += ui_render(&scr);
+        pages += take_dirty(&fb);
+    }
+    report("ui_render idle", (now_ns() - t0) / N, (double)pages / N * I2C_PAGE_BYTES, "B bus");
+}
+
+/* ---------- kopia ekranu przez BLE ---------- */
+static fb_mirror_t mirror;
+
+/* bajty w powietrzu za jedną ramkę kopii przy MTU 247 */
+static unsigned mirror_frame(int64_t t)
+{
+    uint8_t pkt[244];
+    unsigned bytes = 0;
+    size_t n;
+
+    fb_mirror_note(&mirror, fb.dirty);
+    fb.dirty = 0;
+    if (!fb_mirror_begin(&mirror, &fb, t)) return 0;
+    while ((n = fb_mirror_next(&mirror, pkt, sizeof(pkt))) > 0) bytes += n + ATT_NOTIFY_OVERHEAD;
+    return bytes;
+}
+
+static void bench_mirror(void)
+{
+    enum { N = 20000 };
+    ui_screen_t scr;
+    uint64_t bytes = 0;
+
+    ride_screen_init(&scr, &fb, &hist, NULL);      /* historia z bench_screen */
+    ride_view_t v = { 25.0f, 0, 1234567, 0, 1 };
+    ride_screen_set(&v);
+    ui_invalidate(&scr);
+    ui_render(&scr);
+    fb_mirror_init(&mirror, 0);
+
+    /* ramka kluczowa: cały ekran (nowy odbiorca, zrzut ekranu) */
+    double t0 = now_ns();
+    for (int i = 0; i < N; i++) {
+        fb_mirror_key(&mirror);
+        bytes += mirror_frame(i);
+    }
+    report("fb_mirror key frame", (now_ns() - t0) / N, (double)bytes / N, "B air");
+
+    /* zmienia się tylko prędkość – XOR z poprzednią ramką, RLE */
+    bytes = 0;
+    t0 = now_ns();
+    for (int i = 0; i < N; i++) {
+        v.kmh = 20.0f + (i % 150) * 0.1f;
+        ride_screen_set(&v);
+        sink += ui_render(&scr);
+        bytes += mirror_frame(N + i);
+    }
+    report("fb_mirror speed only", (now_ns() - t0) / N, (double)bytes / N, "B air");
+}
+
+/* ---------- historia i wykres ---------- */
+static void bench_hist(void)
+{
+    enum { N = 1000000, Q = 20000 };
+    speed_bucket_t col[SPEED_HIST_BUCKETS];
+
+    speed_hist_reset(&hist);
+    double t0 = now_ns();
+    for (int i = 0; i < N; i++) speed_hist_push(&hist, (uint16_t)(i * 7 % 5000));
+    report("speed_hist_push", (now_ns() - t0) / N, 0, NULL);
+
+    t0 = now_ns();
+    for (int i = 0; i < Q; i++)
+        sink += speed_hist_query(&hist, 3600 + i % 60, col, 128);
+    report("speed_hist_query 1h/128 col", (now_ns() - t0) / Q, 0, NULL);
+
+    speed_hist_query(&hist, 3600, col, 128);
+    uint16_t vmax = speed_graph_scale(col, 128);
+    t0 = now_ns();
+    for (int i = 0; i < Q; i++) {
+        speed_graph_plot(&fb, 2, 4, 4, col, 128, vmax);
+        fb.dirty = 0;
+    }
+    report("speed_graph_plot 128x32", (now_ns() - t0) / Q, 4 * I2C_PAGE_BYTES, "B bus");
+}
+
+/* ---------- czcionka ---------- */
+static void bench_font(void)
+{
+    enum { N = 200000 };
+    uint8_t row[SH1106_WIDTH];
+    const char *s = "Zażółć gęślą jaźń";
+
+    double t0 = now_ns();
+    for (int i = 0; i < N; i++) {
+        memset(row, 0, sizeof(row));
+        sink += font_draw(row, sizeof(row), 0, s);
+    }
+    report("font_draw 17 chars (warm)", (now_ns() - t0) / N, 0, NULL);
+
+    t0 = now_ns();
+    for (int i = 0; i < N; i++) sink += font_text_width(s);
+    report("font_text_width", (now_ns() - t0) / N, 0, NULL);
+}
+
+/* ---------- menu ---------- */
+static uint16_t wheel_mm = 2100;
+static uint8_t  units, contrast;
+static const char *const unit_opts[] = { "km", "mi" };
+static const char *const contrast_opts[] = { "niska", "średnia", "wysoka", "maks." };
+static const menu_item_t items[] = {
+    { .label = "Obwód koła", .kind = MENU_VALUE,  .num = { &wheel_mm, 1000, 2400, 5, "mm" } },
+    { .label = "Jednostki",  .kind = MENU_CHOICE, .choice = { &units, unit_opts, 2 } },
+    { .label = "Jasność",    .kind = MENU_CHOICE, .choice = { &contrast, contrast_opts, 4 } },
+    { .label = "Wróć",       .kind = MENU_BACK },
+};
+static const menu_page_t page = { "USTAWIENIA", items, 4 };
+
+static void bench_menu(void)
+{
+    enum { N = 50000 };
+    ui_menu_t m;
+    unsigned pages = 0;
+
+    ui_menu_open(&m, &page, NULL);
+    sh1106_fb_clear(&fb);
+    ui_menu_render(&m, &fb);
+    fb.dirty = 0;
+
+    /* jeden detent enkodera: zmieniają się dwa wiersze */
+    double t0 = now_ns();
+    for (int i = 0; i < N; i++) {
+        ui_menu_input(&m, (i & 1) ? -1 : 1, false);
+        sink += ui_menu_render(&m, &fb);
+        pages += take_dirty(&fb);
+    }
+    report("ui_menu step + render", (now_ns() - t0) / N, (double)pages / N * I2C_PAGE_BYTES, "B bus");
+}
+
+/* ---------- telemetria ---------- */
+/* rekord bez kodeka: t_ms u32 + km/h float + km float */
+#define RAW_SAMPLE_BYTES    12
+
+/* Próbki z pliku `replay -R`: „t_ms prędkość_ckmh dystans_m” w wierszu. */
+static size_t load_ride(const char *path, ride_sample_t **out)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return 0;
+    }
+    size_t n = 0, cap = 0;
+    ride_sample_t *v = NULL;
+    unsigned long t, sp, dist;
+    while (fscanf(f, "%lu %lu %lu", &t, &sp, &dist) == 3) {
+        if (n == cap) {
+            cap = cap ? cap * 2 : 4096;
+            v = realloc(v, cap * sizeof(*v));
+            if (!v) abort();
+        }
+        v[n++] = (ride_sample_t){ (uint32_t)t, (uint16_t)sp, (uint32_t)dist };
+    }
+    fclose(f);
+    *out = v;
+    return n;
+}
+
+static void bench_codec(const ride_sample_t *in, size_t n_in, const char *what)
+{
+    uint8_t *out = malloc(n_in * TELEM_ENC_MAX_BYTES + TELEM_ENC_MAX_BYTES);
+    telem_enc_t e;
+    telem_dec_t d;
+    ride_sample_t s;
+    size_t bytes = 0, cap = n_in * TELEM_ENC_MAX_BYTES + TELEM_ENC_MAX_BYTES;
+    char name[64];
+
+    if (!out) abort();
+    telem_enc_reset(&e);
+    double t0 = now_ns();
+    for (size_t i = 0; i < n_in; i++)
+        bytes += telem_enc_put(&e, &in[i], out + bytes, cap - bytes);
+    bytes += telem_enc_flush(&e, out + bytes, cap - bytes);
+    snprintf(name, sizeof(name), "telem_enc_put (%s)", what);
+    report(name, (now_ns() - t0) / n_in, (double)bytes / n_in, "B flash");
+
+    unsigned n = 0;
+    telem_dec_init(&d, out, bytes);
+    t0 = now_ns();
+    while (telem_dec_next(&d, &s) == 1) {
+        sink += s.speed_ckmh;
+        n++;
+    }
+    double ns = now_ns() - t0;
+    snprintf(name, sizeof(name), "telem_dec_next (%s)", what);
+    report(name, ns / n, (double)bytes / n, "B flash");
+    printf("%-30s %10.1f MB/s encoded %6.1f Msamples/s %6.2fx vs %d B float\n",
+           "telem_dec throughput", bytes / ns * 1e3, n / ns * 1e3,
+           (double)n_in * RAW_SAMPLE_BYTES / bytes, RAW_SAMPLE_BYTES);
+    free(out);
+}
+
+/* Syntetyczna piła 25–27 km/h, bez postojów – górna granica dla jazdy
+ * bez zatrzymań; liczby z przejazdu daje `bench ride.txt`. */
+static void bench_codec_synth(void)
+{
+    enum { N = 1000000 };
+    ride_sample_t *v = malloc(N * sizeof(*v));
+    ride_sample_t s = { 0, 0, 0 };
+
+    if (!v) abort();
+    for (int i = 0; i < N; i++) {
+        s.t_ms += 1000;
+        s.speed_ckmh = (uint16_t)(2500 + (i % 40 < 20 ? i % 20 : 20 - i % 20) * 11);
+        s.dist_m += s.speed_ckmh / 360;
+        v[i] = s;
+    }
+    bench_codec(v, N, "sawtooth");
+    free(v);
+}
+
+/* ---------- dziennik przejazdu ----------
+ * Partycja w pliku: zapis strony to pwrite, więc append mierzy też
+ * wywołania systemowe (co ~100 próbek); odczyt idzie z mmap jak na płytce. */
+#define BENCH_PART_SIZE (64 * FLASH_SECTOR_SIZE)
+
+static void ride_sample_at(ride_sample_t *s, int i)
+{
+    s->t_ms += i % 600 == 0 ? 3000 : 1000;
+    s->speed_ckmh = (uint16_t)(i % 1800 < 60 ? 0 : 2500 + (i % 40 < 20 ? i % 20 : 20 - i % 20) * 11);
+    s->dist_m += s->speed_ckmh / 360;
+}
+
+static void bench_ride_log(void)
+{
+    enum { N = 200000, SEEKS = 100000 };
+    char path[] = "/tmp/bench_ride_XXXXXX";
+    flash_port_t fp;
+    flash_file_t ff;
+    ride_log_t log;
+    ride_sample_t s = { 0, 0, 0 };
+
+    int fd = mkstemp(path);
+    if (fd < 0) return;
+    close(fd);
+    flash_port_file_open(&fp, &ff, path, BENCH_PART_SIZE);
+    ride_log_open(&log, &fp);
+
+    double t0 = now_ns();
+    for (int i = 0; i < N; i++) {
+        ride_sample_at(&s, i);
+        ride_log_append(&log, &s);
+    }
+    ride_log_flush(&log);
+    report("ride_log_append", (now_ns() - t0) / N, (double)fp.bytes_written / N, "B flash");
+
+    static ride_reader_t rd;
+    ride_reader_open(&rd, &fp);
+    ride_iter_t it;
+    ride_sample_t o;
+    uint32_t t_first, t_last = s.t_ms, n = 0;
+    ride_iter_begin(&it, &rd);
+    ride_iter_next(&it, &o);
+    t_first = o.t_ms;
+
+    /* dekodowanie całej partycji z mapowania */
+    t0 = now_ns();
+    ride_iter_begin(&it, &rd);
+    while (ride_iter_next(&it, &o) == 1) {
+        sink += o.speed_ckmh;
+        n++;
+    }
+    double ns = (now_ns() - t0) / n;
+    report("ride_iter_next (decode)", ns, (double)fp.size / n, "B flash");
+
+    t0 = now_ns();
+    uint32_t rng = 1;
+    for (int i = 0; i < SEEKS; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        ride_iter_seek(&it, t_first + rng % (t_last - t_first));
+        ride_iter_next(&it, &o);
+        sink += o.t_ms;
+    }
+    report("ride_iter_seek (random)", (now_ns() - t0) / SEEKS, 0, NULL);
+
+    /* eksport CSV kawałkami notyfikacji (MTU 247) */
+    static uint8_t chunk[244];
+    ride_export_t x;
+    size_t bytes = 0, len;
+    t0 = now_ns();
+    ride_export_begin(&x, &rd, 0, 0);
+    while ((len = ride_export_read(&x, chunk, sizeof(chunk))) != 0) bytes += len;
+    ns = now_ns() - t0;
+    report("ride_export_read per sample", ns / n, (double)bytes / n, "B csv");
+    printf("%-30s %10.1f MB/s csv\n", "ride_export throughput", bytes / ns * 1e3);
+
+    ride_reader_close(&rd);
+    flash_port_file_close(&fp);
+    unlink(path);
+}
+
+/* ---------- BLE ---------- */
+static void bench_ble(void)
+{
+    enum { N = 200000 };
+    uint64_t bytes = 0;
+    unsigned notes = 0;
+
+    fake_host_init(8);
+    fake_host_connect(1);
+    double t0 = now_ns();
+    for (int i = 0; i < N; i++) {
+        fake_host_advance(100000);
+        ble_core_publish(BLE_CHR_SPEED, 20.0f + (i % 100) * 0.1f);
+        fake_host_tx_complete(1);
+        if ((i & 1023) == 1023) {
+            size_t n;
+            const fake_ev_t *ev = fake_host_events(&n);
+            for (size_t k = 0; k < n; k++)
+                if (ev[k].type == FAKE_EV_NOTIFY) {
+                    bytes += ev[k].len + ATT_NOTIFY_OVERHEAD;
+                    notes++;
+                }
+            fake_host_clear();
+        }
+    }
+    double ns = (now_ns() - t0) / N;
+    report("ble_core_publish speed", ns, notes ? (double)bytes / notes : 0, "B air");
+
+    fake_alloc_stats_t a;
+    fake_host_alloc_stats(&a);
+    printf("%-30s %10.2f M/s %8.2f pool + %.2f msys alloc/notify, %u refused, %u lost\n",
+           "ble notify throughput", 1e3 / ns, (double)a.pool_allocs / a.notifies,
+           (double)a.msys_allocs / a.notifies, (unsigned)a.refused, (unsigned)a.msys_failed);
+
+    uint8_t buf[BLE_DIAG_LEN];
+    t0 = now_ns();
+    for (int i = 0; i < N; i++) sink += ble_core_read(BLE_CHR_DIAG, buf, sizeof(buf));
+    report("ble_core_read diag", (now_ns() - t0) / N, BLE_DIAG_LEN + ATT_NOTIFY_OVERHEAD, "B air");
+}
+
+int main(int argc, char **argv)
+{
+    bench_font();
+    bench_hist();
+    bench_screen();
+    bench_mirror();
+    bench_menu();
+    bench_codec_synth();
+    if (argc > 1) {
+        ride_sample_t *ride = NULL;
+        size_t n = load_ride(argv[1], &ride);
+        if (n) bench_codec(ride, n, "ride");
+        free(ride);
+    }
+    bench_ride_log();
+    bench_ble();
+    return 0;
+}
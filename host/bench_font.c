@@ -0,0 +1,57 @@
+/* Pomiar silnika czcionki: rozmiar atlasu i koszt rysowania napisu
+ * z zimną i rozgrzaną pamięcią podręczną glifów. */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "font.h"
+
+#define ROUNDS  200000
+
+static const char *const samples[] = {
+    "V: 23.4 km/h",
+    "Prędkość średnia",
+    "Zażółć gęślą jaźń",
+    "ŁÓDŹ - ŚCIEŻKA",
+};
+
+static double now_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+int main(void)
+{
+    uint8_t row[132];
+    font_stats_t st;
+
+    printf("atlas: %u glyphs, data %u B, table %zu B\n", font_atlas.count,
+           font_atlas.data_len, font_atlas.count * sizeof(font_glyph_desc_t));
+
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        const char *s = samples[i];
+        font_stats_t before;
+
+        /* zimno: pierwszy raz po innych napisach */
+        font_get_stats(&before);
+        double t0 = now_ns();
+        memset(row, 0, sizeof(row));
+        uint16_t w = font_draw(row, sizeof(row), 0, s);
+        double cold = now_ns() - t0;
+        font_get_stats(&st);
+
+        t0 = now_ns();
+        for (int r = 0; r < ROUNDS; r++) {
+            memset(row, 0, sizeof(row));
+            w = font_draw(row, sizeof(row), 0, s);
+        }
+        double warm = (now_ns() - t0) / ROUNDS;
+
+        printf("%-22s %3u px  cold %6.0f ns (%u decodes)  warm %5.0f ns\n",
+               s, w, cold, st.misses - before.misses, warm);
+    }
+    font_get_stats(&st);
+    printf("cache: %u hits, %u misses\n", st.hits, st.misses);
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include <string.h>
+#include "ble_fake_host.h"
+
+static fake_ev_t events[FAKE_EV_MAX];
+static size_t    n_events;
+static uint32_t  overflow;
+
+static int64_t   now_us;
+static uint16_t  pool_cap, pool_used, pool_hwm;
+static uint16_t  msys_cap;          /* nagłówki w locie = pool_used */
+static uint16_t  depth;
+static fake_alloc_stats_t allocs;
+
+static fake_ev_t *record(fake_ev_type_t type, uint16_t conn, ble_chr_t chr,
+                         const void *data, size_t len)
+{
+    if (n_events == FAKE_EV_MAX) {
+        overflow++;
+        return NULL;
+    }
+    fake_ev_t *e = &events[n_events++];
+    memset(e, 0, sizeof(*e));
+    e->type = type;
+    e->t_us = now_us;
+    e->conn = conn;
+    e->chr = chr;
+    if (len > FAKE_DATA_MAX) len = FAKE_DATA_MAX;
+    if (data) memcpy(e->data, data, len);
+    e->len = (uint16_t)len;
+    return e;
+}
+
+/* ---------- ble_core_host_t ---------- */
+static bool fake_notify(uint16_t conn, ble_chr_t chr, const void *data, uint16_t len)
+{
+    if (pool_used == pool_cap) {
+        allocs.refused++;
+        return false;
+    }
+    allocs.pool_allocs++;
+    allocs.notifies++;
+    if (pool_used == msys_cap) {
+        /* ENOMEM na nagłówku: stos zwalnia blok i zgłasza NOTIFY_TX z błędem */
+        allocs.msys_failed++;
+    } else {
+        allocs.msys_allocs++;
+        pool_used++;
+        if (pool_used > pool_hwm) pool_hwm = pool_used;
+        record(FAKE_EV_NOTIFY, conn, chr, data, len);
+    }
+
+    /* NOTIFY_TX z wnętrza notify, jak ble_gatts_notify_custom */
+    if (++depth > allocs.max_depth) allocs.max_depth = depth;
+    record(FAKE_EV_NOTIFY_TX, conn, chr, NULL, 0);
+    ble_core_on_notify_tx();
+    depth--;
+    return true;
+}
+
+static void fake_adv_refresh(bool restart)
+{
+    ble_adv_cfg_t cfg;
+    ble_core_adv_config(&cfg);
+    record(restart ? FAKE_EV_ADV_START : FAKE_EV_ADV_DATA, BLE_CONN_NONE,
+           BLE_CHR_COUNT, cfg.mfg, cfg.mfg_len);
+}
+
+static void fake_conn_params(uint16_t conn, const ble_policy_params_t *p)
+{
+    record(FAKE_EV_CONN_PARAMS, conn, BLE_CHR_COUNT, p, sizeof(*p));
+}
+
+static void fake_pool_usage(uint16_t *capacity, uint16_t *in_use, uint16_t *high_water)
+{
+    *capacity = pool_cap;
+    *in_use = pool_used;
+    *high_water = pool_hwm;
+}
+
+static int64_t fake_now(void) { return now_us; }
+static void    fake_lock(void) { }
+static void    fake_unlock(void) { }
+
+static const ble_core_host_t fake_host = {
+    .notify      = fake_notify,
+    .adv_refresh = fake_adv_refresh,
+    .conn_params = fake_conn_params,
+    .pool_usage  = fake_pool_usage,
+    .now_us      = fake_now,
+    .lock        = fake_lock,
+    .unlock      = fake_unlock,
+};
+
+/* ---------- sterowanie ---------- */
+void fake_host_init(uint16_t pool_blocks)
+{
+    pool_cap = pool_blocks;
+    pool_used = pool_hwm = 0;
+    msys_cap = UINT16_MAX;
+    now_us = 0;
+    memset(&allocs, 0, sizeof(allocs));
+    fake_host_clear();
+
+    ble_core_init(&fake_host);
+    ble_core_on_sync();
+    fake_adv_refresh(true);
+}
+
+void fake_host_advance(int64_t us)
+{
+    now_us += us;
+}
+
+int64_t fake_host_now(void)
+{
+    return now_us;
+}
+
+void fake_host_connect(uint16_t conn)
+{
+    record(FAKE_EV_CONNECT, conn, BLE_CHR_COUNT, NULL, 0);
+    ble_core_on_connect(conn);
+}
+
+void fake_host_disconnect(void)
+{
+    record(FAKE_EV_DISCONNECT, ble_core_conn(), BLE_CHR_COUNT, NULL, 0);
+    pool_used = 0;
+    ble_core_on_disconnect();
+    fake_adv_refresh(true);
+}
+
+void fake_host_tx_complete(unsigned n)
+{
+    if (n > pool_used) n = pool_used;
+    if (n == 0) return;
+    pool_used -= n;
+    ble_core_on_tx_done();
+}
+
+void fake_host_set_msys(uint16_t blocks)
+{
+    msys_cap = blocks;
+}
+
+void fake_host_alloc_stats(fake_alloc_stats_t *out)
+{
+    *out = allocs;
+}
+
+size_t fake_host_read(ble_chr_t chr, uint8_t *buf, size_t cap)
+{
+    size_t len = ble_core_read(chr, buf, cap);
+    record(FAKE_EV_READ, ble_core_conn(), chr, buf, len);
+    return len;
+}
+
+const fake_ev_t *fake_host_events(size_t *count)
+{
+    *count = n_events;
+    return events;
+}
+
+size_t fake_host_count(fake_ev_type_t type)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < n_events; i++) {
+        if (events[i].type == type) n++;
+    }
+    return n;
+}
+
+uint32_t fake_host_overflow(void)
+{
+    return overflow;
+}
+
+void fake_host_clear(void)
+{
+    n_events = 0;
+    overflow = 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "ble_core.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Atrapa stosu BLE dla Linuksa: podpina się pod ble_core zamiast NimBLE
+ * i zapisuje każdą notyfikację, odczyt i zdarzenie GAP. Zegar jest
+ * wirtualny, a pula buforów ma zadaną pojemność – tak można sprawdzić
+ * kolejkowanie i gubienie próbek bez radia.
+ *
+ * Kolejność zdarzeń jak w NimBLE: NOTIFY_TX przychodzi synchronicznie
+ * z wnętrza notify, a blok puli wraca dopiero, gdy kontroler przejmie
+ * pakiet (fake_host_tx_complete). Alokacje liczone są tam, gdzie robi je
+ * stos: blok z puli telemetrii na dane (host_notify), potem mbuf z msys
+ * na nagłówek ATT (ble_att_clt_tx_notify). Gdy msys jest pusty, notify
+ * kończy się ENOMEM: blok wraca od razu do puli, NOTIFY_TX i tak
+ * przychodzi, a próbka przepada.
+ */
+
+#define FAKE_EV_MAX     4096
+#define FAKE_DATA_MAX   32
+
+typedef enum {
+    FAKE_EV_NOTIFY = 0,
+    FAKE_EV_READ,
+    FAKE_EV_ADV_START,
+    FAKE_EV_ADV_DATA,
+    FAKE_EV_CONN_PARAMS,
+    FAKE_EV_CONNECT,
+    FAKE_EV_DISCONNECT,
+    FAKE_EV_NOTIFY_TX,
+} fake_ev_type_t;
+
+typedef struct {
+    uint32_t notifies;      /* notyfikacje przyjęte przez stos */
+    uint32_t refused;       /* odmowy z braku bloku w puli     */
+    uint32_t pool_allocs;   /* bloki puli telemetrii           */
+    uint32_t msys_allocs;   /* mbufy msys (nagłówek ATT)       */
+    uint32_t msys_failed;   /* notify zgubione z braku msys    */
+    uint16_t max_depth;     /* najgłębsze zagnieżdżenie notify */
+} fake_alloc_stats_t;
+
+typedef struct {
+    fake_ev_type_t type;
+    int64_t        t_us;
+    uint16_t       conn;
+    ble_chr_t      chr;
+    uint16_t       len;
+    uint8_t        data[FAKE_DATA_MAX];
+} fake_ev_t;
+
+/* pool_blocks: ile notyfikacji może być naraz „w locie”. */
+void fake_host_init(uint16_t pool_blocks);
+
+void    fake_host_advance(int64_t us);
+int64_t fake_host_now(void);
+
+void fake_host_connect(uint16_t conn);
+void fake_host_disconnect(void);
+
+/* Kontroler przejął n najstarszych notyfikacji – bloki wracają do puli,
+ * a ich nagłówki do msys. */
+void fake_host_tx_complete(unsigned n);
+
+/* Ile mbufów msys zostaje na nagłówki ATT (domyślnie bez limitu). */
+void fake_host_set_msys(uint16_t blocks);
+
+void fake_host_alloc_stats(fake_alloc_stats_t *out);
+
+size_t fake_host_read(ble_chr_t chr, uint8_t *buf, size_t cap);
+
+const fake_ev_t *fake_host_events(size_t *count);
+size_t   fake_host_count(fake_ev_type_t type);
+uint32_t fake_host_overflow(void);
+void     fake_host_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
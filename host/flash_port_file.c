@@ -0,0 +1,108 @@
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "flash_port_file.h"
+
+static esp_err_t file_read(flash_port_t *fp, uint32_t off, void *dst, size_t len)
+{
+    flash_file_t *ff = fp->ctx;
+    if (off + len > fp->size) return ESP_ERR_INVALID_SIZE;
+    return pread(ff->fd, dst, len, off) == (ssize_t)len ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t file_write(flash_port_t *fp, uint32_t off, const void *src, size_t len)
+{
+    flash_file_t *ff = fp->ctx;
+    const uint8_t *in = src;
+    uint8_t buf[FLASH_PAGE_SIZE];
+    esp_err_t ret = ESP_OK;
+
+    if (off + len > fp->size) return ESP_ERR_INVALID_SIZE;
+
+    while (len) {
+        size_t n = len < sizeof(buf) ? len : sizeof(buf);
+
+        if (ff->power_cut_after) {
+            if (n >= ff->power_cut_after) {
+                n = ff->power_cut_after;
+                len = n;                        /* to ostatni kawałek */
+                ret = ESP_FAIL;
+            }
+            ff->power_cut_after -= n;
+            if (ff->power_cut_after == 0 && ret == ESP_OK) ret = ESP_FAIL;
+        }
+        if (pread(ff->fd, buf, n, off) != (ssize_t)n) return ESP_FAIL;
+        for (size_t i = 0; i < n; i++) buf[i] &= in[i];     /* NOR: 1 -> 0 */
+        if (pwrite(ff->fd, buf, n, off) != (ssize_t)n) return ESP_FAIL;
+
+        off += n;
+        in += n;
+        len -= n;
+    }
+    return ret;
+}
+
+static esp_err_t file_erase(flash_port_t *fp, uint32_t off)
+{
+    flash_file_t *ff = fp->ctx;
+    uint8_t ff_buf[FLASH_SECTOR_SIZE];
+
+    if (off % FLASH_SECTOR_SIZE || off >= fp->size) return ESP_ERR_INVALID_ARG;
+    memset(ff_buf, 0xFF, sizeof(ff_buf));
+    return pwrite(ff->fd, ff_buf, sizeof(ff_buf), off) == sizeof(ff_buf) ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t file_map(flash_port_t *fp, const void **out)
+{
+    flash_file_t *ff = fp->ctx;
+    void *p = mmap(NULL, fp->size, PROT_READ, MAP_SHARED, ff->fd, 0);
+    if (p == MAP_FAILED) return ESP_FAIL;
+    fp->mapped = *out = p;
+    return ESP_OK;
+}
+
+static void file_unmap(flash_port_t *fp)
+{
+    if (!fp->mapped) return;
+    munmap((void *)fp->mapped, fp->size);
+    fp->mapped = NULL;
+}
+
+esp_err_t flash_port_file_open(flash_port_t *fp, flash_file_t *ff,
+                               const char *path, uint32_t size)
+{
+    struct stat st;
+
+    ff->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (ff->fd < 0) return ESP_ERR_NOT_FOUND;
+    ff->power_cut_after = 0;
+
+    *fp = (flash_port_t) {
+        .size = size,
+        .read = file_read,
+        .write = file_write,
+        .erase_sector = file_erase,
+        .map = file_map,
+        .unmap = file_unmap,
+        .ctx = ff,
+    };
+
+    /* nowy plik = fabrycznie skasowana pamięć */
+    if (fstat(ff->fd, &st) == 0 && st.st_size < (off_t)size) {
+        for (uint32_t off = st.st_size / FLASH_SECTOR_SIZE * FLASH_SECTOR_SIZE;
+             off < size; off += FLASH_SECTOR_SIZE) {
+            file_erase(fp, off);
+        }
+    }
+    return ESP_OK;
+}
+
+void flash_port_file_close(flash_port_t *fp)
+{
+    flash_file_t *ff = fp->ctx;
+    file_unmap(fp);
+    close(ff->fd);
+    ff->fd = -1;
+}
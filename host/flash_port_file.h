@@ -0,0 +1,23 @@
+#pragma once
+#include <stdint.h>
+#include "flash_port.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Partycja w pliku – zamiennik flash_port_esp.c na Linuksie.
+ * Zachowuje się jak NOR: kasowanie ustawia 0xFF, zapis tylko zeruje bity.
+ * power_cut_after > 0 przerywa zapis po tylu bajtach (symulacja zaniku
+ * zasilania w trakcie programowania strony). */
+typedef struct {
+    int      fd;
+    uint32_t power_cut_after;   /* 0 = wyłączone */
+} flash_file_t;
+
+esp_err_t flash_port_file_open(flash_port_t *fp, flash_file_t *ff,
+                               const char *path, uint32_t size);
+void      flash_port_file_close(flash_port_t *fp);
+
+#ifdef __cplusplus
+}
+#endif
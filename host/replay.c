@@ -0,0 +1,486 @@
+/* Powtórka przejazdu z zapisu impulsów czujnika koła.
+ *
+ * Wirtualny zegar prowadzi cały tor tak jak na licznikach: ISR koła
+ * (wheel_pulse), pętlę ekranu z widgetami ekranu jazdy i tempem z pacera
+ * (frame_pacer), historię prędkości i – jak zadanie czujnika w BLE/main.c –
+ * próbki BLE co sekundę przez ble_core z atrapą stosu. Zdarzenia są
+ * wykonywane w kolejności czasu bez czekania, więc 6 h jazdy trwa sekundy.
+ *
+ * Wejście (tekst): jeden impuls na wiersz, czas w µs; „b” po czasie oznacza
+ * znane drganie kontaktronu (nie obrót). Wiersze od '#' są pomijane.
+ *   replay [-w mm] [-o out] [-v] impulsy.txt
+ *   replay [-w mm] [-o out] [-v] -s sekundy [-r ziarno] [-S zapis.txt]
+ * -s generuje przejazd syntetyczny (jazda, sprinty, postoje, drgania).
+ * -o zapisuje klatki (F), stan panelu (D) i pakiety BLE (B) do porównań
+ * diffem; -v dokłada treść wysłanych stron ekranu. -m zapisuje pakiety kopii
+ * ekranu (fb_mirror) jak notyfikacje BLE, wiersz = czas w µs i hex pakietu;
+ * tools/fb_mirror_decode.py robi z nich obrazy. -R zapisuje próbki
+ * rejestratora co sekundę (t_ms, 0,01 km/h, dystans m) – wejście dla
+ * host/bench przy pomiarze kodeka na przejeździe.
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sh1106_fb.h"
+#include "ride_screen.h"
+#include "frame_pacer.h"
+#include "fb_mirror.h"
+#include "speed_hist.h"
+#include "wheel.h"
+#include "ble_core.h"
+#include "ble_policy.h"
+#include "ble_fake_host.h"
+
+/* jak w main/main.c, tempo ekranu wg domyślnych z Kconfig SH1106 */
+#define HIST_PERIOD_US  1000000
+static const pacer_cfg_t pacer_cfg = {
+    .min_frame_us = 1000000 / 10,
+    .heartbeat_us = 1000000,
+    .dim_us       = 30 * 1000000u,
+    .off_us       = 120 * 1000000u,
+};
+/* jak zadanie czujnika w BLE/main.c */
+#define BLE_SAMPLE_US   1000000
+#define BLE_POOL        8
+/* kopia ekranu jak BLE/ble_fb_mirror.c przy MTU 247 */
+#define MIRROR_FPS      4
+#define MIRROR_CAP      244
+/* sh1106_bus_page po I2C: adres + 3 x (ctrl, komenda) + ctrl danych + strona */
+#define I2C_PAGE_BYTES  (1 + 6 + 1 + SH1106_WIDTH)
+
+typedef struct {
+    int64_t t_us;
+    uint8_t bounce;
+} pulse_t;
+
+typedef struct {
+    double  *v;
+    size_t   n, cap;
+} series_t;
+
+static void series_add(series_t *s, double x)
+{
+    if (s->n == s->cap) {
+        s->cap = s->cap ? s->cap * 2 : 4096;
+        s->v = realloc(s->v, s->cap * sizeof(double));
+        if (!s->v) { perror("realloc"); exit(1); }
+    }
+    s->v[s->n++] = x;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void series_report(const char *name, series_t *s, const char *unit)
+{
+    if (!s->n) {
+        printf("%-22s brak próbek\n", name);
+        return;
+    }
+    qsort(s->v, s->n, sizeof(double), cmp_double);
+    double sum = 0;
+    for (size_t i = 0; i < s->n; i++) sum += s->v[i];
+    printf("%-22s n %7zu  avg %8.2f  p50 %8.2f  p95 %8.2f  p99 %8.2f  max %8.2f %s\n",
+           name, s->n, sum / s->n, s->v[s->n / 2], s->v[s->n * 95 / 100],
+           s->v[s->n * 99 / 100], s->v[s->n - 1], unit);
+}
+
+/* ---------- wejście ---------- */
+static pulse_t *pulses;
+static size_t   n_pulses, cap_pulses;
+
+static void pulse_add(int64_t t, uint8_t bounce)
+{
+    if (n_pulses == cap_pulses) {
+        cap_pulses = cap_pulses ? cap_pulses * 2 : 65536;
+        pulses = realloc(pulses, cap_pulses * sizeof(pulse_t));
+        if (!pulses) { perror("realloc"); exit(1); }
+    }
+    pulses[n_pulses++] = (pulse_t){ t, bounce };
+}
+
+static int load_pulses(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); return -1; }
+    char line[128];
+    unsigned ln = 0;
+    while (fgets(line, sizeof(line), f)) {
+        ln++;
+        char *p = line + strspn(line, " \t");
+        if (*p == '#' || *p == '\n' || *p == '\0') continue;
+        char *end;
+        long long t = strtoll(p, &end, 10);
+        if (end == p || (n_pulses && t < pulses[n_pulses - 1].t_us)) {
+            fprintf(stderr, "%s:%u: zły albo cofnięty czas\n", path, ln);
+            fclose(f);
+            return -1;
+        }
+        pulse_add(t, strchr(end, 'b') != NULL);
+    }
+    fclose(f);
+    return 0;
+}
+
+/* xorshift32 – powtarzalny dla danego ziarna na każdej platformie */
+static uint32_t rng;
+static uint32_t rnd(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+static double rnd_range(double lo, double hi) { return lo + (hi - lo) * (rnd() % 10000) / 10000.0; }
+
+/* Przejazd syntetyczny: odcinki jazdy, sprinty i postoje z płynnym
+ * przyspieszaniem, rozrzut okresu ±0,2 % i 2 % impulsów z drganiem styku. */
+static void synth_ride(int64_t dur_us, uint16_t wheel_mm)
+{
+    int64_t t = 1000000, seg_end = t;
+    double v = 0, target = 0, acc = 3.6;    /* km/h, km/h na sekundę */
+
+    while (t < dur_us) {
+        if (t >= seg_end) {
+            unsigned r = rnd() % 100;
+            if (r < 10) {               /* postój: światła, sklep */
+                target = 0; acc = 5.0;
+                seg_end = t + (int64_t)(rnd_range(10, 120) * 1e6);
+            } else if (r < 25) {        /* sprint */
+                target = rnd_range(40, 50); acc = 7.0;
+                seg_end = t + (int64_t)(rnd_range(15, 30) * 1e6);
+            } else {
+                target = rnd_range(18, 32); acc = 3.6;
+                seg_end = t + (int64_t)(rnd_range(60, 600) * 1e6);
+            }
+        }
+        if (target == 0 && v < 3.0) {
+            v = 0;
+            t = seg_end;                /* stoi do końca odcinka */
+            continue;
+        }
+        double kmh = v < 3.0 ? 3.0 : v;
+        double dt = wheel_mm * 3600.0 / kmh * (1.0 + rnd_range(-0.002, 0.002));
+        t += (int64_t)dt;
+        pulse_add(t, 0);
+        if (rnd() % 100 < 2 && dt > 16000)
+            pulse_add(t + 1000 + rnd() % 14000, 1);
+
+        double dv = acc * dt / 1e6;
+        v += target > v ? (target - v < dv ? target - v : dv)
+                        : (v - target < dv ? target - v : -dv);
+    }
+}
+
+static int save_pulses(const char *path, uint32_t seed)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) { perror(path); return -1; }
+    fprintf(f, "# synthetic ride, seed %" PRIu32 "\n", seed);
+    for (size_t i = 0; i < n_pulses; i++)
+        fprintf(f, "%" PRId64 "%s\n", pulses[i].t_us, pulses[i].bounce ? " b" : "");
+    fclose(f);
+    return 0;
+}
+
+/* ---------- symulacja ---------- */
+static FILE *out;
+static FILE *rec_out;
+static int   verbose;
+
+static state_snap_t snap;
+static wheel_t      wheel;
+static wheel_trip_t trip;
+static speed_hist_t hist;
+static sh1106_fb_t  fb;
+static ui_screen_t  screen;
+static frame_pacer_t pacer;
+static fb_mirror_t  mirror;
+static FILE        *mirror_out;
+static uint64_t     mirror_pkts;
+
+static uint32_t fnv1a(const uint8_t *p, size_t n)
+{
+    uint32_t h = 2166136261u;
+    while (n--) h = (h ^ *p++) * 16777619u;
+    return h;
+}
+
+static void emit_frame(int64_t t)
+{
+    if (!out || !fb.dirty) return;
+    fprintf(out, "F %" PRId64 " %02x %08" PRIx32 "\n", t, fb.dirty,
+            fnv1a(&fb.page[0][0], sizeof(fb.page)));
+    if (!verbose) return;
+    for (unsigned p = 0; p < SH1106_PAGES; p++) {
+        if (!(fb.dirty & (1u << p))) continue;
+        fprintf(out, "  P%u ", p);
+        for (unsigned x = 0; x < SH1106_WIDTH; x++) fprintf(out, "%02x", fb.page[p][x]);
+        fputc('\n', out);
+    }
+}
+
+/* cała ramka kopii od razu – atrapa nie ma limitu buforów */
+static void emit_mirror(int64_t t)
+{
+    uint8_t pkt[MIRROR_CAP];
+    size_t n;
+
+    fb_mirror_note(&mirror, fb.dirty);
+    if (!fb_mirror_begin(&mirror, &fb, t)) return;
+    while ((n = fb_mirror_next(&mirror, pkt, sizeof(pkt))) > 0) {
+        mirror_pkts++;
+        if (!mirror_out) continue;
+        fprintf(mirror_out, "%" PRId64 " ", t);
+        for (size_t k = 0; k < n; k++) fprintf(mirror_out, "%02x", pkt[k]);
+        fputc('\n', mirror_out);
+    }
+}
+
+static const char *const panel_names[] = { "on", "dim", "off" };
+
+static const char *const ev_names[] = {
+    "notify", "read", "adv", "adv-data", "params", "connect", "disconnect", "tx",
+};
+
+static void drain_ble(uint64_t *notify_bytes)
+{
+    size_t n;
+    const fake_ev_t *ev = fake_host_events(&n);
+    for (size_t i = 0; i < n; i++) {
+        if (ev[i].type == FAKE_EV_NOTIFY) *notify_bytes += ev[i].len;
+        if (!out || ev[i].type == FAKE_EV_NOTIFY_TX) continue;
+        fprintf(out, "B %" PRId64 " %s %d ", ev[i].t_us, ev_names[ev[i].type], ev[i].chr);
+        for (unsigned k = 0; k < ev[i].len; k++) fprintf(out, "%02x", ev[i].data[k]);
+        fputc('\n', out);
+    }
+    fake_host_clear();
+}
+
+static double now_wall_s(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: replay [-w mm] [-o out] [-m mirror] [-R samples] [-v] pulses.txt\n"
+                    "       replay [-w mm] [-o out] [-m mirror] [-R samples] [-v] -s seconds [-r seed] [-S save.txt]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned wheel_mm = 2100;
+    const char *out_path = NULL, *save_path = NULL, *mirror_path = NULL, *rec_path = NULL;
+    double synth_s = 0;
+    uint32_t seed = 1;
+    int c;
+
+    while ((c = getopt(argc, argv, "w:o:m:vs:r:S:R:")) != -1) {
+        switch (c) {
+        case 'w': wheel_mm = (unsigned)atoi(optarg); break;
+        case 'o': out_path = optarg; break;
+        case 'm': mirror_path = optarg; break;
+        case 'v': verbose = 1; break;
+        case 's': synth_s = atof(optarg); break;
+        case 'r': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'S': save_path = optarg; break;
+        case 'R': rec_path = optarg; break;
+        default: usage();
+        }
+    }
+    if (wheel_mm < 500 || wheel_mm > 3000) usage();
+    if (synth_s > 0) {
+        rng = seed ? seed : 1;
+        synth_ride((int64_t)(synth_s * 1e6), (uint16_t)wheel_mm);
+        if (save_path && save_pulses(save_path, seed)) return 1;
+    } else {
+        if (optind >= argc) usage();
+        if (load_pulses(argv[optind])) return 1;
+    }
+    if (!n_pulses) {
+        fprintf(stderr, "no pulses\n");
+        return 1;
+    }
+    if (out_path && !(out = fopen(out_path, "w"))) {
+        perror(out_path);
+        return 1;
+    }
+    if (mirror_path && !(mirror_out = fopen(mirror_path, "w"))) {
+        perror(mirror_path);
+        return 1;
+    }
+    if (rec_path && !(rec_out = fopen(rec_path, "w"))) {
+        perror(rec_path);
+        return 1;
+    }
+
+    /* zapis może zaczynać się od czasu od startu płytki – liczymy od 1 s przed impulsem */
+    int64_t t0 = pulses[0].t_us - 1000000;
+    for (size_t i = 0; i < n_pulses; i++) pulses[i].t_us -= t0;
+    int64_t end = pulses[n_pulses - 1].t_us + WHEEL_STOP_US + 2 * pacer_cfg.heartbeat_us;
+
+    state_snap_defaults(&snap);
+    snap.wheel_mm = (uint16_t)wheel_mm;
+    fake_host_init(BLE_POOL);
+    fake_host_connect(1);
+    speed_hist_reset(&hist);
+    sh1106_fb_clear(&fb);
+    ride_screen_init(&screen, &fb, &hist, NULL);
+    wheel_trip_init(&trip, 0, 0);
+    pacer_init(&pacer, &pacer_cfg, 0);
+    fb_mirror_init(&mirror, 1000000 / MIRROR_FPS);
+
+    series_t lat = { 0 }, err = { 0 }, stop_lat = { 0 };
+    uint64_t bus_bytes = 0, notify_bytes = 0, frames = 0, real = 0;
+    uint32_t real_dropped = 0, bounce_counted = 0;
+    size_t pi = 0, unseen = 0;          /* impulsy [unseen, pi) czekają na klatkę */
+    size_t ti = 0;                      /* ostatni prawdziwy impuls <= now */
+    int64_t next_frame = 0, next_ble = BLE_SAMPLE_US, next_ce = 0;
+    int64_t last_hist = 0, last_real = -1;
+    float prev_ble = 0, shown = 0;
+
+    double w0 = now_wall_s();
+    for (;;) {
+        int64_t tp = pi < n_pulses ? pulses[pi].t_us : INT64_MAX;
+        int64_t t = tp;
+        if (next_frame < t) t = next_frame;
+        if (next_ble < t) t = next_ble;
+        if (next_ce < t) t = next_ce;
+        if (t > end) break;
+        fake_host_advance(t - fake_host_now());
+
+        if (t == tp) {
+            /* ISR koła; każdy przyjęty impuls budzi pętlę ekranu */
+            const pulse_t *p = &pulses[pi++];
+            int64_t dt = wheel_pulse(&wheel, t);
+            if (dt && next_frame > t) next_frame = t;
+            if (!p->bounce) {
+                real++;
+                if (!dt) real_dropped++;
+            } else if (dt) {
+                bounce_counted++;
+            }
+        } else if (t == next_frame) {
+            float kmh = wheel_speed_kmh(wheel.period_us, wheel.last_us, t, snap.wheel_mm);
+            wheel_trip_update(&trip, &snap, wheel.revs, kmh, t);
+            while (t - last_hist >= HIST_PERIOD_US) {
+                speed_hist_push(&hist, (uint16_t)(kmh * 100.0f));
+                last_hist += HIST_PERIOD_US;
+            }
+            ride_view_t v = { kmh, wheel.revs, snap.odometer_m, snap.units, 1 };
+            ride_screen_set(&v);
+            ui_render(&screen);
+
+            panel_state_t panel = pacer.panel;
+            if (pacer_activity(&pacer, kmh > 0.0f, t) != panel && out)
+                fprintf(out, "D %" PRId64 " %s\n", t, panel_names[pacer.panel]);
+            if (pacer_frame_due(&pacer, fb.dirty, t)) {
+                emit_frame(t);
+                emit_mirror(t);
+                bus_bytes += (uint64_t)__builtin_popcount(fb.dirty) * I2C_PAGE_BYTES;
+                fb.dirty = 0;
+                frames++;
+
+                /* opóźnienie impuls -> pierwsza wysłana klatka, która go uwzględnia */
+                for (; unseen < pi; unseen++) {
+                    if (pulses[unseen].bounce) continue;
+                    series_add(&lat, (t - pulses[unseen].t_us) / 1000.0);
+                    last_real = pulses[unseen].t_us;
+                }
+                if (shown > 0.0f && kmh == 0.0f && last_real >= 0)
+                    series_add(&stop_lat, (t - last_real) / 1000.0);
+                shown = kmh;
+            }
+
+            /* prawda: średnia prędkość w bieżącym obrocie (zna następny impuls),
+             * porównana z tym, co akurat widać na ekranie */
+            while (ti + 1 < n_pulses && pulses[ti + 1].t_us <= t) ti++;
+            size_t tn = ti + 1;
+            while (tn < n_pulses && pulses[tn].bounce) tn++;
+            size_t tc = ti;
+            while (tc > 0 && pulses[tc].bounce) tc--;
+            double truth = 0;
+            if (pulses[tc].t_us <= t && tn < n_pulses &&
+                pulses[tn].t_us - pulses[tc].t_us <= WHEEL_STOP_US)
+                truth = snap.wheel_mm * 3600.0 / (pulses[tn].t_us - pulses[tc].t_us);
+            if (truth > 0 || shown > 0) series_add(&err, shown > truth ? shown - truth : truth - shown);
+
+            /* sen jak ulTaskNotifyTake w main.c: do pełnej milisekundy, co najmniej tick */
+            bool moving = kmh > 0.0f;
+            int64_t sleep_us = pacer_sleep_us(&pacer, fb.dirty, t);
+            if (moving && wheel.last_us + WHEEL_STOP_US + 1 - t < sleep_us)
+                sleep_us = wheel.last_us + WHEEL_STOP_US + 1 - t;
+            sleep_us = (sleep_us + 999) / 1000 * 1000;
+            next_frame = t + (sleep_us ? sleep_us : 1000);
+        } else if (t == next_ble) {
+            float kmh = wheel_speed_kmh(wheel.period_us, wheel.last_us, t, snap.wheel_mm);
+            ble_core_publish(BLE_CHR_SPEED, kmh);
+            /* próbka jak rejestrator w BLE/main.c */
+            if (rec_out)
+                fprintf(rec_out, "%" PRId64 " %u %" PRIu32 "\n", t / 1000,
+                        (unsigned)(uint16_t)(kmh * 100.0f), snap.trip_dist_m);
+            ble_core_publish(BLE_CHR_DIST, snap.trip_dist_m / 1000.0f);
+            ble_core_publish(BLE_CHR_AVG, snap.trip_time_s ?
+                             snap.trip_dist_m * 3.6f / snap.trip_time_s : 0.0f);
+            ble_core_broadcast_commit();
+            ble_core_set_ride_state(ble_policy_classify(kmh, prev_ble, 1.0f));
+            prev_ble = kmh;
+            next_ble += BLE_SAMPLE_US;
+            drain_ble(&notify_bytes);
+        } else {
+            /* zdarzenie połączenia: kontroler wysyła wszystko, co czeka */
+            fake_host_tx_complete(BLE_POOL);
+            next_ce += ble_policy_params(ble_policy_state())->conn_itvl_max * 1250;
+            drain_ble(&notify_bytes);
+        }
+    }
+    double wall = now_wall_s() - w0;
+    if (out) fclose(out);
+    if (mirror_out) fclose(mirror_out);
+    if (rec_out) fclose(rec_out);
+
+    double ride_s = end / 1e6;
+    pacer_stats_t ps;
+    pacer_take_stats(&pacer, &ps);
+    uint64_t true_mm = (uint64_t)real * snap.wheel_mm;
+    ble_notify_stats_t bs;
+    ble_core_stats(&bs);
+
+    printf("ride %.0f s, %zu pulses (%" PRIu64 " real), %" PRIu64 " frames, "
+           "replayed in %.3f s = %.0fx real time\n",
+           ride_s, n_pulses, real, frames, wall, ride_s / wall);
+    series_report("pulse->frame", &lat, "ms");
+    series_report("stop detection", &stop_lat, "ms");
+    series_report("speed error", &err, "km/h");
+    printf("%-22s %" PRIu32 " m shown, %.1f m true (%+.2f %%)\n", "distance",
+           snap.trip_dist_m, true_mm / 1000.0,
+           true_mm ? (snap.trip_dist_m * 1000.0 - true_mm) * 100.0 / true_mm : 0.0);
+    printf("%-22s %" PRIu32 " rejected, %" PRIu32 " bounces counted as revs, "
+           "%" PRIu32 " real pulses dropped\n", "debounce",
+           wheel.bounces, bounce_counted, real_dropped);
+    printf("%-22s max %u km/h, moving %" PRIu32 " s\n", "trip",
+           snap.trip_max_ckmh / 100, snap.trip_time_s);
+    printf("%-22s %.1f frames/min, %.1f wakeups/min, %" PRIu32 " held by FPS limit\n",
+           "display pacing", frames * 60.0 / ride_s, ps.wakeups * 60.0 / ride_s, ps.held);
+    printf("%-22s %.1f B/frame, %.1f kB total, ~%.1f s at 400 kHz\n", "display bus (I2C)",
+           frames ? (double)bus_bytes / frames : 0.0, bus_bytes / 1000.0,
+           bus_bytes * 9 / 400000.0);
+    printf("%-22s sent %" PRIu32 " deferred %" PRIu32 " dropped %" PRIu32
+           " lat max %" PRIu32 " us, %.1f kB payload\n", "ble",
+           bs.sent, bs.deferred, bs.dropped, bs.lat_max_us, notify_bytes / 1000.0);
+    printf("%-22s %" PRIu32 " frames (%" PRIu32 " key), %" PRIu64 " packets, "
+           "%.1f B/frame, %.1f B/s\n", "screen mirror",
+           mirror.frames, mirror.keys, mirror_pkts,
+           mirror.frames ? (double)mirror.bytes / mirror.frames : 0.0, mirror.bytes / ride_s);
+    return 0;
+}
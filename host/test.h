@@ -0,0 +1,40 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Minimalne asercje testów hosta: błąd nie przerywa testu, wynik na końcu. */
+static int test_failed, test_checks;
+
+#define CHECK(cond) do {                                                    \
+        test_checks++;                                                      \
+        if (!(cond)) {                                                      \
+            test_failed++;                                                  \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        }                                                                   \
+    } while (0)
+
+static inline int test_summary(const char *name)
+{
+    printf("%s: %d checks, %d failed\n", name, test_checks, test_failed);
+    return test_failed ? 1 : 0;
+}
+
+/* Ścieżka pliku tymczasowego (partycja flash na pliku); usuń unlink(). */
+static inline void test_tmp_path(char *path, size_t cap, const char *name)
+{
+    snprintf(path, cap, "/tmp/%s_XXXXXX", name);
+    int fd = mkstemp(path);
+    if (fd >= 0) close(fd);
+}
+
+/* Powtarzalny generator liczb (xorshift32) – testy bez rand(). */
+static inline uint32_t test_rand(uint32_t *s)
+{
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
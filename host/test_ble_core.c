@@ -0,0 +1,254 @@
+/* Testy rdzenia GATT na atrapie stosu: kolejność i treść notyfikacji,
+ * kolejka przy pustej puli, odczyty, tryb rozgłoszeniowy, NOTIFY_TX
+ * z wnętrza notify bez zagnieżdżania wysyłek. */
+#include <stdio.h>
+#include <string.h>
+#include "ble_core.h"
+#include "ble_fake_host.h"
+#include "test.h"
+
+static float notify_value(const fake_ev_t *e)
+{
+    float v;
+    memcpy(&v, e->data, sizeof(v));
+    return v;
+}
+
+/* kolejne notyfikacje od indeksu *from */
+static const fake_ev_t *next_notify(size_t *from)
+{
+    size_t n;
+    const fake_ev_t *ev = fake_host_events(&n);
+    for (; *from < n; (*from)++)
+        if (ev[*from].type == FAKE_EV_NOTIFY) return &ev[(*from)++];
+    return NULL;
+}
+
+static void start(uint16_t pool)
+{
+    fake_host_init(pool);
+    fake_host_connect(1);
+    fake_host_clear();
+}
+
+static void stop(void)
+{
+    fake_host_disconnect();
+}
+
+static void test_notify_payload(void)
+{
+    start(8);
+    ble_core_publish(BLE_CHR_SPEED, 27.5f);
+    ble_core_publish(BLE_CHR_DIST, 1.25f);
+
+    size_t i = 0;
+    const fake_ev_t *e = next_notify(&i);
+    CHECK(e && e->chr == BLE_CHR_SPEED && e->len == sizeof(float) && e->conn == 1);
+    CHECK(e && notify_value(e) == 27.5f);
+    e = next_notify(&i);
+    CHECK(e && e->chr == BLE_CHR_DIST && notify_value(e) == 1.25f);
+    CHECK(next_notify(&i) == NULL);
+    /* NOTIFY_TX zaraz po każdej notyfikacji, jeszcze w wywołaniu notify */
+    size_t n;
+    const fake_ev_t *ev = fake_host_events(&n);
+    CHECK(n == 4 && ev[1].type == FAKE_EV_NOTIFY_TX && ev[3].type == FAKE_EV_NOTIFY_TX);
+    stop();
+}
+
+static void test_no_notify_when_disconnected(void)
+{
+    fake_host_init(8);
+    ble_core_publish(BLE_CHR_SPEED, 10.0f);
+    CHECK(fake_host_count(FAKE_EV_NOTIFY) == 0);
+
+    uint8_t buf[4];
+    CHECK(ble_core_read(BLE_CHR_SPEED, buf, sizeof(buf)) == sizeof(float));
+    float v;
+    memcpy(&v, buf, sizeof(v));
+    CHECK(v == 10.0f);                  /* odczyt i tak zwraca ostatnią wartość */
+}
+
+static void test_pool_backpressure(void)
+{
+    start(2);
+    ble_notify_stats_t s0, s;
+    ble_core_stats(&s0);
+
+    for (int i = 0; i < 5; i++) ble_core_publish(BLE_CHR_SPEED, (float)i);
+    CHECK(fake_host_count(FAKE_EV_NOTIFY) == 2);
+    ble_core_stats(&s);
+    CHECK(s.in_use == 2 && s.high_water == 2 && s.pending == 3);
+    CHECK(s.deferred - s0.deferred == 3);
+
+    /* zwrot bloków wysyła odłożone próbki w kolejności publikacji */
+    fake_host_tx_complete(2);
+    fake_host_tx_complete(2);
+    size_t i = 0;
+    for (int k = 0; k < 5; k++) {
+        const fake_ev_t *e = next_notify(&i);
+        CHECK(e && notify_value(e) == (float)k);
+    }
+    ble_core_stats(&s);
+    CHECK(s.pending == 0 && s.dropped == s0.dropped);
+    stop();
+}
+
+static void test_oldest_dropped(void)
+{
+    start(1);
+    ble_notify_stats_t s0, s;
+    ble_core_stats(&s0);
+
+    /* 1 w locie + BLE_CORE_PENDING w kolejce, dalej wypadają najstarsze */
+    int total = 1 + BLE_CORE_PENDING + 3;
+    for (int i = 0; i < total; i++) ble_core_publish(BLE_CHR_SPEED, (float)i);
+    ble_core_stats(&s);
+    CHECK(s.pending == BLE_CORE_PENDING);
+    CHECK(s.dropped - s0.dropped == 3);
+
+    fake_host_clear();
+    for (int k = 0; k < BLE_CORE_PENDING; k++) fake_host_tx_complete(1);
+    size_t i = 0;
+    const fake_ev_t *e = next_notify(&i);
+    CHECK(e && notify_value(e) == 4.0f);        /* próbki 1..3 wypadły */
+    stop();
+}
+
+static void test_disconnect_clears_queue(void)
+{
+    start(1);
+    ble_core_publish(BLE_CHR_SPEED, 1.0f);
+    ble_core_publish(BLE_CHR_SPEED, 2.0f);
+    stop();
+
+    ble_notify_stats_t s;
+    ble_core_stats(&s);
+    CHECK(s.pending == 0);
+    fake_host_connect(2);
+    fake_host_clear();
+    ble_core_publish(BLE_CHR_SPEED, 3.0f);
+    size_t i = 0;
+    const fake_ev_t *e = next_notify(&i);
+    CHECK(e && e->conn == 2 && notify_value(e) == 3.0f);
+    CHECK(next_notify(&i) == NULL);     /* nic ze starego połączenia */
+    stop();
+}
+
+static void test_latency_includes_queueing(void)
+{
+    start(1);
+    ble_core_publish(BLE_CHR_SPEED, 1.0f);
+    ble_core_publish(BLE_CHR_SPEED, 2.0f);          /* czeka na blok */
+    fake_host_advance(1200000);
+    fake_host_tx_complete(1);
+
+    ble_notify_stats_t s;
+    ble_core_stats(&s);
+    CHECK(s.lat_max_us >= 1200000);
+    CHECK(s.lat_over >= 1);             /* > 2 interwały połączenia na postoju */
+    stop();
+}
+
+static void test_no_nested_sends(void)
+{
+    start(3);
+    for (int i = 0; i < 50; i++) {
+        ble_core_publish(BLE_CHR_SPEED, (float)i);
+        ble_core_publish(BLE_CHR_AVG, (float)i);
+        ble_core_publish(BLE_CHR_DIST, (float)i);
+        fake_host_tx_complete(3);
+    }
+    fake_alloc_stats_t a;
+    fake_host_alloc_stats(&a);
+    CHECK(a.max_depth == 1);
+    CHECK(a.notifies == 150);
+    CHECK(a.pool_allocs == 150 && a.msys_allocs == 150);
+    CHECK(a.refused == 0 && a.msys_failed == 0);
+    stop();
+}
+
+static void test_alloc_counts(void)
+{
+    fake_alloc_stats_t a;
+    ble_notify_stats_t s;
+
+    start(2);
+    fake_host_set_msys(1);
+    ble_core_publish(BLE_CHR_SPEED, 1.0f);
+    ble_core_publish(BLE_CHR_AVG, 2.0f);            /* blok jest, nagłówka brak */
+    fake_host_alloc_stats(&a);
+    CHECK(a.pool_allocs == 2 && a.msys_allocs == 1 && a.msys_failed == 1);
+    ble_core_stats(&s);
+    CHECK(s.in_use == 1);                           /* blok zgubionej wrócił */
+
+    fake_host_set_msys(8);
+    ble_core_publish(BLE_CHR_DIST, 3.0f);
+    ble_core_publish(BLE_CHR_SPEED, 4.0f);          /* pula pełna: bez alokacji */
+    fake_host_alloc_stats(&a);
+    CHECK(a.pool_allocs == 3 && a.msys_allocs == 2 && a.msys_failed == 1);
+    CHECK(a.refused == 1 && a.notifies == 3);
+    CHECK(fake_host_count(FAKE_EV_NOTIFY) == 2);
+    CHECK(fake_host_count(FAKE_EV_NOTIFY_TX) == 3);
+    stop();
+}
+
+static void test_diag_read(void)
+{
+    start(4);
+    ble_notify_stats_t s0;
+    ble_core_stats(&s0);
+    ble_core_publish(BLE_CHR_SPEED, 5.0f);
+
+    uint8_t buf[BLE_DIAG_LEN];
+    CHECK(ble_core_read(BLE_CHR_DIAG, buf, sizeof(buf)) == BLE_DIAG_LEN);
+    CHECK(ble_core_read(BLE_CHR_DIAG, buf, BLE_DIAG_LEN - 1) == 0);
+    CHECK((buf[0] | buf[1] << 8) == 4);                     /* pojemność */
+    CHECK((buf[2] | buf[3] << 8) == 1);                     /* zajęte */
+    uint32_t sent = buf[8] | buf[9] << 8 | buf[10] << 16 | (uint32_t)buf[11] << 24;
+    CHECK(sent == s0.sent + 1);
+    stop();
+}
+
+static void test_broadcast(void)
+{
+    fake_host_init(8);
+    ble_core_publish(BLE_CHR_SPEED, 25.0f);
+    ble_core_publish(BLE_CHR_DIST, 12.5f);
+    fake_host_clear();
+
+    ble_core_set_mode(BLE_MODE_BROADCAST);
+    size_t n;
+    const fake_ev_t *ev = fake_host_events(&n);
+    CHECK(n == 1 && ev[0].type == FAKE_EV_ADV_START && ev[0].len == BLE_BCAST_MFG_LEN);
+    CHECK(ev[0].data[0] == 0xFF && ev[0].data[1] == 0xFF);
+    CHECK((ev[0].data[4] | ev[0].data[5] << 8) == 2500);     /* 0.01 km/h */
+    CHECK((ev[0].data[8] | ev[0].data[9] << 8) == 12500);    /* m */
+    uint8_t cnt = ev[0].data[3];
+
+    ble_core_broadcast_commit();
+    ev = fake_host_events(&n);
+    CHECK(n == 2 && ev[1].type == FAKE_EV_ADV_DATA && ev[1].data[3] == (uint8_t)(cnt + 1));
+
+    ble_adv_cfg_t cfg;
+    ble_core_adv_config(&cfg);
+    CHECK(!cfg.connectable);
+    ble_core_set_mode(BLE_MODE_CONNECTABLE);
+    ble_core_adv_config(&cfg);
+    CHECK(cfg.connectable && cfg.mfg_len == 0);
+}
+
+int main(void)
+{
+    test_notify_payload();
+    test_no_notify_when_disconnected();
+    test_pool_backpressure();
+    test_oldest_dropped();
+    test_disconnect_clears_queue();
+    test_latency_includes_queueing();
+    test_no_nested_sends();
+    test_alloc_counts();
+    test_diag_read();
+    test_broadcast();
+    return test_summary("ble_core");
+}
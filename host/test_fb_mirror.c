@@ -0,0 +1,278 @@
+/* Testy kopii ekranu: odbiorca zbudowany z opisu formatu w fb_mirror.h
+ * odtwarza bufor ramki bit w bit, pakiety mieszczą się w MTU, a po
+ * fb_mirror_key idzie pełna ramka kluczowa. Transport bez buforów
+ * w połowie ramki (pusty msys) nie gubi pakietów ani nie blokuje kopii. */
+#include <string.h>
+#include "fb_mirror.h"
+#include "test.h"
+
+typedef struct {
+    uint8_t img[SH1106_PAGES][SH1106_WIDTH];
+    uint8_t pages[SH1106_PAGES];
+    uint8_t n_pages;
+    uint16_t pos;
+    uint8_t seq, idx;
+    bool    synced;
+} rx_t;
+
+/* true = pakiet poprawnie zastosowany */
+static bool rx_feed(rx_t *r, const uint8_t *p, size_t n)
+{
+    if (n < 2) return false;
+    uint8_t idx = p[1] & FB_MIRROR_IDX_MASK;
+    size_t i = 2;
+
+    if (idx == 0) {
+        if (p[1] & FB_MIRROR_KEY) {
+            memset(r->img, 0, sizeof(r->img));
+            r->synced = true;
+        } else if (p[0] != (uint8_t)(r->seq + 1)) {
+            r->synced = false;
+        }
+        if (n < 3) return false;
+        r->n_pages = 0;
+        for (int pg = 0; pg < SH1106_PAGES; pg++)
+            if (p[2] & 1u << pg) r->pages[r->n_pages++] = pg;
+        r->seq = p[0];
+        r->pos = 0;
+        i = 3;
+    } else if (p[0] != r->seq || idx != ((r->idx + 1) & FB_MIRROR_IDX_MASK)) {
+        r->synced = false;
+    }
+    r->idx = idx;
+    if (!r->synced) return false;
+
+    uint16_t end = r->n_pages * SH1106_WIDTH;
+    while (i < n) {
+        uint8_t c = p[i++];
+        uint16_t len = (c & 0x7F) + 1;
+        if (r->pos + len > end) return false;
+        if (c & 0x80) {
+            r->pos += len;
+            continue;
+        }
+        if (i + len > n) return false;
+        for (uint16_t k = 0; k < len; k++, r->pos++)
+            r->img[r->pages[r->pos / SH1106_WIDTH]][r->pos % SH1106_WIDTH] ^= p[i + k];
+        i += len;
+    }
+    return true;
+}
+
+static fb_mirror_t m;
+static sh1106_fb_t fb;
+static rx_t rx;
+
+/* wysyła całą ramkę pakietami cap B; zwraca bajty */
+static size_t send_frame(size_t cap, unsigned *pkts)
+{
+    uint8_t pkt[256];
+    size_t n, total = 0;
+    bool ok = true, end = false;
+
+    *pkts = 0;
+    while ((n = fb_mirror_next(&m, pkt, cap)) != 0) {
+        if (n > cap) ok = false;
+        if (!rx_feed(&rx, pkt, n)) ok = false;
+        end = pkt[1] & FB_MIRROR_END;
+        total += n;
+        (*pkts)++;
+    }
+    CHECK(ok);
+    CHECK(end);
+    return total;
+}
+
+static void scribble(uint32_t *rng, int strokes)
+{
+    for (int i = 0; i < strokes; i++) {
+        uint32_t r = test_rand(rng);
+        fb.page[r % SH1106_PAGES][(r >> 8) % SH1106_WIDTH] ^= (uint8_t)(r >> 16);
+        fb.dirty |= 1u << (r % SH1106_PAGES);
+    }
+}
+
+static void test_roundtrip(void)
+{
+    uint32_t rng = 77;
+    unsigned pkts;
+    int64_t now = 0;
+    bool same = true;
+
+    memset(&rx, 0, sizeof(rx));
+    sh1106_fb_clear(&fb);
+    fb_mirror_init(&m, 0);
+
+    for (int f = 0; f < 500; f++) {
+        scribble(&rng, f % 10 == 0 ? 400 : 1 + f % 7);
+        fb_mirror_note(&m, fb.dirty);
+        fb.dirty = 0;
+        now += 100000;
+        if (!fb_mirror_begin(&m, &fb, now)) continue;
+        send_frame(20 + f % 60, &pkts);             /* MTU 23 .. 82 */
+        if (memcmp(rx.img, fb.page, sizeof(rx.img)) != 0) same = false;
+    }
+    CHECK(same);
+    CHECK(m.keys == 1);
+}
+
+static void test_small_change_is_small(void)
+{
+    unsigned pkts;
+
+    memset(&rx, 0, sizeof(rx));
+    sh1106_fb_clear(&fb);
+    fb_mirror_init(&m, 0);
+    CHECK(fb_mirror_begin(&m, &fb, 0));             /* pusty ekran, ramka kluczowa */
+    CHECK(send_frame(20, &pkts) < 20);              /* same zera prawie nic */
+
+    fb.page[3][40] = 0x3C;
+    fb.page[3][41] = 0x42;
+    fb_mirror_note(&m, 1u << 3);
+    CHECK(fb_mirror_begin(&m, &fb, 1));
+    CHECK(send_frame(20, &pkts) < 10 && pkts == 1);
+    CHECK(memcmp(rx.img, fb.page, sizeof(rx.img)) == 0);
+
+    /* przerysowanie tym samym – nic do wysłania */
+    fb_mirror_note(&m, 1u << 3);
+    CHECK(!fb_mirror_begin(&m, &fb, 2));
+}
+
+static void test_key_after_loss(void)
+{
+    uint8_t pkt[64];
+    unsigned pkts;
+    uint32_t rng = 5;
+
+    memset(&rx, 0, sizeof(rx));
+    sh1106_fb_clear(&fb);
+    fb_mirror_init(&m, 0);
+    scribble(&rng, 300);
+    fb_mirror_begin(&m, &fb, 0);
+    send_frame(20, &pkts);
+
+    /* zgubiony pakiet: odbiorca traci synchronizację */
+    scribble(&rng, 300);
+    fb_mirror_note(&m, 0xFF);
+    fb_mirror_begin(&m, &fb, 1);
+    fb_mirror_next(&m, pkt, sizeof(pkt));           /* nie doszedł */
+    size_t n = fb_mirror_next(&m, pkt, sizeof(pkt));
+    CHECK(!rx_feed(&rx, pkt, n));
+
+    fb_mirror_key(&m);
+    CHECK(!fb_mirror_busy(&m));
+    CHECK(fb_mirror_begin(&m, &fb, 2));
+    CHECK(m.frame_key && m.mask == 0xFF);
+    send_frame(20, &pkts);
+    CHECK(rx.synced && memcmp(rx.img, fb.page, sizeof(rx.img)) == 0);
+}
+
+/* transport jak BLE/ble_fb_mirror.c: budget = wolne bufory msys */
+typedef struct {
+    int      budget;
+    unsigned sent, refused, lost;
+    bool     lose_next;             /* notify nie przyjął pakietu */
+    bool     ok;
+} tx_t;
+
+static bool tx_send(void *ctx, const uint8_t *pkt, size_t len)
+{
+    tx_t *t = ctx;
+    if (t->budget == 0) {
+        t->refused++;
+        return false;
+    }
+    t->budget--;
+    if (t->lose_next) {
+        t->lose_next = false;
+        t->lost++;
+        fb_mirror_key(&m);
+        return true;
+    }
+    if (!rx_feed(&rx, pkt, len)) t->ok = false;
+    t->sent++;
+    return true;
+}
+
+/* klatka jak ble_fb_mirror_frame: ramka w toku najpierw dochodzi */
+static bool tx_frame(tx_t *t, int64_t now)
+{
+    uint8_t buf[64];
+    fb_mirror_note(&m, fb.dirty);
+    fb.dirty = 0;
+    if (!fb_mirror_busy(&m) && !fb_mirror_begin(&m, &fb, now)) return false;
+    return fb_mirror_pump(&m, buf, 20, tx_send, t);
+}
+
+static void test_dry_mid_frame(void)
+{
+    uint8_t buf[64];
+    uint32_t rng = 11;
+    tx_t t = { .budget = 3, .ok = true };
+
+    memset(&rx, 0, sizeof(rx));
+    sh1106_fb_clear(&fb);
+    fb_mirror_init(&m, 0);
+    scribble(&rng, 400);
+
+    /* ramka kluczowa, bufory kończą się po trzech pakietach */
+    CHECK(tx_frame(&t, 0));
+    CHECK(fb_mirror_busy(&m) && t.sent == 3 && t.refused == 1);
+
+    /* nowa klatka nie zaczyna ramki, tylko dopycha starą */
+    uint8_t want[SH1106_PAGES][SH1106_WIDTH];
+    memcpy(want, fb.page, sizeof(want));
+    scribble(&rng, 50);
+    t.budget = 2;
+    CHECK(tx_frame(&t, 1));
+    CHECK(t.sent == 5 && m.frames == 1);
+
+    /* ponowienia z timera, po dwa bufory, aż ramka wyjdzie */
+    int retries = 0;
+    do {
+        t.budget = 2;
+        retries++;
+    } while (fb_mirror_pump(&m, buf, 20, tx_send, &t) && retries < 1000);
+    CHECK(!fb_mirror_busy(&m));
+    CHECK(t.ok && rx.synced);
+    CHECK(memcmp(rx.img, want, sizeof(want)) == 0);     /* nic nie zginęło */
+
+    /* następna klatka niesie zmiany z czasu oczekiwania */
+    t.budget = 1000;
+    CHECK(!tx_frame(&t, 2));
+    CHECK(m.frames == 2 && t.ok && memcmp(rx.img, fb.page, sizeof(rx.img)) == 0);
+
+    /* pakiet stracony w notify: ramka przerwana, następna kluczowa */
+    scribble(&rng, 300);
+    t.lose_next = true;
+    tx_frame(&t, 3);
+    CHECK(t.lost == 1 && !fb_mirror_busy(&m) && m.key);
+    CHECK(!tx_frame(&t, 4));
+    CHECK(m.frame_key && t.ok && rx.synced);
+    CHECK(memcmp(rx.img, fb.page, sizeof(rx.img)) == 0);
+}
+
+static void test_fps_limit(void)
+{
+    fb_mirror_init(&m, 200000);
+    sh1106_fb_clear(&fb);
+    CHECK(fb_mirror_begin(&m, &fb, 1000000));
+    while (fb_mirror_busy(&m)) {
+        uint8_t pkt[64];
+        fb_mirror_next(&m, pkt, sizeof(pkt));
+    }
+    fb.page[0][0] = 1;
+    fb_mirror_note(&m, 1);
+    CHECK(!fb_mirror_begin(&m, &fb, 1100000));      /* za wcześnie */
+    CHECK(fb_mirror_begin(&m, &fb, 1200000));       /* zmiana nie przepadła */
+}
+
+int main(void)
+{
+    test_roundtrip();
+    test_small_change_is_small();
+    test_key_after_loss();
+    test_dry_mid_frame();
+    test_fps_limit();
+    return test_summary("fb_mirror");
+}
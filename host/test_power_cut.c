@@ -0,0 +1,166 @@
+/* Zanik zasilania w losowym miejscu zapisu: dziennik przejazdu i migawka
+ * stanu po ponownym otwarciu mają wszystko, co zostało potwierdzone
+ * (zapis zwrócił ESP_OK), w kolejności i bez śmieci. Na koniec
+ * amplifikacja zapisu i liczba kasowań. */
+#include <string.h>
+#include "ride_log.h"
+#include "ride_reader.h"
+#include "state_snap.h"
+#include "flash_port_file.h"
+#include "test.h"
+#include "test_ride.h"
+
+/* Zanik najpóźniej po 8 stronach, potem nowy sektor: próba zajmuje
+ * najwyżej 2 sektory, więc pierścień się nie zawinie i nic potwierdzonego
+ * nie ma prawa zniknąć. */
+#define LOG_SIZE    (RIDE_READER_INDEX_MAX * FLASH_SECTOR_SIZE)
+#define TRIALS      200
+#define CUT_MAX     (8 * FLASH_PAGE_SIZE)
+#define PER_TRIAL   2000            /* więcej niż mieści 8 stron */
+#define N_MAX       (TRIALS * PER_TRIAL)
+
+static ride_sample_t appended[N_MAX];
+static bool   committed[N_MAX];         /* strona z próbką zapisana z ESP_OK */
+static size_t n_appended, n_committed;
+static char path[64];
+
+/* Próbki z flash w kolejności; muszą być podciągiem dopisanych
+ * i zawierać wszystkie potwierdzone. */
+static void verify_log(flash_port_t *fp)
+{
+    static ride_reader_t rd;
+    ride_iter_t it;
+    ride_sample_t s;
+    size_t i = 0, found = 0;
+    bool subseq = true;
+    int rc;
+
+    CHECK(ride_reader_open(&rd, fp) == ESP_OK);
+    ride_iter_begin(&it, &rd);
+    while ((rc = ride_iter_next(&it, &s)) != 0) {
+        if (rc < 0) continue;
+        while (i < n_appended && !test_same_sample(&appended[i], &s)) {
+            if (committed[i]) subseq = false;       /* potwierdzona zginęła */
+            i++;
+        }
+        if (i == n_appended) {
+            subseq = false;                         /* próbka znikąd */
+            break;
+        }
+        i++;
+        found++;
+    }
+    for (; i < n_appended; i++)
+        if (committed[i]) subseq = false;
+    CHECK(subseq);
+    CHECK(found >= n_committed);
+    ride_reader_close(&rd);
+}
+
+static void test_ride_log_power_cut(void)
+{
+    flash_port_t fp;
+    flash_file_t ff;
+    ride_log_t log;
+    ride_sample_t s = { 0 };
+    uint32_t rng = 12345;
+    uint64_t written = 0, erased = 0, payload = 0;
+    unsigned cuts = 0;
+
+    test_tmp_path(path, sizeof(path), "power_cut");
+    for (int trial = 0; trial < TRIALS; trial++) {
+        flash_port_file_open(&fp, &ff, path, LOG_SIZE);
+        CHECK(ride_log_open(&log, &fp) == ESP_OK);
+        size_t page_start = n_appended;         /* pierwsza próbka strony w RAM */
+
+        /* zasilanie zniknie po losowej liczbie bajtów, zwykle w środku strony */
+        ff.power_cut_after = 1 + test_rand(&rng) % CUT_MAX;
+        for (int k = 0; k < PER_TRIAL; k++) {
+            uint32_t pages = log.stats.pages_written;
+            test_ride_next(&s, &rng);
+            appended[n_appended++] = s;
+            if (ride_log_append(&log, &s) != ESP_OK) {
+                cuts++;
+                break;
+            }
+            /* strona zapisana przed dołożeniem tej próbki – jej próbki są trwałe */
+            if (log.stats.pages_written != pages) {
+                for (size_t k2 = page_start; k2 < n_appended - 1; k2++) committed[k2] = true;
+                n_committed += n_appended - 1 - page_start;
+                page_start = n_appended - 1;
+            }
+        }
+        written += fp.bytes_written;
+        erased += fp.sectors_erased;
+        payload += log.stats.payload_bytes;
+        flash_port_file_close(&fp);             /* bez flush – RAM przepada */
+
+        flash_port_file_open(&fp, &ff, path, LOG_SIZE);
+        verify_log(&fp);
+        flash_port_file_close(&fp);
+    }
+    CHECK(cuts == TRIALS);
+    unlink(path);
+
+    printf("ride_log: %u power cuts, %zu samples committed, %.2f B flash "
+           "per sample B, %.0f B written per erased sector\n",
+           cuts, n_committed, (double)written / payload,
+           erased ? (double)written / erased : 0.0);
+}
+
+static void test_state_snap_power_cut(void)
+{
+    flash_port_t fp;
+    flash_file_t ff;
+    state_store_t st;
+    state_snap_t s, got;
+    uint32_t rng = 99, committed = 0;
+    uint64_t written = 0, erased = 0, saves = 0, landed = 0;
+    bool ok = true;
+
+    test_tmp_path(path, sizeof(path), "snap_cut");
+    flash_port_file_open(&fp, &ff, path, 2 * FLASH_SECTOR_SIZE);
+    CHECK(state_snap_load(&st, &fp, &s) == ESP_ERR_NOT_FOUND);
+
+    for (int trial = 0; trial < 2000; trial++) {
+        /* kilka pełnych zapisów, potem jeden przerwany */
+        int n = test_rand(&rng) % 5;
+        for (int k = 0; k <= n; k++) {
+            s.odometer_m = ++committed;
+            if (k == n) ff.power_cut_after = 1 + test_rand(&rng) % (STATE_SNAP_REC_SIZE - 1);
+            if (state_snap_save(&st, &s) != ESP_OK) {
+                committed--;
+                break;
+            }
+            saves++;
+        }
+        ff.power_cut_after = 0;
+        written += fp.bytes_written;
+        erased += fp.sectors_erased;
+        flash_port_file_close(&fp);
+
+        flash_port_file_open(&fp, &ff, path, 2 * FLASH_SECTOR_SIZE);
+        /* potwierdzona wersja albo przerwana, jeśli zdążyła zapisać się cała */
+        if (state_snap_load(&st, &fp, &got) != ESP_OK ||
+            (got.odometer_m != committed && got.odometer_m != committed + 1))
+            ok = false;
+        if (got.odometer_m == committed + 1) landed++;
+        committed = got.odometer_m;
+        s = got;
+    }
+    CHECK(ok);
+    flash_port_file_close(&fp);
+    unlink(path);
+
+    printf("state_snap: %llu saves, %llu cut writes landed whole, %llu sector erases, "
+           "%.0f B written per erased sector\n",
+           (unsigned long long)saves, (unsigned long long)landed, (unsigned long long)erased,
+           erased ? (double)written / erased : 0.0);
+}
+
+int main(void)
+{
+    test_ride_log_power_cut();
+    test_state_snap_power_cut();
+    return test_summary("power_cut");
+}
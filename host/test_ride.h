@@ -0,0 +1,28 @@
+#pragma once
+#include "telem_codec.h"
+#include "test.h"
+
+/* Syntetyczny przejazd do testów dziennika: próbka co sekundę, jazda
+ * z wahaniami prędkości przeplatana postojami (serie zerowych różnic),
+ * czasem zgubiona próbka (skok czasu). */
+static inline void test_ride_next(ride_sample_t *s, uint32_t *rng)
+{
+    uint32_t r = test_rand(rng);
+
+    s->t_ms += r % 50 == 0 ? 3000 : 1000;
+    if (s->speed_ckmh == 0) {
+        if (r % 8 == 0) s->speed_ckmh = 800;            /* ruszamy */
+    } else if (r % 200 == 0) {
+        s->speed_ckmh = 0;                              /* postój */
+    } else {
+        int v = s->speed_ckmh + (int)(r >> 8) % 301 - 150;
+        s->speed_ckmh = (uint16_t)(v < 100 ? 100 : v > 6000 ? 6000 : v);
+    }
+    s->dist_m += s->speed_ckmh / 360;
+}
+
+/* Porównanie pól – ride_sample_t ma wypełnienie, memcmp odpada. */
+static inline bool test_same_sample(const ride_sample_t *a, const ride_sample_t *b)
+{
+    return a->t_ms == b->t_ms && a->speed_ckmh == b->speed_ckmh && a->dist_m == b->dist_m;
+}
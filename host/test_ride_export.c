@@ -0,0 +1,135 @@
+/* Przejazd 6 h przy 10 Hz: dziennik -> eksport CSV kawałkami notyfikacji
+ * -> parsowanie z powrotem. Sprawdza każdą linię, pamięć eksportu
+ * (stała, bez sterty) i mierzy przepustowość na pliku zamapowanym. */
+#include <string.h>
+#include <time.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "ride_log.h"
+#include "ride_reader.h"
+#include "ride_export.h"
+#include "flash_port_file.h"
+#include "test.h"
+#include "test_ride.h"
+
+#define RIDE_S      (6 * 3600)
+#define RATE_HZ     10
+#define N_SAMPLES   (RIDE_S * RATE_HZ)
+#define PART_SIZE   (256 * FLASH_SECTOR_SIZE)
+#define CHUNK       244                 /* MTU 247 - nagłówek ATT */
+
+static ride_sample_t all[N_SAMPLES];
+static char path[64];
+
+static double now_s(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static size_t heap_in_use(void)
+{
+#ifdef __GLIBC__
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+/* parser CSV po stronie odbiorcy: linia może być rozcięta między kawałki */
+typedef struct {
+    char   line[RIDE_EXPORT_LINE_MAX];
+    size_t len;
+    size_t rows;
+    bool   header, ok;
+} csv_rx_t;
+
+static void csv_line(csv_rx_t *c)
+{
+    c->line[c->len] = 0;
+    if (!c->header) {
+        c->header = true;
+        if (strcmp(c->line, "t_ms,speed_kmh,dist_m") != 0) c->ok = false;
+        return;
+    }
+    unsigned long t, d;
+    unsigned kmh, frac;
+    if (sscanf(c->line, "%lu,%u.%u,%lu", &t, &kmh, &frac, &d) != 4 || c->rows >= N_SAMPLES) {
+        c->ok = false;
+        return;
+    }
+    const ride_sample_t *s = &all[c->rows++];
+    if (t != s->t_ms || kmh * 100 + frac != s->speed_ckmh || d != s->dist_m) c->ok = false;
+}
+
+static void csv_feed(csv_rx_t *c, const uint8_t *p, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (p[i] == '\n') {
+            csv_line(c);
+            c->len = 0;
+        } else if (c->len < sizeof(c->line) - 1) {
+            c->line[c->len++] = p[i];
+        } else {
+            c->ok = false;
+        }
+    }
+}
+
+int main(void)
+{
+    flash_port_t fp;
+    flash_file_t ff;
+    ride_log_t log;
+    static ride_reader_t rd;
+    ride_sample_t s = { 0 };
+    uint32_t rng = 2024;
+
+    test_tmp_path(path, sizeof(path), "ride_export");
+    flash_port_file_open(&fp, &ff, path, PART_SIZE);
+    ride_log_open(&log, &fp);
+    for (size_t i = 0; i < N_SAMPLES; i++) {
+        test_ride_next(&s, &rng);           /* prędkość i dystans */
+        all[i] = s;
+        all[i].t_ms = (uint32_t)i * (1000 / RATE_HZ);
+        CHECK(ride_log_append(&log, &all[i]) == ESP_OK);
+    }
+    ride_log_flush(&log);
+    CHECK(ride_reader_open(&rd, &fp) == ESP_OK);
+
+    size_t heap0 = heap_in_use();
+    ride_export_t x;
+    csv_rx_t rx = { .ok = true };
+    uint8_t chunk[CHUNK];
+    size_t bytes = 0, n, chunks = 0;
+
+    double t0 = now_s();
+    ride_export_begin(&x, &rd, 0, 0);
+    while ((n = ride_export_read(&x, chunk, sizeof(chunk))) != 0) {
+        csv_feed(&rx, chunk, n);
+        bytes += n;
+        chunks++;
+    }
+    double dt = now_s() - t0;
+
+    CHECK(rx.ok && rx.header);
+    CHECK(rx.rows == N_SAMPLES);
+    CHECK(rx.len == 0);                 /* ostatnia linia zakończona */
+    size_t heap_delta = heap_in_use() - heap0;
+    CHECK(heap_delta == 0);             /* eksport nie alokuje */
+    CHECK(sizeof(ride_export_t) <= 128);
+
+    printf("6 h at %d Hz: %d samples, %zu B log, %zu B csv in %zu chunks\n",
+           RATE_HZ, N_SAMPLES, (size_t)log.stats.pages_written * FLASH_PAGE_SIZE, bytes, chunks);
+    printf("export + parse: %.1f MB/s csv, %.2f Msamples/s (file-backed mmap, this PC)\n",
+           bytes / dt / 1e6, N_SAMPLES / dt / 1e6);
+    printf("memory: export state %zu B, reader %zu B (index), chunk %d B, heap delta %zu B\n",
+           sizeof(ride_export_t), sizeof(ride_reader_t), CHUNK, heap_delta);
+
+    ride_reader_close(&rd);
+    flash_port_file_close(&fp);
+    unlink(path);
+    return test_summary("ride_export");
+}
@@ -0,0 +1,171 @@
+/* Testy dziennika przejazdu na pliku: zapis i odtworzenie, ciągłość
+ * numeracji stron i czasu po ponownym otwarciu, pierścień sektorów. */
+#include <string.h>
+#include "ride_log.h"
+#include "flash_port_file.h"
+#include "test.h"
+#include "test_ride.h"
+
+#define PART_SIZE   (8 * FLASH_SECTOR_SIZE)
+
+static char path[64];
+
+/* wszystkie poprawne strony od najstarszej: liczba próbek i ostatnia */
+static uint32_t count_samples(flash_port_t *fp, uint32_t *pages, ride_sample_t *last)
+{
+    uint8_t page[FLASH_PAGE_SIZE];
+    uint32_t n = 0;
+
+    *pages = 0;
+    for (uint32_t off = 0; off < fp->size; off += FLASH_PAGE_SIZE) {
+        ride_log_page_hdr_t h;
+        fp->read(fp, off, page, sizeof(page));
+        if (!ride_log_page_valid(page, &h)) continue;
+
+        telem_dec_t d;
+        ride_sample_t s;
+        uint32_t k = 0;
+        telem_dec_init(&d, page + RIDE_LOG_HDR_SIZE, h.len);
+        while (telem_dec_next(&d, &s) == 1) {
+            k++;
+            if (last && s.t_ms > last->t_ms) *last = s;
+        }
+        CHECK(k == h.count);
+        n += k;
+        (*pages)++;
+    }
+    return n;
+}
+
+static void test_empty(void)
+{
+    flash_port_t fp;
+    flash_file_t ff;
+    ride_log_t log;
+
+    test_tmp_path(path, sizeof(path), "ride_log");
+    CHECK(flash_port_file_open(&fp, &ff, path, PART_SIZE) == ESP_OK);
+    CHECK(ride_log_open(&log, &fp) == ESP_OK);
+    CHECK(log.write_off == 0 && log.seq == 0 && log.last_t_ms == 0);
+    CHECK(ride_log_flush(&log) == ESP_OK);          /* nic do zapisu */
+    CHECK(fp.bytes_written == 0);
+    flash_port_file_close(&fp);
+    unlink(path);
+}
+
+static void test_append_reopen(void)
+{
+    flash_port_t fp;
+    flash_file_t ff;
+    ride_log_t log;
+    ride_sample_t s = { 0 }, last = { 0 };
+    uint32_t rng = 3, pages;
+
+    test_tmp_path(path, sizeof(path), "ride_log");
+    flash_port_file_open(&fp, &ff, path, PART_SIZE);
+    ride_log_open(&log, &fp);
+    for (int i = 0; i < 1000; i++) {
+        test_ride_next(&s, &rng);
+        CHECK(ride_log_append(&log, &s) == ESP_OK);
+    }
+    CHECK(ride_log_flush(&log) == ESP_OK);
+    CHECK(log.stats.samples == 1000);
+    uint32_t seq = log.seq, off = log.write_off;
+
+    CHECK(count_samples(&fp, &pages, &last) == 1000);
+    CHECK(pages == log.stats.pages_written);
+    CHECK(last.t_ms == s.t_ms && last.dist_m == s.dist_m);
+    flash_port_file_close(&fp);
+
+    /* po restarcie: ten sam punkt zapisu i czas ostatniej próbki */
+    flash_port_file_open(&fp, &ff, path, PART_SIZE);
+    CHECK(ride_log_open(&log, &fp) == ESP_OK);
+    CHECK(log.seq == seq && log.write_off == off);
+    CHECK(log.last_t_ms == s.t_ms);
+    CHECK(log.stats.torn_pages == 0);
+    flash_port_file_close(&fp);
+    unlink(path);
+}
+
+static void test_ring_wrap(void)
+{
+    flash_port_t fp;
+    flash_file_t ff;
+    ride_log_t log;
+    ride_sample_t s = { 0 }, last = { 0 };
+    uint32_t rng = 11, pages;
+
+    test_tmp_path(path, sizeof(path), "ride_log");
+    flash_port_file_open(&fp, &ff, path, PART_SIZE);
+    ride_log_open(&log, &fp);
+    /* kilka obiegów pierścienia */
+    for (int i = 0; i < 40000; i++) {
+        test_ride_next(&s, &rng);
+        CHECK(ride_log_append(&log, &s) == ESP_OK);
+    }
+    ride_log_flush(&log);
+    CHECK(fp.sectors_erased > PART_SIZE / FLASH_SECTOR_SIZE);
+
+    count_samples(&fp, &pages, &last);
+    CHECK(last.t_ms == s.t_ms);
+    /* najwyżej jeden sektor skasowany na zapas */
+    CHECK(pages >= (PART_SIZE - FLASH_SECTOR_SIZE) / FLASH_PAGE_SIZE);
+    flash_port_file_close(&fp);
+
+    flash_port_file_open(&fp, &ff, path, PART_SIZE);
+    ride_log_open(&log, &fp);
+    CHECK(log.last_t_ms == s.t_ms);
+    /* dopisywanie dalej nie psuje najnowszych danych */
+    test_ride_next(&s, &rng);
+    ride_log_append(&log, &s);
+    ride_log_flush(&log);
+    count_samples(&fp, &pages, &last);
+    CHECK(last.t_ms == s.t_ms);
+    flash_port_file_close(&fp);
+    unlink(path);
+}
+
+static void test_torn_page_skipped(void)
+{
+    flash_port_t fp;
+    flash_file_t ff;
+    ride_log_t log;
+    ride_sample_t s = { 0 };
+    uint32_t rng = 5;
+
+    test_tmp_path(path, sizeof(path), "ride_log");
+    flash_port_file_open(&fp, &ff, path, PART_SIZE);
+    ride_log_open(&log, &fp);
+    for (int i = 0; i < 300; i++) {
+        test_ride_next(&s, &rng);
+        ride_log_append(&log, &s);
+    }
+    ride_log_flush(&log);
+    for (int i = 0; i < 300; i++) {
+        test_ride_next(&s, &rng);
+        ride_log_append(&log, &s);
+    }
+    uint32_t good_seq = log.seq;
+
+    /* zanik zasilania w połowie programowania niepełnej strony */
+    ff.power_cut_after = FLASH_PAGE_SIZE / 2;
+    CHECK(ride_log_flush(&log) != ESP_OK);
+    flash_port_file_close(&fp);
+
+    flash_port_file_open(&fp, &ff, path, PART_SIZE);
+    ride_log_open(&log, &fp);
+    CHECK(log.stats.torn_pages == 1);
+    CHECK(log.seq == good_seq);
+    CHECK(log.write_off % FLASH_SECTOR_SIZE == 0);  /* nowy sektor za przerwaną stroną */
+    flash_port_file_close(&fp);
+    unlink(path);
+}
+
+int main(void)
+{
+    test_empty();
+    test_append_reopen();
+    test_ring_wrap();
+    test_torn_page_skipped();
+    return test_summary("ride_log");
+}
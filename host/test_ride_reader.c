@@ -0,0 +1,180 @@
+/* Testy czytnika i eksportu: pełny przebieg w kolejności zapisu,
+ * wyszukiwanie po czasie, podsumowanie zakresu, eksport CSV zgodny
+ * z próbkami. */
+#include <stdlib.h>
+#include <string.h>
+#include "ride_log.h"
+#include "ride_reader.h"
+#include "ride_export.h"
+#include "flash_port_file.h"
+#include "test.h"
+#include "test_ride.h"
+
+#define PART_SIZE   (16 * FLASH_SECTOR_SIZE)
+#define N_SAMPLES   50000               /* więcej niż mieści partycja */
+
+static ride_sample_t all[N_SAMPLES];
+static char path[64];
+static flash_port_t fp;
+static flash_file_t ff;
+static ride_reader_t rd;
+static size_t first_kept;               /* najstarsza próbka w pierścieniu */
+
+static void setup(void)
+{
+    ride_log_t log;
+    ride_sample_t s = { 0 };
+    uint32_t rng = 9;
+
+    test_tmp_path(path, sizeof(path), "ride_reader");
+    flash_port_file_open(&fp, &ff, path, PART_SIZE);
+    ride_log_open(&log, &fp);
+    for (size_t i = 0; i < N_SAMPLES; i++) {
+        test_ride_next(&s, &rng);
+        all[i] = s;
+        ride_log_append(&log, &s);
+    }
+    ride_log_flush(&log);
+    CHECK(ride_reader_open(&rd, &fp) == ESP_OK);
+}
+
+static void test_iterate_all(void)
+{
+    ride_iter_t it;
+    ride_sample_t s;
+    size_t n = 0, i = 0;
+    bool in_order = true;
+
+    ride_iter_begin(&it, &rd);
+    while (ride_iter_next(&it, &s) == 1) {
+        if (n == 0) {
+            while (i < N_SAMPLES && all[i].t_ms != s.t_ms) i++;
+            first_kept = i;
+        }
+        if (i >= N_SAMPLES || !test_same_sample(&s, &all[i])) in_order = false;
+        i++;
+        n++;
+    }
+    CHECK(in_order);
+    CHECK(i == N_SAMPLES);              /* kończy się na ostatniej zapisanej */
+    CHECK(first_kept > 0);              /* najstarsze nadpisane */
+    CHECK(rd.n_index >= PART_SIZE / FLASH_SECTOR_SIZE - 1);
+}
+
+static void test_seek(void)
+{
+    ride_iter_t it;
+    ride_sample_t s;
+    uint32_t rng = 21;
+
+    for (int k = 0; k < 200; k++) {
+        size_t i = first_kept + test_rand(&rng) % (N_SAMPLES - first_kept);
+        uint32_t t = all[i].t_ms - (k & 1);     /* trafienie i czas między próbkami */
+        ride_iter_begin(&it, &rd);
+        ride_iter_seek(&it, t);
+        CHECK(ride_iter_next(&it, &s) == 1 && s.t_ms >= t);
+        CHECK(s.t_ms == all[i].t_ms);
+    }
+
+    /* przed początkiem – pierwsza zachowana, za końcem – nic */
+    ride_iter_begin(&it, &rd);
+    ride_iter_seek(&it, 0);
+    CHECK(ride_iter_next(&it, &s) == 1 && s.t_ms == all[first_kept].t_ms);
+    ride_iter_begin(&it, &rd);
+    ride_iter_seek(&it, all[N_SAMPLES - 1].t_ms + 1);
+    CHECK(ride_iter_next(&it, &s) == 0);
+}
+
+/* podsumowanie liczone wprost z próbek [from, to) */
+static void expect_summary(size_t from, size_t to, ride_summary_t *e)
+{
+    memset(e, 0, sizeof(*e));
+    for (size_t i = from; i < to; i++) {
+        if (i > from && all[i - 1].speed_ckmh > 0)
+            e->moving_ms += all[i].t_ms - all[i - 1].t_ms;
+        if (all[i].speed_ckmh > e->max_ckmh) e->max_ckmh = all[i].speed_ckmh;
+        e->samples++;
+    }
+    if (e->samples) {
+        e->t_first_ms = all[from].t_ms;
+        e->t_last_ms = all[to - 1].t_ms;
+        e->dist_m = all[to - 1].dist_m - all[from].dist_m;
+    }
+}
+
+static bool same_summary(const ride_summary_t *a, const ride_summary_t *b)
+{
+    return a->samples == b->samples && a->t_first_ms == b->t_first_ms &&
+           a->t_last_ms == b->t_last_ms && a->moving_ms == b->moving_ms &&
+           a->dist_m == b->dist_m && a->max_ckmh == b->max_ckmh;
+}
+
+static void test_summary_range(void)
+{
+    ride_summary_t got, want;
+    uint32_t rng = 33;
+
+    /* cały dziennik – tak liczy odczyt charakterystyki BLE */
+    ride_reader_summary(&rd, 0, UINT32_MAX, &got);
+    expect_summary(first_kept, N_SAMPLES, &want);
+    CHECK(same_summary(&got, &want));
+    CHECK(got.samples > 0 && got.moving_ms > 0 && got.max_ckmh > 0);
+
+    for (int k = 0; k < 50; k++) {
+        size_t a = first_kept + test_rand(&rng) % (N_SAMPLES - first_kept);
+        size_t b = a + test_rand(&rng) % (N_SAMPLES - a + 1);
+        uint32_t t_to = b < N_SAMPLES ? all[b].t_ms : UINT32_MAX;
+        ride_reader_summary(&rd, all[a].t_ms, t_to, &got);
+        expect_summary(a, b, &want);
+        CHECK(same_summary(&got, &want));
+    }
+
+    /* pusty zakres */
+    ride_reader_summary(&rd, all[N_SAMPLES - 1].t_ms + 1, UINT32_MAX, &got);
+    CHECK(got.samples == 0 && got.dist_m == 0 && got.moving_ms == 0);
+}
+
+static void test_export_csv(void)
+{
+    ride_export_t x;
+    static char csv[4 * 1024 * 1024];
+    size_t len = 0, n;
+    size_t from = N_SAMPLES - 1000, to = N_SAMPLES - 10;
+
+    /* kawałki różnej wielkości, jak notyfikacje przy różnym MTU */
+    ride_export_begin(&x, &rd, all[from].t_ms, all[to].t_ms);
+    for (size_t cap = 1; (n = ride_export_read(&x, (uint8_t *)csv + len, cap)) != 0;
+         cap = cap % 244 + 1)
+        len += n;
+    csv[len] = 0;
+    CHECK(x.bytes == len);
+    CHECK(ride_export_read(&x, (uint8_t *)csv, 16) == 0);
+
+    char *line = strtok(csv, "\n");
+    CHECK(line && strcmp(line, "t_ms,speed_kmh,dist_m") == 0);
+    size_t i = from;
+    bool ok = true;
+    while ((line = strtok(NULL, "\n")) != NULL) {
+        unsigned long t, d;
+        unsigned kmh, frac;
+        if (sscanf(line, "%lu,%u.%u,%lu", &t, &kmh, &frac, &d) != 4 || i >= to ||
+            t != all[i].t_ms || kmh * 100 + frac != all[i].speed_ckmh || d != all[i].dist_m)
+            ok = false;
+        i++;
+    }
+    CHECK(ok);
+    CHECK(i == to);                     /* [from, to) */
+}
+
+int main(void)
+{
+    setup();
+    test_iterate_all();
+    test_seek();
+    test_summary_range();
+    test_export_csv();
+    ride_reader_close(&rd);
+    flash_port_file_close(&fp);
+    unlink(path);
+    return test_summary("ride_reader");
+}
@@ -0,0 +1,138 @@
+/* Testy kodeka telemetrii: wierność, serie, skrajne wartości,
+ * kontrakt pojemności bufora i uszkodzone strumienie. */
+#include <string.h>
+#include "telem_codec.h"
+#include "test.h"
+#include "test_ride.h"
+
+#define N_MAX 4096
+
+static uint8_t buf[N_MAX * TELEM_ENC_MAX_BYTES + TELEM_RUN_MAX_BYTES];
+
+static size_t encode(const ride_sample_t *in, size_t n)
+{
+    telem_enc_t e;
+    size_t len = 0;
+
+    telem_enc_reset(&e);
+    for (size_t i = 0; i < n; i++) {
+        int k = telem_enc_put(&e, &in[i], buf + len, sizeof(buf) - len);
+        CHECK(k >= 0);
+        len += k;
+    }
+    int k = telem_enc_flush(&e, buf + len, sizeof(buf) - len);
+    CHECK(k >= 0);
+    return len + k;
+}
+
+/* dekoduje i porównuje z wejściem; zwraca liczbę zgodnych próbek */
+static size_t check_decode(const ride_sample_t *in, size_t n, size_t len)
+{
+    telem_dec_t d;
+    ride_sample_t s;
+    size_t i = 0;
+
+    telem_dec_init(&d, buf, len);
+    while (telem_dec_next(&d, &s) == 1) {
+        if (i >= n || !test_same_sample(&s, &in[i])) break;
+        i++;
+    }
+    CHECK(telem_dec_next(&d, &s) == 0);
+    return i;
+}
+
+static ride_sample_t in[N_MAX];
+
+static void test_roundtrip_ride(void)
+{
+    uint32_t rng = 1;
+    ride_sample_t s = { 0 };
+    for (size_t i = 0; i < N_MAX; i++) {
+        test_ride_next(&s, &rng);
+        in[i] = s;
+    }
+    size_t len = encode(in, N_MAX);
+    CHECK(check_decode(in, N_MAX, len) == N_MAX);
+    CHECK(len < N_MAX * sizeof(ride_sample_t) / 2);
+}
+
+static void test_runs_collapse(void)
+{
+    /* postój: stały krok czasu, zero prędkości i dystansu */
+    for (size_t i = 0; i < 1000; i++)
+        in[i] = (ride_sample_t){ .t_ms = 1000 * (uint32_t)i, .dist_m = 500 };
+    size_t len = encode(in, 1000);
+    CHECK(check_decode(in, 1000, len) == 1000);
+    CHECK(len < 20);                    /* dwie klatki startowe + jedna seria */
+
+    /* równa jazda: stały przyrost dystansu też zwija się w serię */
+    for (size_t i = 0; i < 1000; i++)
+        in[i] = (ride_sample_t){ .t_ms = 1000 * (uint32_t)i, .speed_ckmh = 2520,
+                                 .dist_m = 7 * (uint32_t)i };
+    len = encode(in, 1000);
+    CHECK(check_decode(in, 1000, len) == 1000);
+    CHECK(len < 24);                    /* + krok dystansu przy trzeciej */
+}
+
+static void test_extremes(void)
+{
+    /* skoki przez całe zakresy pól i przekręcenie licznika czasu */
+    const ride_sample_t x[] = {
+        { 0, 0, 0 },
+        { UINT32_MAX, UINT16_MAX, UINT32_MAX },
+        { 0, 0, 0 },
+        { 0x80000000u, 1, 0x80000000u },
+        { 0x7FFFFFFFu, UINT16_MAX, 1 },
+        { 5, 0, UINT32_MAX },
+        { 5, 0, UINT32_MAX },
+    };
+    size_t n = sizeof(x) / sizeof(x[0]);
+    memcpy(in, x, sizeof(x));
+    size_t len = encode(in, n);
+    CHECK(check_decode(in, n, len) == n);
+}
+
+static void test_capacity_contract(void)
+{
+    telem_enc_t e, before;
+    uint8_t small[TELEM_ENC_MAX_BYTES - 1];
+    ride_sample_t s = { 1000, 2500, 7 };
+
+    telem_enc_reset(&e);
+    before = e;
+    CHECK(telem_enc_put(&e, &s, small, sizeof(small)) == -1);
+    CHECK(memcmp(&e, &before, sizeof(e)) == 0);         /* stan bez zmian */
+}
+
+static void test_truncated_stream(void)
+{
+    uint32_t rng = 7;
+    ride_sample_t s = { 0 }, out;
+    for (size_t i = 0; i < 64; i++) {
+        test_ride_next(&s, &rng);
+        in[i] = s;
+    }
+    size_t len = encode(in, 64);
+
+    /* ucięty w środku varintu: dekoder nie czyta poza bufor, zgłasza błąd */
+    telem_dec_t d;
+    uint8_t last = buf[len - 1];
+    buf[len - 1] |= 0x80;
+    telem_dec_init(&d, buf, len);
+    int rc;
+    size_t ok = 0;
+    while ((rc = telem_dec_next(&d, &out)) == 1) ok++;
+    CHECK(rc == -1);
+    CHECK(ok < 64);
+    buf[len - 1] = last;
+}
+
+int main(void)
+{
+    test_roundtrip_ride();
+    test_runs_collapse();
+    test_extremes();
+    test_capacity_contract();
+    test_truncated_stream();
+    return test_summary("telem_codec");
+}
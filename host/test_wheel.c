@@ -0,0 +1,68 @@
+/* Testy czujnika koła: filtr drgań, okres i prędkość, wznowienie po
+ * postoju, liczniki przejazdu bez gubienia ułamków. */
+#include <math.h>
+#include "wheel.h"
+#include "test.h"
+
+static void test_debounce(void)
+{
+    wheel_t w = { 0 };
+
+    CHECK(wheel_pulse(&w, 1000000) == 1000000);
+    CHECK(wheel_pulse(&w, 1000000 + WHEEL_DEBOUNCE_US - 1) == 0);      /* drganie */
+    CHECK(w.bounces == 1 && w.revs == 1);
+    CHECK(wheel_pulse(&w, 1300000) == 300000);
+    CHECK(w.period_us == 300000 && w.revs == 2);
+}
+
+static void test_speed(void)
+{
+    /* 2100 mm w 300 ms = 7 m/s = 25.2 km/h */
+    CHECK(fabsf(wheel_speed_kmh(300000, 0, 100000, 2100) - 25.2f) < 0.01f);
+    CHECK(wheel_speed_kmh(0, 0, 0, 2100) == 0.0f);
+    CHECK(wheel_speed_kmh(300000, 0, WHEEL_STOP_US + 1, 2100) == 0.0f);
+}
+
+static void test_restart_after_stop(void)
+{
+    wheel_t w = { 0 };
+
+    wheel_pulse(&w, 1000000);
+    wheel_pulse(&w, 1300000);
+    /* długi postój: pierwszy impuls nie może dać prędkości z czasu stania */
+    int64_t t = 1300000 + 10 * WHEEL_STOP_US;
+    wheel_pulse(&w, t);
+    CHECK(w.period_us == 0);
+    CHECK(wheel_speed_kmh(w.period_us, w.last_us, t, 2100) == 0.0f);
+    wheel_pulse(&w, t + 400000);
+    CHECK(w.period_us == 400000);
+}
+
+static void test_trip(void)
+{
+    wheel_trip_t tr;
+    state_snap_t s;
+
+    state_snap_defaults(&s);           /* 2105 mm */
+    wheel_trip_init(&tr, 0, 0);
+
+    /* 1000 obrotów po jednym, co 250 ms: 2105 m, 250 s jazdy */
+    for (uint32_t r = 1; r <= 1000; r++)
+        wheel_trip_update(&tr, &s, r, 30.5f, (int64_t)r * 250000);
+    CHECK(s.trip_dist_m == 2105 && s.odometer_m == 2105);
+    CHECK(s.trip_time_s == 250);
+    CHECK(s.trip_max_ckmh == 3050);
+
+    /* postój nie dolicza czasu jazdy */
+    wheel_trip_update(&tr, &s, 1000, 0.0f, 1000 * 250000 + 60000000LL);
+    CHECK(s.trip_time_s == 250);
+}
+
+int main(void)
+{
+    test_debounce();
+    test_speed();
+    test_restart_after_stop();
+    test_trip();
+    return test_summary("wheel");
+}
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include "sdkconfig.h"
+
+#if CONFIG_TOPO_JITTER_BENCH
+
+#include "driver/ledc.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "soc/io_mux_reg.h"
+#include "soc/gpio_periph.h"
+#include "topology.h"
+#include "jitter_bench.h"
+
+#define BENCH_HZ        CONFIG_TOPO_JITTER_BENCH_HZ
+#define NOMINAL_US      (1000000 / BENCH_HZ)
+#define ERR_BUCKETS     12      /* 2^i µs; ostatni: >= 2 ms */
+
+static const char *TAG = "JITTER";
+
+static volatile uint32_t n, sum_us, max_us;
+static volatile uint32_t bucket[ERR_BUCKETS];
+static volatile uint8_t  isr_core;
+
+void jitter_bench_start(gpio_num_t pin)
+{
+    ledc_timer_config_t tc = {
+        .speed_mode = LEDC_LOW_SPEED_MODE,
+        .duty_resolution = LEDC_TIMER_13_BIT,
+        .timer_num = LEDC_TIMER_0,
+        .freq_hz = BENCH_HZ,
+        .clk_cfg = LEDC_AUTO_CLK,
+    };
+    ledc_channel_config_t cc = {
+        .gpio_num = pin,
+        .speed_mode = LEDC_LOW_SPEED_MODE,
+        .channel = LEDC_CHANNEL_0,
+        .timer_sel = LEDC_TIMER_0,
+        .duty = 1 << 12,        /* 50% */
+    };
+    ESP_ERROR_CHECK(ledc_timer_config(&tc));
+    ESP_ERROR_CHECK(ledc_channel_config(&cc));
+    // LEDC ustawia pin jako wyjście – włączamy z powrotem wejście dla ISR
+    PIN_INPUT_ENABLE(GPIO_PIN_MUX_REG[pin]);
+    ESP_LOGI(TAG, "LEDC %d Hz on GPIO%d, %s", BENCH_HZ, pin,
+             CONFIG_TOPO_PINNED ? "pinned topology" : "no affinity");
+}
+
+void IRAM_ATTR jitter_bench_sample(int64_t period_us)
+{
+    int64_t d = period_us - NOMINAL_US;
+    uint32_t err = (uint32_t)(d < 0 ? -d : d);
+    int b = 0;
+
+    while (b < ERR_BUCKETS - 1 && (err >> (b + 1)) != 0) b++;
+    bucket[b]++;
+    n++;
+    sum_us += err;
+    if (err > max_us) max_us = err;
+    isr_core = esp_cpu_get_core_id();
+}
+
+void jitter_bench_report(void)
+{
+    char line[ERR_BUCKETS * 7 + 1];
+    int o = 0;
+
+    for (int b = 0; b < ERR_BUCKETS; b++)
+        o += snprintf(line + o, sizeof(line) - o, " %lu", (unsigned long)bucket[b]);
+    ESP_LOGI(TAG, "ISR core %u, n %lu, |err| avg %lu us max %lu us |%s",
+             isr_core, (unsigned long)n,
+             (unsigned long)(n ? sum_us / n : 0), (unsigned long)max_us, line);
+}
+
+#endif /* CONFIG_TOPO_JITTER_BENCH */
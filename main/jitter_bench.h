@@ -0,0 +1,14 @@
+#pragma once
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "sdkconfig.h"
+
+/* Pomiar rozrzutu okresu impulsów (CONFIG_TOPO_JITTER_BENCH).
+ * LEDC generuje na pinie kontaktronu przebieg o stałej częstotliwości,
+ * ISR podaje zmierzony okres, raport pokazuje błąd względem nominału. */
+
+#if CONFIG_TOPO_JITTER_BENCH
+void jitter_bench_start(gpio_num_t pin);
+void jitter_bench_sample(int64_t period_us);   /* z ISR */
+void jitter_bench_report(void);
+#endif
@@ -2,7 +2,22 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_timer.h"
 #include "sh1106.h"
+#include "state_snap.h"
+#include "speed_hist.h"
+#include "ui_widget.h"
+#include "ui_menu.h"
+#include "ride_screen.h"
+#include "frame_pacer.h"
+#include "wheel.h"
+#include "perf.h"
+#include "trace.h"
+#include "topology.h"
+#include "jitter_bench.h"
+#include "power.h"
+#include "heap_guard.h"
 
 // --- Definicje pinów ---
 #define MAG_SENSOR_PIN    GPIO_NUM_2
@@ -10,26 +25,153 @@
 #define ENCODER_B_PIN     GPIO_NUM_4
 #define ENCODER_BTN_PIN   GPIO_NUM_5
 
+// Magistrala wyświetlacza nie może dzielić pinów z czujnikiem i enkoderem
+#if CONFIG_SH1106_BUS_I2C
+#define DISPLAY_PIN(p)    ((p) == CONFIG_SH1106_I2C_SDA || (p) == CONFIG_SH1106_I2C_SCL)
+#else
+#define DISPLAY_PIN(p)    ((p) == CONFIG_SH1106_SPI_MOSI || (p) == CONFIG_SH1106_SPI_SCLK || \
+                           (p) == CONFIG_SH1106_SPI_CS || (p) == CONFIG_SH1106_SPI_DC || \
+                           (p) == CONFIG_SH1106_SPI_RST)
+#endif
+_Static_assert(!DISPLAY_PIN(MAG_SENSOR_PIN),  "MAG_SENSOR_PIN collides with the SH1106 bus");
+_Static_assert(!DISPLAY_PIN(ENCODER_A_PIN),   "ENCODER_A_PIN collides with the SH1106 bus");
+_Static_assert(!DISPLAY_PIN(ENCODER_B_PIN),   "ENCODER_B_PIN collides with the SH1106 bus");
+_Static_assert(!DISPLAY_PIN(ENCODER_BTN_PIN), "ENCODER_BTN_PIN collides with the SH1106 bus");
+
+// --- Przejazd ---
+#define SNAP_PERIOD_US    60000000  // zapis migawki w trakcie jazdy
+#define SETTINGS_SAVE_US  5000000   // ustawienia z menu zapisujemy po chwili spokoju
+
+// --- Enkoder ---
+#define BTN_DEBOUNCE_US   30000
+
+// --- Wykres prędkości ---
+#define HIST_PERIOD_US    1000000   // jedna próbka historii na sekundę
+#define UI_STATS_US       60000000  // statystyki widgetów co minutę
+
+static const char *TAG = "MAIN";
+
 // --- Zmienne enkodera ---
-volatile int encoder_dir = 0; // -1 = lewo, 1 = prawo, 0 = brak ruchu
-volatile int encoder_btn = 1;
+static volatile int      encoder_steps = 0;     // detenty od ostatniej klatki, + = prawo
+static volatile int      encoder_presses = 0;
+static volatile int64_t  encoder_btn_us = 0;
+static portMUX_TYPE      enc_mux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t      ui_task;               // budzony przez ISR enkodera
+
+// --- Zmienne czujnika koła ---
+static wheel_t           wheel;                 // pod wheel_mux
+static volatile int64_t  wake_pulse_us = 0;     // pierwszy impuls po postoju
+static portMUX_TYPE      wheel_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// --- Stan licznika (przeżywa restart) ---
+static state_snap_t  snap;
+static state_store_t snap_store;
+static flash_port_t  snap_flash;
+
+// --- Ekran ---
+static sh1106_fb_t   fb;
+static speed_hist_t  hist;
+static ui_screen_t   screen;
+static frame_pacer_t pacer;
+
+static const pacer_cfg_t pacer_cfg = {
+    .min_frame_us = 1000000 / CONFIG_SH1106_MAX_FPS,
+    .heartbeat_us = CONFIG_SH1106_HEARTBEAT_MS * 1000,
+    .dim_us       = CONFIG_SH1106_DIM_S * 1000000u,
+    .off_us       = CONFIG_SH1106_OFF_S * 1000000u,
+};
+
+// --- Menu ---
+static const char *const unit_opts[]     = { "km", "mi" };
+static const char *const ble_opts[]      = { "połącz.", "rozgł." };
+static const char *const contrast_opts[] = { "niska", "średnia", "wysoka", "maks." };
+static const uint8_t contrast_levels[]   = { 0x10, 0x50, 0x9F, 0xFF };
+
+static void trip_reset(void)
+{
+    snap.trip_dist_m = 0;
+    snap.trip_time_s = 0;
+    snap.trip_max_ckmh = 0;
+}
+
+static const menu_item_t settings_items[] = {
+    { .label = "Obwód koła", .kind = MENU_VALUE,  .num = { &snap.wheel_mm, 1000, 2400, 5, "mm" } },
+    { .label = "Jednostki",  .kind = MENU_CHOICE, .choice = { &snap.units, unit_opts, 2 } },
+    { .label = "BLE",        .kind = MENU_CHOICE, .choice = { &snap.ble_mode, ble_opts, 2 } },
+    { .label = "Jasność",    .kind = MENU_CHOICE, .choice = { &snap.contrast, contrast_opts, 4 } },
+    { .label = "Wróć",       .kind = MENU_BACK },
+};
+static const menu_page_t settings_page = { "USTAWIENIA", settings_items, 5 };
+
+static const menu_item_t root_items[] = {
+    { .label = "Jazda",         .kind = MENU_BACK },
+    { .label = "Zeruj odcinek", .kind = MENU_ACTION,  .action = trip_reset },
+    { .label = "Ustawienia",    .kind = MENU_SUBMENU, .sub = &settings_page },
+};
+static const menu_page_t root_page = { "MENU", root_items, 3 };
+
+static ui_menu_t menu;
+static bool      settings_dirty;
+static int64_t   settings_changed_us;
+
+static void IRAM_ATTR wake_ui_from_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+    if (ui_task) vTaskNotifyGiveFromISR(ui_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
 
 // --- ISR enkodera ---
 static void IRAM_ATTR encoder_isr_handler(void* arg)
 {
-    int a = gpio_get_level(ENCODER_A_PIN);
+    // zbocze opadające A: stan B mówi o kierunku
     int b = gpio_get_level(ENCODER_B_PIN);
 
-    if (a != b)
-        encoder_dir = 1; // prawo
-    else
-        encoder_dir = -1; // lewo
+    portENTER_CRITICAL_ISR(&enc_mux);
+    encoder_steps += b ? 1 : -1;
+    portEXIT_CRITICAL_ISR(&enc_mux);
+    wake_ui_from_isr();
 }
 
 // --- ISR przycisku ---
 static void IRAM_ATTR button_isr_handler(void* arg)
 {
-    encoder_btn = gpio_get_level(ENCODER_BTN_PIN);
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL_ISR(&enc_mux);
+    if (now - encoder_btn_us >= BTN_DEBOUNCE_US) encoder_presses++;
+    encoder_btn_us = now;
+    portEXIT_CRITICAL_ISR(&enc_mux);
+    wake_ui_from_isr();
+}
+
+static void take_encoder(int *steps, int *presses)
+{
+    portENTER_CRITICAL(&enc_mux);
+    *steps = encoder_steps;
+    *presses = encoder_presses;
+    encoder_steps = 0;
+    encoder_presses = 0;
+    portEXIT_CRITICAL(&enc_mux);
+}
+
+// --- ISR czujnika koła ---
+static void IRAM_ATTR mag_isr_handler(void* arg)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL_ISR(&wheel_mux);
+    int64_t dt = wheel_pulse(&wheel, now);
+    if (dt) {
+        if (dt > WHEEL_STOP_US) wake_pulse_us = now;   // pierwszy impuls po postoju
+        PERF_PULSE(now);
+#if CONFIG_TOPO_JITTER_BENCH
+        jitter_bench_sample(dt);
+#endif
+    }
+    portEXIT_CRITICAL_ISR(&wheel_mux);
+    // nowy okres = nowa prędkość na ekranie; limit FPS pilnuje pacer
+    if (dt) wake_ui_from_isr();
 }
 
 // --- Inicjalizacja GPIO ---
@@ -40,39 +182,264 @@ void init_gpio()
     gpio_set_direction(ENCODER_B_PIN, GPIO_MODE_INPUT);
     gpio_set_direction(ENCODER_BTN_PIN, GPIO_MODE_INPUT);
 
+    gpio_set_pull_mode(MAG_SENSOR_PIN, GPIO_PULLUP_ONLY);
     gpio_set_pull_mode(ENCODER_A_PIN, GPIO_PULLUP_ONLY);
     gpio_set_pull_mode(ENCODER_B_PIN, GPIO_PULLUP_ONLY);
     gpio_set_pull_mode(ENCODER_BTN_PIN, GPIO_PULLUP_ONLY);
 
+    gpio_set_intr_type(MAG_SENSOR_PIN, GPIO_INTR_NEGEDGE);
+    gpio_set_intr_type(ENCODER_A_PIN, GPIO_INTR_NEGEDGE);
+    gpio_set_intr_type(ENCODER_BTN_PIN, GPIO_INTR_NEGEDGE);
+
     gpio_install_isr_service(0);
+    gpio_isr_handler_add(MAG_SENSOR_PIN, mag_isr_handler, NULL);
     gpio_isr_handler_add(ENCODER_A_PIN, encoder_isr_handler, NULL);
     gpio_isr_handler_add(ENCODER_BTN_PIN, button_isr_handler, NULL);
 }
 
-void app_main(void)
+// --- Migawka stanu ---
+static void restore_state(void)
+{
+    if (flash_port_esp_open(&snap_flash, "state") != ESP_OK) {
+        ESP_LOGW(TAG, "no state partition");
+        state_snap_defaults(&snap);
+        return;
+    }
+    if (state_snap_load(&snap_store, &snap_flash, &snap) != ESP_OK)
+        ESP_LOGI(TAG, "no saved state, using defaults");
+}
+
+static void save_state(void)
+{
+    if (snap_store.fp && state_snap_save(&snap_store, &snap) != ESP_OK)
+        ESP_LOGW(TAG, "state save failed");
+}
+
+static float current_speed(int64_t now, uint32_t *revs, int64_t *last_us)
+{
+    // 64-bitowe pola nie są atomowe na Xtensie
+    portENTER_CRITICAL(&wheel_mux);
+    int64_t period = wheel.period_us;
+    *last_us = wheel.last_us;
+    *revs = wheel.revs;
+    portEXIT_CRITICAL(&wheel_mux);
+
+    return wheel_speed_kmh(period, *last_us, now, snap.wheel_mm);
+}
+
+// --- Ustawienia z menu ---
+static void on_setting_changed(const menu_item_t *it)
+{
+    if (it->kind == MENU_CHOICE && it->choice.value == &snap.contrast)
+        sh1106_set_contrast(contrast_levels[snap.contrast]);
+    settings_dirty = true;
+    settings_changed_us = esp_timer_get_time();
+}
+
+static void log_ui_stats(void)
+{
+    for (unsigned i = 0; i < screen.count; i++) {
+        const ui_widget_stats_t *st = &screen.w[i].stats;
+        ESP_LOGI(TAG, "ui %-5s draws %lu last %lu us max %lu us area %u B",
+                 screen.w[i].name, (unsigned long)st->draws, (unsigned long)st->last_us,
+                 (unsigned long)st->max_us, st->dirty_bytes);
+    }
+
+    pacer_stats_t ps;
+    pacer_take_stats(&pacer, &ps);
+    // po SPI bus_us to tylko czas, w którym pętla czekała na DMA
+    ESP_LOGI(TAG, "frames %lu/min (%lu pages, held %lu, wakeups %lu) bus %lu ms, panel %s",
+             (unsigned long)ps.frames, (unsigned long)ps.pages, (unsigned long)ps.held,
+             (unsigned long)ps.wakeups, (unsigned long)(ps.bus_us / 1000),
+             pacer.panel == PANEL_ON ? "on" : pacer.panel == PANEL_DIM ? "dim" : "off");
+
+    sh1106_bus_stats_t bs;
+    sh1106_bus_stats(&bs);
+    ESP_LOGI(TAG, "bus %lu xfers, nack %lu timeout %lu other %lu, recoveries %lu backoffs %lu, "
+             "%lu Hz, lat avg %lu max %lu us",
+             (unsigned long)bs.xfers, (unsigned long)bs.nack, (unsigned long)bs.timeout,
+             (unsigned long)bs.other, (unsigned long)bs.recoveries, (unsigned long)bs.backoffs,
+             (unsigned long)bs.clk_hz, (unsigned long)bs.lat_avg_us, (unsigned long)bs.lat_max_us);
+}
+
+// Komendy panelu tylko przy zmianie stanu z pacera.
+static void apply_panel(panel_state_t from, panel_state_t to)
+{
+    if (from == to) return;
+    if (from == PANEL_OFF) sh1106_set_power(true);
+    if (to == PANEL_OFF) {
+        sh1106_set_power(false);
+    } else {
+        sh1106_set_contrast(to == PANEL_DIM ? CONFIG_SH1106_DIM_CONTRAST
+                                            : contrast_levels[snap.contrast % sizeof(contrast_levels)]);
+    }
+    TRACE("panel %d -> %d", from, to);
+}
+
+// --- Zadanie wyświetlacza ---
+// Przypięte do rdzenia czujnika; stąd też instalujemy ISR GPIO i magistralę,
+// bo przerwania trafiają na rdzeń, który je zakłada.
+static void display_task(void *arg)
 {
-    // Inicjalizacja
     init_gpio();
-    i2c_master_init();   // z biblioteki SH1106
+#if CONFIG_TOPO_JITTER_BENCH
+    jitter_bench_start(MAG_SENSOR_PIN);
+#endif
+    sh1106_bus_init();   // I2C albo SPI, wg menuconfig
     sh1106_init();
+    sh1106_fb_clear(&fb);   // pierwszy flush nadpisze całą pamięć sterownika
+    sh1106_set_contrast(contrast_levels[snap.contrast % sizeof(contrast_levels)]);
+    ride_screen_init(&screen, &fb, &hist, esp_timer_get_time);
+    ui_task = xTaskGetCurrentTaskHandle();
+#if CONFIG_POWER_MGMT
+    // po init_gpio: piny mają już przerwania zboczowe
+    static const gpio_num_t wake_pins[] = { MAG_SENSOR_PIN, ENCODER_A_PIN, ENCODER_BTN_PIN };
+    power_init(wake_pins, sizeof(wake_pins) / sizeof(wake_pins[0]));
+#endif
+
+    bool first_frame = true;
+    bool moving = false;
+    int64_t last_save = esp_timer_get_time();
+    int64_t last_hist = last_save;
+    int64_t last_stats = last_save;
+    unsigned zoom = 1;
+    wheel_trip_t trip;
 
-    char line1[20];
-    char line2[20];
+    wheel_trip_init(&trip, 0, last_save);
+    pacer_init(&pacer, &pacer_cfg, last_save);
+
+    speed_hist_reset(&hist);
 
     while (1)
     {
-        int magnet = gpio_get_level(MAG_SENSOR_PIN);
-        int btn = gpio_get_level(ENCODER_BTN_PIN);
-        char* dir = (encoder_dir == 1) ? "P" : (encoder_dir == -1) ? "L" : "-";
+        int64_t now = esp_timer_get_time();
+        uint32_t revs;
+        int64_t last_pulse;
+        float kmh = current_speed(now, &revs, &last_pulse);
+        PERF_STAGE(PERF_STAGE_SPEED);
+
+        wheel_trip_update(&trip, &snap, revs, kmh, now);
+
+        // puls serca może być rzadszy niż próbkowanie historii
+        while (now - last_hist >= HIST_PERIOD_US) {
+            speed_hist_push(&hist, (uint16_t)(kmh * 100.0f));
+            last_hist += HIST_PERIOD_US;
+        }
+
+        int steps, presses;
+        take_encoder(&steps, &presses);
+
+        // poprzednia klatka mogła jeszcze iść przez DMA – ramkę ruszamy dopiero po niej
+        int64_t t_bus = esp_timer_get_time();
+        sh1106_flush_wait();
+        pacer.st.bus_us += (uint32_t)(esp_timer_get_time() - t_bus);
+
+        if (menu.open) {
+            if (!ui_menu_input(&menu, steps, presses > 0)) {
+                // powrót do ekranu jazdy: całość od nowa
+                sh1106_fb_clear(&fb);
+                ui_invalidate(&screen);
+            }
+        } else if (presses > 0) {
+            ui_menu_open(&menu, &root_page, on_setting_changed);
+            sh1106_fb_clear(&fb);
+        } else if (steps != 0) {
+            // na ekranie jazdy enkoder zmienia zakres wykresu
+            zoom = (zoom + RIDE_ZOOM_COUNT + steps % RIDE_ZOOM_COUNT) % RIDE_ZOOM_COUNT;
+        }
 
-        snprintf(line1, sizeof(line1), "MAG: %d  BTN: %d", magnet, btn);
-        snprintf(line2, sizeof(line2), "ENC: %s", dir);
+        if (menu.open) {
+            ui_menu_render(&menu, &fb);
+        } else {
+            // widgety rysują się same, gdy zmieni się powiązana wartość
+            ride_view_t v = { kmh, revs, snap.odometer_m, snap.units, (uint8_t)zoom };
+            ride_screen_set(&v);
+#if CONFIG_TOPO_JITTER_BENCH
+            ui_invalidate(&screen);     // każda klatka w całości – maksymalny ruch na magistrali
+#endif
+            ui_render(&screen);
+        }
 
-        sh1106_clear_screen();
-        sh1106_display_text(line1, 0);
-        sh1106_display_text(line2, 1);
-        vTaskDelay(pdMS_TO_TICKS(200));
+        // ramka na magistralę tylko ze zmianą i nie częściej niż maks. FPS
+        bool active = kmh > 0.0f || steps != 0 || presses > 0 || menu.open;
+        panel_state_t panel = pacer.panel;
+        apply_panel(panel, pacer_activity(&pacer, active, now));
+        if (pacer_frame_due(&pacer, fb.dirty, now)) {
+            t_bus = esp_timer_get_time();
+            sh1106_flush_start(&fb);
+            // I2C kończy tu transfer; po SPI zostaje ~2 ms DMA
+            pacer.st.bus_us += (uint32_t)(esp_timer_get_time() - t_bus);
+            PERF_STAGE(PERF_STAGE_DISPLAY);
+        }
 
-        encoder_dir = 0; // reset kierunku
+        if (now - last_stats >= UI_STATS_US) {
+            log_ui_stats();
+#if CONFIG_TOPO_JITTER_BENCH
+            jitter_bench_report();
+#endif
+#if CONFIG_POWER_MGMT
+            power_report();
+#endif
+            heap_guard_report();
+#if CONFIG_PERF_PROBES
+            // konsola odpada: ENCODER_A siedzi na U0RXD
+            perf_report();
+#endif
+            last_stats = now;
+        }
+
+        if (first_frame) {
+            sh1106_flush_wait();
+            // esp_timer liczy od startu aplikacji; bootloader ROM/2. stopnia nie wlicza się
+            ESP_LOGI(TAG, "first frame at %lld ms since boot",
+                     (long long)(esp_timer_get_time() / 1000));
+            first_frame = false;
+            // start za nami: od teraz żadnej sterty (bufory stdio już założone)
+            heap_guard_seal();
+        }
+
+        // zapis przy zatrzymaniu i co minutę w trakcie jazdy
+        bool stopped = moving && kmh == 0.0f;
+        moving = kmh > 0.0f;
+#if CONFIG_POWER_MGMT
+        // w jeździe bez light sleep: okres impulsu bez opóźnienia przebudzenia;
+        // także po pierwszym impulsie po postoju, który prędkości jeszcze nie daje
+        power_hold(moving || (revs && now - last_pulse <= WHEEL_STOP_US));
+        portENTER_CRITICAL(&wheel_mux);
+        int64_t wake_pulse = wake_pulse_us <= now ? wake_pulse_us : 0;
+        if (wake_pulse) wake_pulse_us = 0;
+        portEXIT_CRITICAL(&wheel_mux);
+        if (wake_pulse) power_wake_sample(wake_pulse, now);
+#endif
+        // ustawienia leniwie: po wyjściu z menu albo po kilku sekundach bez zmian
+        bool settle = settings_dirty &&
+                      (!menu.open || now - settings_changed_us > SETTINGS_SAVE_US);
+        if (stopped || settle || (moving && now - last_save > SNAP_PERIOD_US)) {
+            save_state();
+            last_save = now;
+            settings_dirty = false;
+        }
+
+        // impuls koła i enkoder przerywają czekanie; zero na ekranie zaraz po
+        // uznaniu postoju
+        int64_t sleep_us = pacer_sleep_us(&pacer, fb.dirty, now);
+        if (moving && last_pulse + WHEEL_STOP_US + 1 - now < sleep_us)
+            sleep_us = last_pulse + WHEEL_STOP_US + 1 - now;
+        TickType_t ticks = pdMS_TO_TICKS((sleep_us + 999) / 1000);
+        ulTaskNotifyTake(pdTRUE, ticks ? ticks : 1);
     }
 }
+
+void app_main(void)
+{
+    // Stan przed wyświetlaczem – pierwsza klatka od razu z poprawnymi liczbami
+    restore_state();
+    trace_init();
+
+    // impulsy obsługuje ISR (najwyższy poziom), pętla ekranu nisko na tym samym rdzeniu;
+    // rdzeń 0 zostaje dla esp_timer i radia
+    static StackType_t  display_stack[4096];
+    static StaticTask_t display_tcb;
+    xTaskCreateStaticPinnedToCore(display_task, "display", sizeof(display_stack), NULL,
+                                  TOPO_PRIO_UI, display_stack, &display_tcb, TOPO_CORE_UI);
+}
@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+"""Dekoder kopii ekranu (components/ui/fb_mirror.h) na hoście.
+
+Czyta pakiety fb_mirror jako hex, jeden pakiet (notyfikacja BLE) na wiersz;
+ostatnie słowo wiersza to pakiet, wcześniejsze pierwsze słowo może być
+czasem w µs (tak pisze host/replay -m). Składa ramki tak jak odbiorca:
+XOR z poprzednim obrazem, po luce w numeracji czeka na ramkę kluczową.
+Zapisuje ostatnią pełną ramkę albo wszystkie (PBM lub PNG wg rozszerzenia).
+
+Użycie:  python3 tools/fb_mirror_decode.py mirror.txt -o screen.png
+         python3 tools/fb_mirror_decode.py mirror.txt -a 'out/%05d.pbm'
+         python3 tools/fb_mirror_decode.py mirror.txt --check frames.txt
+--check porównuje sumy FNV-1a ramek z wierszami F z host/replay -o.
+"""
+import argparse
+import struct
+import sys
+import zlib
+
+WIDTH = 132                 # kolumny RAM SH1106
+PAGES = 8
+VISIBLE = (2, 130)          # widoczne 128 kolumn panelu
+
+KEY = 0x80
+END = 0x40
+IDX_MASK = 0x3F
+
+
+class Receiver:
+    def __init__(self):
+        self.img = bytearray(WIDTH * PAGES)
+        self.synced = False
+        self.seq = None
+        self.idx = 0
+        self.pages = []
+        self.pos = 0
+        self.frames = self.lost = 0
+
+    def _desync(self):
+        if self.synced:
+            self.lost += 1
+        self.synced = False
+
+    def feed(self, pkt):
+        """Zwraca True, gdy pakiet zakończył poprawną ramkę."""
+        if len(pkt) < 2:
+            return False
+        seq, flags = pkt[0], pkt[1]
+        idx = flags & IDX_MASK
+        body = pkt[2:]
+
+        if idx == 0:
+            if flags & KEY:
+                self.img[:] = bytes(len(self.img))
+                self.synced = True
+            elif self.synced and self.seq is not None and seq != (self.seq + 1) & 0xFF:
+                self._desync()          # zgubiona cała ramka
+            if not body:
+                self._desync()
+                return False
+            mask, body = body[0], body[1:]
+            self.pages = [p for p in range(PAGES) if mask & 1 << p]
+            self.seq, self.idx, self.pos = seq, 0, 0
+        elif seq != self.seq or idx != (self.idx + 1) & IDX_MASK:
+            self._desync()
+            return False
+        else:
+            self.idx = idx
+        if not self.synced:
+            return False
+
+        if not self._apply(body):
+            self._desync()
+            return False
+        if flags & END:
+            self.frames += 1
+            return True
+        return False
+
+    def _apply(self, body):
+        end = len(self.pages) * WIDTH
+        i = 0
+        while i < len(body):
+            c = body[i]
+            i += 1
+            n = (c & 0x7F) + 1
+            if self.pos + n > end:
+                return False
+            if c & 0x80:
+                self.pos += n
+                continue
+            if i + n > len(body):
+                return False
+            for k in range(n):
+                p = self.pages[(self.pos + k) // WIDTH]
+                self.img[p * WIDTH + (self.pos + k) % WIDTH] ^= body[i + k]
+            i += n
+            self.pos += n
+        return True
+
+
+def pixels(img, raw=False):
+    """Wiersze pikseli (1 = świeci), bit 0 bajtu = górny piksel strony."""
+    x0, x1 = (0, WIDTH) if raw else VISIBLE
+    return [[img[(y >> 3) * WIDTH + x] >> (y & 7) & 1 for x in range(x0, x1)]
+            for y in range(PAGES * 8)]
+
+
+def fnv1a(data):
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def scaled(rows, scale):
+    out = []
+    for r in rows:
+        line = [v for v in r for _ in range(scale)]
+        out.extend([line] * scale)
+    return out
+
+
+def write_pbm(path, rows):
+    w, h = len(rows[0]), len(rows)
+    with open(path, "wb") as f:
+        f.write(b"P4\n%d %d\n" % (w, h))
+        for r in rows:
+            line = bytearray((w + 7) // 8)
+            for x, v in enumerate(r):
+                if v:
+                    line[x >> 3] |= 0x80 >> (x & 7)
+            f.write(line)
+
+
+def write_png(path, rows):
+    """Szary 8-bit: świecący piksel biały, jak na panelu."""
+    w, h = len(rows[0]), len(rows)
+    raw = b"".join(b"\0" + bytes(255 if v else 0 for v in r) for r in rows)
+
+    def chunk(tag, data):
+        c = struct.pack(">I", len(data)) + tag + data
+        return c + struct.pack(">I", zlib.crc32(tag + data) & 0xFFFFFFFF)
+
+    with open(path, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", w, h, 8, 0, 0, 0, 0)))
+        f.write(chunk(b"IDAT", zlib.compress(raw, 9)))
+        f.write(chunk(b"IEND", b""))
+
+
+def write_image(path, rows, scale):
+    rows = scaled(rows, scale) if scale > 1 else rows
+    (write_png if path.lower().endswith(".png") else write_pbm)(path, rows)
+
+
+def read_packets(f):
+    for line in f:
+        words = line.split()
+        if not words or words[0].startswith("#"):
+            continue
+        t = int(words[0]) if len(words) > 1 else None
+        yield t, bytes.fromhex(words[-1])
+
+
+def load_replay_hashes(path):
+    hashes = {}
+    for line in open(path):
+        w = line.split()
+        if len(w) == 4 and w[0] == "F":
+            hashes[int(w[1])] = int(w[3], 16)
+    return hashes
+
+
+def main():
+    ap = argparse.ArgumentParser(description="fb_mirror packets -> images")
+    ap.add_argument("input", help="hex packets, one per line ('-' = stdin)")
+    ap.add_argument("-o", "--out", help="last complete frame (.png or .pbm)")
+    ap.add_argument("-a", "--all", help="every frame, printf pattern, e.g. out/%%05d.png")
+    ap.add_argument("-s", "--scale", type=int, default=1, help="pixel scale")
+    ap.add_argument("--raw", action="store_true", help="all 132 RAM columns")
+    ap.add_argument("--check", help="replay -o output to compare frame hashes with")
+    args = ap.parse_args()
+
+    f = sys.stdin if args.input == "-" else open(args.input)
+    hashes = load_replay_hashes(args.check) if args.check else None
+    rx = Receiver()
+    pkts = nbytes = checked = bad = 0
+    last = None
+
+    for t, pkt in read_packets(f):
+        pkts += 1
+        nbytes += len(pkt)
+        if not rx.feed(pkt):
+            continue
+        last = bytes(rx.img)
+        if args.all:
+            write_image(args.all % rx.frames, pixels(last, args.raw), args.scale)
+        if hashes is not None and t in hashes:
+            checked += 1
+            if fnv1a(rx.img) != hashes[t]:
+                bad += 1
+                print("frame at %d us differs" % t, file=sys.stderr)
+
+    print("%d packets, %d B, %d frames, %d lost syncs" % (pkts, nbytes, rx.frames, rx.lost))
+    if hashes is not None:
+        print("checked %d frames against replay, %d differ" % (checked, bad))
+    if args.out:
+        if last is None:
+            sys.exit("no complete frame")
+        write_image(args.out, pixels(last, args.raw), args.scale)
+    return 1 if bad else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
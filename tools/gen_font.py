@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+"""Generator atlasu czcionki proporcjonalnej dla components/ui.
+
+Bierze font8x8_basic z komponentu sh1106, przycina puste kolumny
+(szerokość proporcjonalna + 1 kolumna odstępu) i dokłada polskie litery
+z Latin Extended-A, składając je z litery bazowej i znaku diakrytycznego.
+Każdy glif jest zapisany kolumnami (bit 0 = górny piksel, jak w RAM SH1106)
+i kodowany RLE serii jednakowych kolumn (pogrubiony font8x8 ma ich dużo);
+gdy RLE nie daje zysku, glif idzie bez kompresji.
+
+Użycie:  python3 tools/gen_font.py [--check]
+"""
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SRC = os.path.join(ROOT, "components", "sh1106", "main", "font8x8_basic.h")
+OUT = os.path.join(ROOT, "components", "ui", "font_atlas.c")
+
+MAX_W = 8
+SPACE_W = 3
+
+# litera -> (baza, znak)
+POLISH = {
+    0x0104: ("A", "ogonek"), 0x0105: ("a", "ogonek"),
+    0x0106: ("C", "acute"),  0x0107: ("c", "acute"),
+    0x0118: ("E", "ogonek"), 0x0119: ("e", "ogonek"),
+    0x0141: ("L", "stroke"), 0x0142: ("l", "stroke"),
+    0x0143: ("N", "acute"),  0x0144: ("n", "acute"),
+    0x00D3: ("O", "acute"),  0x00F3: ("o", "acute"),
+    0x015A: ("S", "acute"),  0x015B: ("s", "acute"),
+    0x0179: ("Z", "acute"),  0x017A: ("z", "acute"),
+    0x017B: ("Z", "dot"),    0x017C: ("z", "dot"),
+}
+
+
+def load_font8x8():
+    text = open(SRC, encoding="utf-8").read()
+    rows = re.findall(r"\{\s*((?:0x[0-9A-Fa-f]{2},?\s*){8})\}", text)
+    return [[int(b, 16) for b in re.findall(r"0x[0-9A-Fa-f]{2}", r)] for r in rows]
+
+
+def span(cols):
+    used = [i for i, c in enumerate(cols) if c]
+    return (used[0], used[-1]) if used else (0, -1)
+
+
+def compose(base_cols, base_ch, mark):
+    cols = list(base_cols)
+    lo, hi = span(cols)
+    mid = (lo + hi) // 2
+    upper = base_ch.isupper()
+
+    if mark in ("acute", "dot") and upper:
+        # wielka litera zajmuje wiersze 0..6 – przesuwamy o wiersz w dół
+        cols = [(c << 1) & 0xFF for c in cols]
+    if mark == "acute":
+        if upper:
+            cols[mid + 1] |= 0x01
+            cols[mid + 2] |= 0x01
+        else:
+            cols[mid + 1] |= 0x02
+            cols[mid + 2] |= 0x01
+    elif mark == "dot":
+        cols[mid] |= 0x01
+        cols[mid + 1] |= 0x01
+    elif mark == "ogonek":
+        cols[hi - 1] |= 0x80
+        cols[hi] |= 0x80
+    elif mark == "stroke":
+        # ukośna kreska przez trzon: piksel z lewej niżej, z prawej wyżej
+        stem = next(i for i in range(lo, hi + 1) if cols[i] & 0x3C == 0x3C)
+        cols[stem - 1] |= 0x10
+        cols[stem + 2] |= 0x08
+    return cols
+
+
+def proportional(cols):
+    lo, hi = span(cols)
+    if hi < lo:
+        return [0] * SPACE_W
+    out = cols[lo:hi + 1] + [0]         # kolumna odstępu
+    return out[:MAX_W]
+
+
+def rle(cols):
+    """Serie jednakowych kolumn: bajt maski (bit i = kolumna i jak i-1),
+    dalej tylko kolumny rozpoczynające serię."""
+    mask, out = 0, []
+    for i, c in enumerate(cols):
+        if i and c == cols[i - 1]:
+            mask |= 1 << i
+        else:
+            out.append(c)
+    return bytes([mask] + out)
+
+
+def unrle(data, width):
+    cols, k = [], 1
+    for i in range(width):
+        if data[0] >> i & 1:
+            cols.append(cols[-1])
+        else:
+            cols.append(data[k])
+            k += 1
+    return cols
+
+
+def build():
+    font = load_font8x8()
+    glyphs = {cp: proportional(font[cp]) for cp in range(0x20, 0x7F)}
+    for cp, (base, mark) in POLISH.items():
+        glyphs[cp] = proportional(compose(font[ord(base)], base, mark))
+
+    table, data = [], bytearray()
+    raw_size = 0
+    for cp in sorted(glyphs):
+        cols = glyphs[cp]
+        packed = rle(cols)
+        use_rle = len(packed) < len(cols)
+        blob = packed if use_rle else bytes(cols)
+        if use_rle:
+            assert unrle(packed, len(cols)) == cols, hex(cp)
+        table.append((cp, len(cols), int(use_rle), len(data)))
+        data += blob
+        raw_size += len(cols)
+    return glyphs, table, data, raw_size
+
+
+def c_array(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def emit(table, data, raw_size):
+    desc = "\n".join("    { 0x%04X, %d, %d, %4d },   /* %s */" % (cp, w, f, off, chr(cp) if cp != 0x5C else "backslash")
+                     for cp, w, f, off in table)
+    return f"""/* Wygenerowane przez tools/gen_font.py – nie edytować ręcznie. */
+#include "font.h"
+
+/* {len(table)} glifów, dane {len(data)} B (bez kompresji {raw_size} B), tablica {len(table) * 6} B */
+
+static const uint8_t atlas_data[{len(data)}] = {{
+{c_array(data)}
+}};
+
+static const font_glyph_desc_t atlas_glyphs[{len(table)}] = {{
+{desc}
+}};
+
+const font_atlas_t font_atlas = {{
+    .glyphs = atlas_glyphs,
+    .count  = {len(table)},
+    .data   = atlas_data,
+    .data_len = {len(data)},
+}};
+"""
+
+
+def main():
+    glyphs, table, data, raw_size = build()
+    text = emit(table, data, raw_size).replace("\n", "\r\n")
+    if "--check" in sys.argv:
+        for cp in sorted(POLISH):
+            print("U+%04X %s" % (cp, chr(cp)))
+            for b in range(8):
+                print("  " + "".join("#" if c >> b & 1 else "." for c in glyphs[cp]))
+        return
+    with open(OUT, "w", encoding="utf-8", newline="") as f:
+        f.write(text)
+    print("%d glyphs, %d B data (raw %d B), %d B table"
+          % (len(table), len(data), raw_size, len(table) * 6))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""Dekoder śladu binarnego (components/trace) na hoście.
+
+Czyta log z portu szeregowego zbudowany z CONFIG_TRACE_DRAIN_BINARY
+(linie "TRC ...") i ELF aplikacji, z którego bierze napisy formatów
+spod zapisanych adresów. Wpisy niosą młodsze 32 bity czasu esp_timer [µs],
+starsze bierze ze znaczników synchronizacji (fmt == 0); wpisy z obu rdzeni
+scala po czasie.
+
+Użycie:  python3 tools/trace_decode.py build/app.elf log.txt
+         idf.py monitor | python3 tools/trace_decode.py build/app.elf -
+"""
+import re
+import struct
+import sys
+
+FMT_RE = re.compile(r"%([-+ #0]*)(\d+)?(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcsp%])")
+
+
+class Elf:
+    """Mapa adres -> bajty dla sekcji ładowanych (tylko ELF32 LE, jak ESP32)."""
+
+    def __init__(self, path):
+        data = open(path, "rb").read()
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            sys.exit("%s: not a 32-bit little-endian ELF" % path)
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            _, typ, flags, addr, off, size = struct.unpack_from(
+                "<IIIIII", data, shoff + i * shentsize)
+            if typ == 1 and flags & 2 and addr:     # PROGBITS + ALLOC
+                self.sections.append((addr, data[off:off + size]))
+
+    def cstr(self, addr):
+        for base, blob in self.sections:
+            if base <= addr < base + len(blob):
+                end = blob.find(b"\0", addr - base)
+                return blob[addr - base:end].decode("utf-8", "replace")
+        return None
+
+
+def c_format(elf, fmt, args):
+    out, pos, ai = [], 0, 0
+    for m in FMT_RE.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, prec, _, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        v = args[ai] if ai < len(args) else 0
+        ai += 1
+        spec = "%" + flags + (width or "") + ("." + prec if prec else "")
+        if conv in "di":
+            out.append((spec + "d") % (v - (1 << 32) if v & 0x80000000 else v))
+        elif conv == "p":
+            out.append("0x%08x" % v)
+        elif conv == "s":
+            s = elf.cstr(v)
+            out.append((spec + "s") % (s if s is not None else "<0x%08x>" % v))
+        elif conv == "c":
+            out.append((spec + "c") % chr(v & 0xFF))
+        else:
+            out.append((spec + ("d" if conv == "u" else conv)) % v)
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    elf = Elf(sys.argv[1])
+    src = sys.stdin if sys.argv[2] == "-" else open(sys.argv[2], errors="replace")
+
+    sync = {}       # rdzeń -> (młodsze 32 bity, pełny czas) [µs]
+    pending = {}    # rdzeń -> wpisy sprzed pierwszego znacznika
+    events = []     # (µs, rdzeń, tekst)
+    lost = 0
+
+    for line in src:
+        m = re.search(r"TRC-LOST (\d+)", line)
+        if m:
+            lost += int(m.group(1))
+            continue
+        m = re.search(r"TRC (\d) ((?:[0-9a-f]{8} ?){6})", line)
+        if not m:
+            continue
+        core = int(m.group(1))
+        us, fmt, *args = (int(x, 16) for x in m.group(2).split())
+        if fmt == 0:
+            sync[core] = (us, args[0] | args[1] << 32)
+            for u, f, a in pending.pop(core, []):
+                events.append((at(sync[core], u), core, f, a))
+            continue
+        if core not in sync:
+            pending.setdefault(core, []).append((us, fmt, args))
+        else:
+            events.append((at(sync[core], us), core, fmt, args))
+
+    events.sort(key=lambda e: e[0])
+    for us, core, fmt, args in events:
+        text = elf.cstr(fmt)
+        if text is None:
+            text = "<fmt 0x%08x> %08x %08x %08x %08x" % ((fmt,) + tuple(args))
+        else:
+            text = c_format(elf, text, args)
+        print("T%d %10.3f ms  %s" % (core, us / 1000.0, text))
+    if lost:
+        print("(%d records overwritten on target)" % lost)
+
+
+def at(sync, us):
+    """Pełny czas wpisu wg znacznika; różnica ze znakiem (wpis sprzed znacznika)."""
+    d = (us - sync[0]) & 0xFFFFFFFF
+    if d & 0x80000000:
+        d -= 1 << 32
+    return sync[1] + d
+
+
+if __name__ == "__main__":
+    main()